@@ -24,7 +24,7 @@ class ScheduleDAGOptSched;
 
 class OptSchedTarget {
 public:
-  MachineModel *MM;
+  const MachineModel *MM;
 
   virtual ~OptSchedTarget() = default;
 
@@ -33,10 +33,11 @@ public:
 
   virtual std::unique_ptr<OptSchedDDGWrapperBase>
   createDDGWrapper(MachineSchedContext *Context, ScheduleDAGOptSched *DAG,
-                   OptSchedMachineModel *MM, LATENCY_PRECISION LatencyPrecision,
+                   const OptSchedMachineModel *MM,
+                   LATENCY_PRECISION LatencyPrecision,
                    const std::string &RegionID) = 0;
 
-  virtual void initRegion(ScheduleDAGInstrs *DAG, MachineModel *MM) = 0;
+  virtual void initRegion(ScheduleDAGInstrs *DAG, const MachineModel *MM) = 0;
   virtual void finalizeRegion(const InstSchedule *Schedule) = 0;
   // FIXME: This is a shortcut to doing the proper thing and creating a RP class
   // that targets can override. It's hard to justify spending the extra time
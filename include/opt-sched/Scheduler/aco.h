@@ -37,7 +37,7 @@ struct Choice {
 
 class ACOScheduler : public ConstrainedScheduler {
 public:
-  ACOScheduler(DataDepGraph *dataDepGraph, MachineModel *machineModel,
+  ACOScheduler(DataDepGraph *dataDepGraph, const MachineModel *machineModel,
                InstCount upperBound, SchedPriorities priorities, bool vrfySched,
                bool IsPostBB);
   virtual ~ACOScheduler();
@@ -64,6 +64,38 @@ private:
   // calculated.
   InstCount dynamicSlilLowerBound_ = 0;
 
+  // Per-instruction data used to update the dynamic SLIL lower bound in time
+  // proportional to the instruction's defs and uses. Indexed by inst number.
+  // The number of registers whose static live interval includes the inst.
+  std::vector<int> slilIntrvlRegCnts_;
+  // The registers whose possible live interval, but not whose static live
+  // interval, includes the inst.
+  std::vector<SmallVector<const Register *, 2>> slilPsblIntrvlRegs_;
+  // The change in the dynamic SLIL lower bound at each step, so that it can be
+  // undone when the instruction is unscheduled.
+  std::vector<InstCount> slilLwrBoundDeltas_;
+
+  // A use in the register pressure delta table.
+  struct RPDeltaUse {
+    const Register *reg;
+    int16_t type;
+    int wght;
+  };
+  // Per-instruction register pressure delta table, used to evaluate the
+  // effect of scheduling an instruction without updating the live registers.
+  // The weight added by the instruction's defs for each register type,
+  // indexed by [inst number * regTypeCnt_ + type].
+  std::vector<int> rpDeltaDefWghts_;
+  // The instruction's uses, which remove their weight when they are the last
+  // use of the register. The uses of inst i are at [rpDeltaUseBgns_[i],
+  // rpDeltaUseBgns_[i + 1]).
+  std::vector<RPDeltaUse> rpDeltaUses_;
+  std::vector<int> rpDeltaUseBgns_;
+  // Scratch space for the register pressure that would result from
+  // scheduling an instruction.
+  SmallVector<unsigned, 8> prbRegPressures_;
+  SmallVector<InstCount, 8> prbPeakRegPressures_;
+
   int entryInstCnt_;
   int exitInstCnt_;
   int schduldEntryInstCnt_;
@@ -97,18 +129,49 @@ private:
   void FinishOptml_();
   void CmputAbslutUprBound_();
   ConstrainedScheduler *AllocHeuristicScheduler_();
+  SchedRegion *AllocPartRgn_(DataDepGraph *partGraph);
   bool EnableEnum_();
 
   void InitForCostCmputtn_();
   InstCount CmputDynmcCost_();
 
+  // Policies for the register pressure updates below. A fixed policy makes
+  // the spill cost function and whether SLIL is tracked compile-time
+  // constants, so the per-step updates carry no checks for the other cost
+  // functions and no virtual needsSLIL() calls. The dynamic policy reads both
+  // from the region and covers the remaining configurations.
+  template <SPILL_COST_FUNCTION SCF, bool TRACK_SLIL>
+  struct FixedSpillCostPolicy;
+  struct DynmcSpillCostPolicy;
+
+  template <typename Policy>
   void UpdateSpillInfoForSchdul_(SchedInstruction *inst, bool trackCnflcts);
+  template <typename Policy>
   void UpdateSpillInfoForUnSchdul_(SchedInstruction *inst);
+  // The instantiations of the above used by SchdulInst() and UnschdulInst().
+  void (BBWithSpill::*updtSpillInfoForSchdul_)(SchedInstruction *, bool);
+  void (BBWithSpill::*updtSpillInfoForUnSchdul_)(SchedInstruction *);
+  template <typename Policy> void UseSpillCostPolicy_();
+  // Picks the update instantiations for the current cost function settings.
+  void SelectSpillCostPolicy_();
+  // Precompute the per-instruction SLIL interval data from the live intervals
+  // set up by the static SLIL lower bound.
+  void CmputSLILIntrvlInfo_();
+  // Compute the change in the dynamic SLIL lower bound caused by scheduling
+  // an instruction after the live registers have been updated.
+  InstCount CmputSLILLwrBoundDelta_(const SchedInstruction *inst) const;
   void SetupPhysRegs_();
+  void SetupRPDeltaTable_();
   // can only compute SLIL if SLIL was the spillCostFunc
   // This function must only be called after the regPressures_ is computed
   InstCount CmputCostForFunction(SPILL_COST_FUNCTION SpillCF);
+  InstCount CmputCostForFunction(SPILL_COST_FUNCTION SpillCF,
+                                 const SmallVectorImpl<unsigned> &RegPressures,
+                                 const InstCount *PeakRegPressures);
   void CmputCrntSpillCost_();
+  InstCount CmputCrntSpillCost_(SPILL_COST_FUNCTION SpillCF,
+                                InstCount peakSpillCost,
+                                InstCount totSpillCost) const;
   bool ChkSchedule_(InstSchedule *bestSched, InstSchedule *lstSched);
   void CmputCnflcts_(InstSchedule *sched);
 
@@ -145,6 +208,8 @@ public:
                             InstCount crntCost, InstCount TmpSpillCost);
   bool ChkCostFsbltyWghtd(InstCount trgtLngth, EnumTreeNode *treeNode,
                           InstCount crntCost, InstCount TmpSpillCost);
+  bool ChkCostFsbltyBeforeSchdul(InstCount trgtLngth, SchedInstruction *inst,
+                                 InstCount &RPCost);
 
   void SchdulInst(SchedInstruction *inst, InstCount cycleNum, InstCount slotNum,
                   bool trackCnflcts);
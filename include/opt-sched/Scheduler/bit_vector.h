@@ -10,24 +10,32 @@ Last Update:  Mar. 2011
 
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/mem_mngr.h"
+#include <cstdint>
 #include <cstring>
 #include <memory>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace llvm {
 namespace opt_sched {
 
 class BitVector {
 public:
   // The actual integral type that is used to store the bits.
-  typedef unsigned int Unit;
+  typedef uint64_t Unit;
 
   // Constructs a bit vector of a given length.
   BitVector(int length = 0);
+  // Constructs a deep copy of another bit vector.
+  BitVector(const BitVector &src);
   // Deallocates the vector.
   virtual ~BitVector();
 
   // Reconstructs the vector to hold a vector of the new length. All old data
-  // is discarded.
+  // is discarded. The buffer is only reallocated if the number of units
+  // changes.
   void Construct(int length);
 
   // Sets all bits to 0.
@@ -45,6 +53,36 @@ public:
   std::unique_ptr<BitVector> And(BitVector *otherBitVector) const;
   // Returns true if this BitVector's one bits are a subset of "otherBitVector".
   bool IsSubVector(BitVector *otherBitVector) const;
+  bool IsSubVector(const BitVector &other) const;
+
+  // In-place set operations. The other vector must be of the same size. None
+  // of these allocate memory.
+  // this = this & other
+  void AndWith(const BitVector &other);
+  // this = this | other
+  void OrWith(const BitVector &other);
+  // this = this & ~other
+  void AndNotWith(const BitVector &other);
+
+  // Into-destination set operations: overwrite this vector with the result of
+  // combining "a" and "b". All three vectors must be of the same size, and
+  // this vector may alias either operand.
+  void SetToAnd(const BitVector &a, const BitVector &b);
+  void SetToOr(const BitVector &a, const BitVector &b);
+  void SetToAndNot(const BitVector &a, const BitVector &b);
+
+  // Returns the number of bits set in both this vector and "other" without
+  // materializing the intersection.
+  int GetAndOneCnt(const BitVector &other) const;
+  // Returns true if this vector and "other" have at least one common one bit.
+  bool Intersects(const BitVector &other) const;
+
+  // Set-bit iteration. FindFrstOne() returns the index of the lowest one bit,
+  // and FindNxtOne() returns the index of the lowest one bit above "index".
+  // Both return -1 if there is no such bit. For example:
+  //   for (int i = bv.FindFrstOne(); i != -1; i = bv.FindNxtOne(i))
+  int FindFrstOne() const;
+  int FindNxtOne(int index) const;
 
   // Assigns the values from src to the vector. Both vectors must be of the
   // same size.
@@ -66,6 +104,20 @@ protected:
   static Unit GetMask_(int bitNum, bool val);
   // The number of bits per storage unit.
   static const int BITS_IN_UNIT = sizeof(Unit) * 8;
+  // log2(BITS_IN_UNIT), for turning bit indices into unit indices.
+  static const int UNIT_SHIFT = 6;
+
+  // Word-level kernels shared by the set operations above. The ones that
+  // write to "dst" return the number of one bits in the result. They use AVX2
+  // when the compiler targets it and fall back to plain 64-bit loops
+  // otherwise.
+  static int AndUnits_(Unit *dst, const Unit *a, const Unit *b, int cnt);
+  static int OrUnits_(Unit *dst, const Unit *a, const Unit *b, int cnt);
+  static int AndNotUnits_(Unit *dst, const Unit *a, const Unit *b, int cnt);
+  static int CntAndUnits_(const Unit *a, const Unit *b, int cnt);
+  static bool IsSubsetUnits_(const Unit *a, const Unit *b, int cnt);
+  static bool AreEqualUnits_(const Unit *a, const Unit *b, int cnt);
+  static int PopCnt_(Unit unit);
 };
 
 inline BitVector::BitVector(int length) {
@@ -76,22 +128,30 @@ inline BitVector::BitVector(int length) {
   Construct(length);
 }
 
+inline BitVector::BitVector(const BitVector &src) {
+  bitCnt_ = 0;
+  unitCnt_ = 0;
+  oneCnt_ = 0;
+  vctr_ = NULL;
+  Construct(src.bitCnt_);
+  *this = src;
+}
+
 inline void BitVector::Construct(int length) {
+  static_assert(BITS_IN_UNIT == 1 << UNIT_SHIFT, "Unit shift mismatch");
+  int unitCnt = (length + BITS_IN_UNIT - 1) / BITS_IN_UNIT;
   bitCnt_ = length;
-  unitCnt_ = (bitCnt_ + BITS_IN_UNIT - 1) / BITS_IN_UNIT;
-
-  if (unitCnt_ == 0)
-    return;
-
-  if (vctr_)
-    delete[] vctr_;
-  vctr_ = new Unit[unitCnt_];
+  oneCnt_ = 0;
 
-  for (int i = 0; i < unitCnt_; i++) {
-    vctr_[i] = 0;
+  if (unitCnt != unitCnt_) {
+    if (vctr_)
+      delete[] vctr_;
+    vctr_ = unitCnt == 0 ? NULL : new Unit[unitCnt];
+    unitCnt_ = unitCnt;
   }
 
-  oneCnt_ = 0;
+  if (unitCnt_ > 0)
+    memset(vctr_, 0, unitCnt_ * sizeof(Unit));
 }
 
 inline BitVector::~BitVector() {
@@ -103,48 +163,47 @@ inline void BitVector::Reset() {
   if (oneCnt_ == 0)
     return;
 
-  for (int i = 0; i < unitCnt_; i++) {
-    vctr_[i] = 0;
-  }
-
+  memset(vctr_, 0, unitCnt_ * sizeof(Unit));
   oneCnt_ = 0;
 }
 
 inline void BitVector::SetBit(int index, bool bitVal) {
-  assert(index < bitCnt_);
-  int unitNum = index / BITS_IN_UNIT;
-  int bitNum = index - unitNum * BITS_IN_UNIT;
-  Unit mask = GetMask_(bitNum, bitVal);
+  assert(index >= 0 && index < bitCnt_);
+  Unit &unit = vctr_[index >> UNIT_SHIFT];
+  Unit mask = GetMask_(index & (BITS_IN_UNIT - 1), true);
+  bool isSet = (unit & mask) != 0;
 
   if (bitVal) {
-    if (GetBit(index) == false)
+    if (!isSet) {
       oneCnt_++;
-    vctr_[unitNum] |= mask;
+      unit |= mask;
+    }
   } else {
-    if (GetBit(index) == true)
+    if (isSet) {
       oneCnt_--;
-    vctr_[unitNum] &= mask;
+      unit &= ~mask;
+    }
   }
 }
 
 inline bool BitVector::GetBit(int index) const {
-  assert(index < bitCnt_);
-  int unitNum = index / BITS_IN_UNIT;
-  int bitNum = index - unitNum * BITS_IN_UNIT;
-  return (vctr_[unitNum] & GetMask_(bitNum, true)) != 0;
+  assert(index >= 0 && index < bitCnt_);
+  return (vctr_[index >> UNIT_SHIFT] >> (index & (BITS_IN_UNIT - 1))) & 1;
 }
 
 inline bool BitVector::IsSubVector(BitVector *other) const {
   assert(other != NULL);
+  return IsSubVector(*other);
+}
+
+inline bool BitVector::IsSubVector(const BitVector &other) const {
   // The other vector must be at least as large as this vector.
-  if (unitCnt_ > other->unitCnt_)
+  if (unitCnt_ > other.unitCnt_)
+    return false;
+  if (oneCnt_ > other.oneCnt_)
     return false;
 
-  for (int i = 0; i < unitCnt_; i++) {
-    if ((vctr_[i] & other->vctr_[i]) != vctr_[i])
-      return false;
-  }
-  return true;
+  return IsSubsetUnits_(vctr_, other.vctr_, unitCnt_);
 }
 
 inline std::unique_ptr<BitVector>
@@ -154,18 +213,82 @@ BitVector::And(BitVector *otherBitVector) const {
   int bitCnt =
       bitCnt_ > otherBitVector->bitCnt_ ? bitCnt_ : otherBitVector->bitCnt_;
   std::unique_ptr<BitVector> andedVector(new BitVector(bitCnt));
+  // Bits beyond the end of the shorter vector are zero in the result.
+  int commonCnt = unitCnt_ < otherBitVector->unitCnt_
+                      ? unitCnt_
+                      : otherBitVector->unitCnt_;
+  andedVector->oneCnt_ =
+      AndUnits_(andedVector->vctr_, vctr_, otherBitVector->vctr_, commonCnt);
+  return andedVector;
+}
+
+inline void BitVector::AndWith(const BitVector &other) {
+  assert(bitCnt_ == other.bitCnt_);
+  oneCnt_ = AndUnits_(vctr_, vctr_, other.vctr_, unitCnt_);
+}
+
+inline void BitVector::OrWith(const BitVector &other) {
+  assert(bitCnt_ == other.bitCnt_);
+  oneCnt_ = OrUnits_(vctr_, vctr_, other.vctr_, unitCnt_);
+}
+
+inline void BitVector::AndNotWith(const BitVector &other) {
+  assert(bitCnt_ == other.bitCnt_);
+  oneCnt_ = AndNotUnits_(vctr_, vctr_, other.vctr_, unitCnt_);
+}
+
+inline void BitVector::SetToAnd(const BitVector &a, const BitVector &b) {
+  assert(bitCnt_ == a.bitCnt_ && bitCnt_ == b.bitCnt_);
+  oneCnt_ = AndUnits_(vctr_, a.vctr_, b.vctr_, unitCnt_);
+}
+
+inline void BitVector::SetToOr(const BitVector &a, const BitVector &b) {
+  assert(bitCnt_ == a.bitCnt_ && bitCnt_ == b.bitCnt_);
+  oneCnt_ = OrUnits_(vctr_, a.vctr_, b.vctr_, unitCnt_);
+}
+
+inline void BitVector::SetToAndNot(const BitVector &a, const BitVector &b) {
+  assert(bitCnt_ == a.bitCnt_ && bitCnt_ == b.bitCnt_);
+  oneCnt_ = AndNotUnits_(vctr_, a.vctr_, b.vctr_, unitCnt_);
+}
+
+inline int BitVector::GetAndOneCnt(const BitVector &other) const {
+  assert(bitCnt_ == other.bitCnt_);
+  if (oneCnt_ == 0 || other.oneCnt_ == 0)
+    return 0;
+  return CntAndUnits_(vctr_, other.vctr_, unitCnt_);
+}
+
+inline bool BitVector::Intersects(const BitVector &other) const {
+  assert(bitCnt_ == other.bitCnt_);
+  if (oneCnt_ == 0 || other.oneCnt_ == 0)
+    return false;
+
+  for (int i = 0; i < unitCnt_; i++) {
+    if ((vctr_[i] & other.vctr_[i]) != 0)
+      return true;
+  }
+  return false;
+}
+
+inline int BitVector::FindFrstOne() const { return FindNxtOne(-1); }
 
-  for (int i = 0; i < andedVector->unitCnt_; i++) {
-    andedVector->vctr_[i] = vctr_[i] & otherBitVector->vctr_[i];
+inline int BitVector::FindNxtOne(int index) const {
+  int bitNum = index + 1;
+  if (bitNum >= bitCnt_)
+    return -1;
 
-    // TODO(austin) This may not be portable enough.
-    // This is a built in gcc function for counting the number of 1 bits
-    // in a number. When using x86 it should be implemented as a single
-    // instruction ie "popcnt %rdi, %rax"
-    andedVector->oneCnt_ += __builtin_popcountll(andedVector->vctr_[i]);
+  int unitNum = bitNum >> UNIT_SHIFT;
+  Unit unit = vctr_[unitNum] & (~(Unit)0 << (bitNum & (BITS_IN_UNIT - 1)));
+
+  while (unit == 0) {
+    if (++unitNum == unitCnt_)
+      return -1;
+    unit = vctr_[unitNum];
   }
 
-  return andedVector;
+  // Bits past bitCnt_ are never set, so this is always in range.
+  return (unitNum << UNIT_SHIFT) + __builtin_ctzll(unit);
 }
 
 inline int BitVector::GetSize() const { return bitCnt_; }
@@ -184,8 +307,7 @@ inline bool BitVector::operator==(const BitVector &other) const {
   assert(bitCnt_ == other.bitCnt_);
   if (oneCnt_ != other.oneCnt_)
     return false;
-  int byteCnt = unitCnt_ * sizeof(Unit);
-  return (memcmp(vctr_, other.vctr_, byteCnt) == 0);
+  return AreEqualUnits_(vctr_, other.vctr_, unitCnt_);
 }
 
 inline BitVector::Unit BitVector::GetMask_(int bitNum, bool bitVal) {
@@ -202,6 +324,133 @@ inline BitVector::Unit BitVector::GetMask_(int bitNum, bool bitVal) {
   return mask;
 }
 
+inline int BitVector::PopCnt_(Unit unit) {
+  // This is a built in gcc function for counting the number of 1 bits in a
+  // number. On x86 with POPCNT it is a single instruction.
+  return __builtin_popcountll(unit);
+}
+
+#if defined(__AVX2__)
+// The AVX2 kernels process four units per iteration and finish the tail with
+// the scalar loop.
+static const int UNITS_PER_AVX2_VCTR = 4;
+
+inline __m256i LoadUnits_(const BitVector::Unit *units) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(units));
+}
+
+inline void StoreUnits_(BitVector::Unit *units, __m256i val) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(units), val);
+}
+
+inline int PopCntVctr_(__m256i val) {
+  return __builtin_popcountll(_mm256_extract_epi64(val, 0)) +
+         __builtin_popcountll(_mm256_extract_epi64(val, 1)) +
+         __builtin_popcountll(_mm256_extract_epi64(val, 2)) +
+         __builtin_popcountll(_mm256_extract_epi64(val, 3));
+}
+#endif
+
+inline int BitVector::AndUnits_(Unit *dst, const Unit *a, const Unit *b,
+                                int cnt) {
+  int oneCnt = 0;
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR) {
+    __m256i rslt = _mm256_and_si256(LoadUnits_(a + i), LoadUnits_(b + i));
+    StoreUnits_(dst + i, rslt);
+    oneCnt += PopCntVctr_(rslt);
+  }
+#endif
+  for (; i < cnt; i++) {
+    dst[i] = a[i] & b[i];
+    oneCnt += PopCnt_(dst[i]);
+  }
+  return oneCnt;
+}
+
+inline int BitVector::OrUnits_(Unit *dst, const Unit *a, const Unit *b,
+                               int cnt) {
+  int oneCnt = 0;
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR) {
+    __m256i rslt = _mm256_or_si256(LoadUnits_(a + i), LoadUnits_(b + i));
+    StoreUnits_(dst + i, rslt);
+    oneCnt += PopCntVctr_(rslt);
+  }
+#endif
+  for (; i < cnt; i++) {
+    dst[i] = a[i] | b[i];
+    oneCnt += PopCnt_(dst[i]);
+  }
+  return oneCnt;
+}
+
+inline int BitVector::AndNotUnits_(Unit *dst, const Unit *a, const Unit *b,
+                                   int cnt) {
+  int oneCnt = 0;
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR) {
+    // Note that andnot negates its first operand.
+    __m256i rslt = _mm256_andnot_si256(LoadUnits_(b + i), LoadUnits_(a + i));
+    StoreUnits_(dst + i, rslt);
+    oneCnt += PopCntVctr_(rslt);
+  }
+#endif
+  for (; i < cnt; i++) {
+    dst[i] = a[i] & ~b[i];
+    oneCnt += PopCnt_(dst[i]);
+  }
+  return oneCnt;
+}
+
+inline int BitVector::CntAndUnits_(const Unit *a, const Unit *b, int cnt) {
+  int oneCnt = 0;
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR)
+    oneCnt +=
+        PopCntVctr_(_mm256_and_si256(LoadUnits_(a + i), LoadUnits_(b + i)));
+#endif
+  for (; i < cnt; i++)
+    oneCnt += PopCnt_(a[i] & b[i]);
+  return oneCnt;
+}
+
+inline bool BitVector::IsSubsetUnits_(const Unit *a, const Unit *b, int cnt) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR) {
+    // testc(b, a) is set iff (~b & a) == 0.
+    if (!_mm256_testc_si256(LoadUnits_(b + i), LoadUnits_(a + i)))
+      return false;
+  }
+#endif
+  for (; i < cnt; i++) {
+    if ((a[i] & ~b[i]) != 0)
+      return false;
+  }
+  return true;
+}
+
+inline bool BitVector::AreEqualUnits_(const Unit *a, const Unit *b, int cnt) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + UNITS_PER_AVX2_VCTR <= cnt; i += UNITS_PER_AVX2_VCTR) {
+    __m256i diff = _mm256_xor_si256(LoadUnits_(a + i), LoadUnits_(b + i));
+    if (!_mm256_testz_si256(diff, diff))
+      return false;
+  }
+#endif
+  for (; i < cnt; i++) {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
 // Used to track weighted spill cost where a live register can have a weight
 // that increases the cost of the register being live proportional to its
 // weight.
@@ -225,23 +474,23 @@ inline WeightedBitVector::WeightedBitVector(int length) : BitVector(length) {
 inline WeightedBitVector::~WeightedBitVector() {}
 
 inline void WeightedBitVector::SetBit(int index, bool bitVal, int weight) {
-  assert(index < bitCnt_);
-  int unitNum = index / BITS_IN_UNIT;
-  int bitNum = index - unitNum * BITS_IN_UNIT;
-  Unit mask = GetMask_(bitNum, bitVal);
+  assert(index >= 0 && index < bitCnt_);
+  Unit &unit = vctr_[index >> UNIT_SHIFT];
+  Unit mask = GetMask_(index & (BITS_IN_UNIT - 1), true);
+  bool isSet = (unit & mask) != 0;
 
   if (bitVal) {
-    if (GetBit(index) == false) {
+    if (!isSet) {
       oneCnt_++;
       wghtedCnt_ += weight;
+      unit |= mask;
     }
-    vctr_[unitNum] |= mask;
   } else {
-    if (GetBit(index) == true) {
+    if (isSet) {
       oneCnt_--;
       wghtedCnt_ -= weight;
+      unit &= ~mask;
     }
-    vctr_[unitNum] &= mask;
   }
 }
 
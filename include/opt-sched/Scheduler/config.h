@@ -16,6 +16,7 @@ Last Update:  Mar. 2011
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace llvm {
@@ -47,12 +48,25 @@ protected:
   std::map<string, string> settings;
 };
 
+// Returns the configuration in the file, parsing it only the first time it is
+// asked for and again whenever its modification time or size changes. Safe
+// to call from several threads. The returned configuration is shared with
+// every other caller and is never modified.
+std::shared_ptr<const Config> loadCachedConfig(const string &filepath);
+
 class SchedulerOptions : public Config {
 public:
   // Since the scheduler flags should only be loaded once we are safe
   // implementing it as a singelton.
   static SchedulerOptions &getInstance();
 
+  // Loads the file through loadCachedConfig() unless the last call loaded the
+  // same version of it. Like Load(), this replaces the settings in place
+  // without synchronizing with the getters, so only one thread may schedule
+  // at a time. That is the case for the machine scheduler, which creates a
+  // scheduler per function on the thread running the pass.
+  void LoadIfChanged(const string &filepath);
+
   // Make sure there is no way for a second config object to be accidentally
   // created.
   SchedulerOptions(const SchedulerOptions &) = delete;
@@ -60,6 +74,9 @@ public:
 
 private:
   SchedulerOptions() {}
+
+  // The configuration the last LoadIfChanged() copied.
+  std::shared_ptr<const Config> LoadedConfig;
 };
 
 } // namespace opt_sched
@@ -15,6 +15,8 @@ Last Update:  Mar. 2011
 #include "opt-sched/Scheduler/sched_basic_data.h"
 #include "llvm/ADT/SmallVector.h"
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
@@ -108,7 +110,7 @@ class GraphTrans;
 class DataDepStruct {
 public:
   // TODO(max): Document.
-  DataDepStruct(MachineModel *machMdl);
+  DataDepStruct(const MachineModel *machMdl);
   // TODO(max): Document.
   virtual ~DataDepStruct();
 
@@ -137,7 +139,7 @@ public:
 
 protected:
   // A pointer to the machine which this graph uses.
-  MachineModel *machMdl_;
+  const MachineModel *machMdl_;
 
   DEP_GRAPH_TYPE type_;
 
@@ -173,7 +175,7 @@ class DataDepGraph : public llvm::opt_sched::OptSchedDDGWrapperBase,
                      public DirAcycGraph,
                      public DataDepStruct {
 public:
-  DataDepGraph(MachineModel *machMdl, LATENCY_PRECISION ltncyPcsn);
+  DataDepGraph(const MachineModel *machMdl, LATENCY_PRECISION ltncyPcsn);
   virtual ~DataDepGraph();
 
   // Reads the data dependence graph from a text file.
@@ -198,8 +200,32 @@ public:
   // Setup the Dep. Graph for scheduling by doing a topological sort
   // followed by critical path computation
   FUNC_RESULT SetupForSchdulng(bool cmputTrnstvClsr);
-  // Update the Dep after applying graph transformations
+  // Update the Dep after applying graph transformations. If the transitive
+  // closure was computed by the last setup, only the nodes that can reach
+  // (be reached from) an edge changed since then have their recursive
+  // neighbors recomputed.
   FUNC_RESULT UpdateSetupForSchdulng(bool cmputTrnstvClsr);
+  // Computes the transitive closure if the last setup did not, for a graph
+  // that was set up without it because it might not be needed.
+  FUNC_RESULT CmputTrnstvClsr();
+  // Records that the edge between the given nodes was added, removed or had
+  // its latency changed after the graph was set up for scheduling. Edges
+  // created through CreateEdge() and CreateEdge_() are recorded
+  // automatically; code that removes edges must call this itself.
+  void NoteEdgeChange(SchedInstruction *frmNode, SchedInstruction *toNode);
+
+  // The mutable search state of all instructions in the graph. Everything a
+  // scheduler changes in the instructions while building a schedule lives
+  // here, except for the tightened lower bounds kept by each SchedRange.
+  struct SchedState {
+    // Indexed by instruction number.
+    std::vector<InstSchedState> insts;
+    // The ready cycle contributed by each scheduled predecessor, and the
+    // instruction's previous minimum ready cycle, indexed by predecessor edge
+    // in the order of the graph's CSR predecessor arrays.
+    std::vector<InstCount> prdcsrRdyCycles;
+    std::vector<InstCount> prevMinRdyCycles;
+  };
 
   // Returns transformations that we will apply to the graph
   SmallVector<std::unique_ptr<GraphTrans>, 0> *GetGraphTrans() {
@@ -253,11 +279,55 @@ public:
   // Count dependencies and cross-dependencies
   void CountDeps(InstCount &totDepCnt, InstCount &crossDepCnt);
 
+  // Finds the groups of instructions that are connected by edges when the
+  // artificial root and leaf are left out. No edge leads from one group to
+  // another, so the groups can be scheduled independently. Sets cmpnnts[i]
+  // to the group of instruction i, or to INVALID_VALUE for the root and leaf,
+  // and returns the number of groups.
+  InstCount FindIndpndntCmpnnts(std::vector<InstCount> &cmpnnts);
+
+  // Finds the classes of interchangeable instructions: instructions of the
+  // same type that have the same predecessors and successors over the same
+  // edges, use the same registers and define registers of the same types,
+  // weights and users. Exchanging two of them in a schedule changes neither
+  // its length nor its cost. Links each instruction to the one before it in
+  // its class in instruction number order (see
+  // SchedInstruction::GetPrevEquvlnt()) and returns the number of linked
+  // instructions.
+  InstCount FindEquvlntClasses();
+
   int GetBscBlkCnt();
   bool IsInGraph(SchedInstruction *inst);
   InstCount GetInstIndx(SchedInstruction *inst);
+  // Returns the length of the longest path from ref to inst (dir ==
+  // DIR_FRWRD) or from inst to ref (dir == DIR_BKWRD), or INVALID_VALUE if
+  // there is no such path.
   InstCount GetRltvCrtclPath(SchedInstruction *ref, SchedInstruction *inst,
-                             DIRECTION dir);
+                             DIRECTION dir) {
+    return dir == DIR_FRWRD ? GetRltvCrtclPath(ref->GetNum(), inst->GetNum())
+                            : GetRltvCrtclPath(inst->GetNum(), ref->GetNum());
+  }
+  // Returns the length of the longest path from instruction frmNum to
+  // instruction toNum, 0 if they are the same, or INVALID_VALUE if there is
+  // no path. The matrix of these is built on the first call after the graph
+  // was set up or changed.
+  InstCount GetRltvCrtclPath(InstCount frmNum, InstCount toNum) {
+    if (!rltvCrtclPathsBuilt_)
+      BuildRltvCrtclPaths_();
+    size_t indx = (size_t)frmNum * instCnt_ + toNum;
+    InstCount path = rltvCrtclPaths16_.empty() ? rltvCrtclPaths32_[indx]
+                                               : rltvCrtclPaths16_[indx];
+    return path < 0 ? INVALID_VALUE : path;
+  }
+  // Returns the set of instructions that are superior to inst: those of the
+  // same issue type whose successors include all of inst's successors over
+  // edges at least as long (see GraphNode::IsScsrDmntd()). The matrix of
+  // these is built on the first call after the graph was set up or changed.
+  const BitVector &GetSprirInsts(SchedInstruction *inst) {
+    if (!sprirInstsBuilt_)
+      BuildSprirInsts_();
+    return sprirInsts_[inst->GetNum()];
+  }
   void SetCrntFrwrdLwrBound(SchedInstruction *inst);
   void SetSttcLwrBounds();
   void SetDynmcLwrBounds();
@@ -334,7 +404,7 @@ protected:
   // A list of DDG mutations
   SmallVector<std::unique_ptr<GraphTrans>, 0> graphTrans_;
 
-  MachineModel *machMdl_;
+  const MachineModel *machMdl_;
 
   bool backTrackEnbl_;
 
@@ -349,6 +419,10 @@ protected:
   bool isTraceFormat_;
 
   bool wasSetupForSchduling_;
+  // Whether the recursive neighbors were computed by the last setup.
+  bool wasTrnstvClsrCmputd_;
+  // The (from, to) nodes of the edges changed since the last setup.
+  std::vector<std::pair<SchedInstruction *, SchedInstruction *>> chngdEdges_;
 
   int32_t lastBlkNum_;
 
@@ -374,9 +448,29 @@ protected:
   // object holds all registers for a given register type.
   std::unique_ptr<RegisterFile[]> RegFiles;
 
+  // The storage behind each instruction's search state.
+  SchedState schedState_;
+
+  // The relative critical path matrix: the longest path from each
+  // instruction to each other one, row by source instruction, with a
+  // negative value where there is no path. 16-bit entries are used when the
+  // graph's critical path fits, otherwise the 32-bit ones.
+  std::vector<int16_t> rltvCrtclPaths16_;
+  std::vector<InstCount> rltvCrtclPaths32_;
+  // Whether the matrix matches the current edges.
+  bool rltvCrtclPathsBuilt_ = false;
+
+  // The superior instructions of each instruction, one row per instruction.
+  std::vector<BitVector> sprirInsts_;
+  // Whether the rows match the current edges.
+  bool sprirInstsBuilt_ = false;
+
   void AllocArrays_(InstCount instCnt);
-  FUNC_RESULT ParseF2Nodes_(SpecsBuffer *specsBuf, MachineModel *machMdl);
-  FUNC_RESULT ParseF2Edges_(SpecsBuffer *specsBuf, MachineModel *machMdl);
+  // Sizes the per-predecessor part of the search state to the current edges
+  // and points each instruction at its slice. Must follow BuildEdgeArrays().
+  void SetupPrdcsrRdyCycles_();
+  FUNC_RESULT ParseF2Nodes_(SpecsBuffer *specsBuf, const MachineModel *machMdl);
+  FUNC_RESULT ParseF2Edges_(SpecsBuffer *specsBuf, const MachineModel *machMdl);
   FUNC_RESULT ParseF2Blocks_(SpecsBuffer *buf);
 
   FUNC_RESULT ReadInstName_(SpecsBuffer *buf, int i, char *instName,
@@ -398,9 +492,13 @@ protected:
   void CmputCrtclPaths_();
   void CmputCrtclPathsFrmRoot_();
   void CmputCrtclPathsFrmLeaf_();
-  void CmputCrtclPathsFrmRcrsvScsr_(SchedInstruction *ref);
-  void CmputCrtclPathsFrmRcrsvPrdcsr_(SchedInstruction *ref);
-  void CmputRltvCrtclPaths_(DIRECTION dir);
+  // Fills the relative critical path matrix in one sweep over the graph in
+  // reverse topological order.
+  void BuildRltvCrtclPaths_();
+  void BuildSprirInsts_();
+  // Recomputes the recursive neighbors in the given direction for the nodes
+  // affected by the changed edges.
+  FUNC_RESULT UpdtRcrsvInfo_(DIRECTION dir);
   void CmputBasicLwrBounds_();
 
   void WriteNodeInfoToF2File_(FILE *file);
@@ -410,6 +508,31 @@ protected:
 };
 /*****************************************************************************/
 
+// A stand-alone copy of a set of instructions of a data dependence graph that
+// have no edges to the rest of the graph, e.g. a union of the groups found by
+// FindIndpndntCmpnnts(), with an artificial root and leaf of its own. The
+// copy keeps the instruction types and the edges but not the registers, so a
+// schedule of it only tells how short that part of the region can be.
+class DataDepCmpnntGraph : public DataDepGraph {
+public:
+  // Copies the instructions with the given numbers in the full graph, which
+  // becomes instruction i of the copy, followed by the root and the leaf.
+  DataDepCmpnntGraph(DataDepGraph *fullGraph, const MachineModel *machMdl,
+                     const std::vector<InstCount> &instNums, int cmpnntNum);
+
+  // Returns the number in the full graph of an instruction of the copy.
+  InstCount GetFullInstNum(InstCount instNum) const {
+    return fullInstNums_[instNum];
+  }
+
+  void convertSUnits(bool, bool) override {}
+  void convertRegFiles() override {}
+
+private:
+  std::vector<InstCount> fullInstNums_;
+};
+/*****************************************************************************/
+
 class DataDepSubGraph : public DataDepStruct {
 protected:
   DataDepGraph *fullGraph_;
@@ -423,6 +546,10 @@ protected:
 
   SchedInstruction *rootInst_;
   SchedInstruction *leafInst_;
+  // The search state of the artificial root and leaf, which do not belong to
+  // the full graph.
+  InstSchedState rootState_;
+  InstSchedState leafState_;
 
   InstCount *frwrdCrtclPaths_;
   InstCount *bkwrdCrtclPaths_;
@@ -532,7 +659,7 @@ protected:
 
 public:
   DataDepSubGraph(DataDepGraph *fullGraph, InstCount maxInstCnt,
-                  MachineModel *machMdl);
+                  const MachineModel *machMdl);
   virtual ~DataDepSubGraph();
   void InitForSchdulng(bool clearAll);
   void SetupForDynmcLwrBounds(InstCount schedUprBound);
@@ -646,17 +773,18 @@ private:
   // by the reg allocator
   int spillCnddtCnt_;
 
-  MachineModel *machMdl_;
+  const MachineModel *machMdl_;
 
   bool vrfy_;
 
-  bool VerifySlots_(MachineModel *machMdl, DataDepGraph *dataDepGraph);
+  bool VerifySlots_(const MachineModel *machMdl, DataDepGraph *dataDepGraph);
   bool VerifyDataDeps_(DataDepGraph *dataDepGraph);
   void GetCycleAndSlotNums_(InstCount globSlotNum, InstCount &cycleNum,
                             InstCount &slotNum);
 
 public:
-  InstSchedule(MachineModel *machMdl, DataDepGraph *dataDepGraph, bool vrfy);
+  InstSchedule(const MachineModel *machMdl, DataDepGraph *dataDepGraph,
+               bool vrfy);
   ~InstSchedule();
   bool operator==(InstSchedule &b) const;
 
@@ -710,7 +838,7 @@ public:
   void PrintInstList(FILE *file, DataDepGraph *dataDepGraph,
                      const char *title) const;
   void PrintRegPressures() const;
-  bool Verify(MachineModel *machMdl, DataDepGraph *dataDepGraph);
+  bool Verify(const MachineModel *machMdl, DataDepGraph *dataDepGraph);
   void PrintClassData();
 };
 /*****************************************************************************/
@@ -15,6 +15,7 @@ Last Update:  Apr. 2020
 #include "opt-sched/Scheduler/ready_list.h"
 #include "opt-sched/Scheduler/relaxed_sched.h"
 #include <iostream>
+#include <random>
 #include <vector>
 
 namespace llvm {
@@ -22,6 +23,9 @@ namespace opt_sched {
 
 const int MAX_MEMBLOCK_SIZE = 10000;
 const int TIMEOUT_TO_MEMBLOCK_RATIO = 10;
+// The number of examined sub-problems past which a reused history table is
+// cleared anyway when moving on to the next target length.
+const int MAX_REUSED_HIST_ENTRY_CNT = 1000000;
 
 class SchedRegion;
 
@@ -41,6 +45,19 @@ struct Pruning {
 
 enum ENUMTREE_NODEMODE { ETN_PRELIM, ETN_ACTIVE, ETN_HISTORY };
 
+// When to restart the enumeration of a target length with a new tie-breaking
+// order.
+enum RESTART_POLICY {
+  // Never restart.
+  RSP_NONE,
+  // Restart after a number of nodes following the Luby sequence 1, 1, 2, 1,
+  // 1, 2, 4, ... times the base node count.
+  RSP_LUBY,
+  // Restart after a number of nodes that grows geometrically from the base
+  // node count.
+  RSP_GEOMETRIC
+};
+
 struct TightndInst {
   SchedInstruction *inst;
   InstCount tightBound;
@@ -121,6 +138,8 @@ private:
   // along with a list of immediate successors that got tightened after
   // temporarily scheduling that instruction
   LinkedList<ExaminedInst> *exmndInsts_;
+  // The same instructions as a set indexed by instruction number
+  BitVector *exmndInstSet_;
 
   InstCount legalInstCnt_;
 
@@ -186,6 +205,10 @@ public:
                       bool isRlxInfsbl, bool isFsbl, DIRECTION dir,
                       bool isLngthFsbl);
 
+  // Forget the branches examined so far so that the node can be explored
+  // again starting from its first branch
+  void ResetBranches();
+
   // Check the list of examined insts. to see if a superior inst. has been
   // examined already. If yes, the branch pointer will be advanced, since
   // it is assumed that the enumerator will skip this inst
@@ -355,6 +378,13 @@ protected:
   // A pointer to a relaxed scheduler
   RJ_RelaxedScheduler *rlxdSchdulr_;
 
+  // For each node on the current path, indexed by its time, the relaxed
+  // schedule of its state before branching and the number of its branches
+  // that have been relax-scheduled. The baseline is recorded only once a
+  // second branch of the node needs a relaxed check.
+  std::vector<RlxdBaseline> rlxdBaselines_;
+  std::vector<InstCount> rlxdChkCnts_;
+
   // Array holding the number of issue slots available for each issue type
   // based on the target schedule length and the slots that have been taken
   InstCount avlblSlots_[MAX_ISSUTYPE_CNT];
@@ -379,6 +409,15 @@ protected:
   InstCount minUnschduldTplgclOrdr_;
 
   BinHashTable<HistEnumTreeNode> *exmndSubProbs_;
+  // Whether the examined sub-problems are kept when moving on to the next
+  // target length instead of being cleared by Reset().
+  bool isHstryReused_;
+  // Whether the last Reset() kept the examined sub-problems. False once the
+  // reused table has grown past MAX_REUSED_HIST_ENTRY_CNT.
+  bool isHstryKept_;
+  // Whether a best-first search is running. Its history table then holds
+  // nodes whose subtrees have not been explored yet.
+  bool isBestFrstSrch_;
 
   // A list of insts whose lower bounds have been tightened to be used for
   // efficient untightening
@@ -446,6 +485,10 @@ protected:
   // history domination
   HistEnumTreeNode *mostRecentMatchingHistNode_ = nullptr;
 
+  // The node IDs that ready lists break ties with, indexed by instruction
+  // number. Empty to use the actual node IDs.
+  std::vector<InstCount> tieBreakOrder_;
+
   inline void ClearState_();
   inline bool IsStateClear_();
 
@@ -453,7 +496,11 @@ protected:
   bool IsUseInRdyLst_();
 
   void StepFrwrd_(EnumTreeNode *&newNode);
-  virtual bool BackTrack_();
+  // Undo the last step. The current node is archived in the history table
+  // and reported to its parent as an examined branch unless isSubProbExmnd is
+  // false, which is for leaving a sub-problem that has not been fully
+  // explored.
+  virtual bool BackTrack_(bool isSubProbExmnd = true);
   inline bool WasSolnFound_();
 
   void SetInstSigs_();
@@ -498,6 +545,8 @@ protected:
 
   inline void CreateNewRdyLst_();
   bool RlxdSchdul_(EnumTreeNode *newNode);
+  // Record the relaxed baseline of the current node if it is needed.
+  void RecordRlxdBaseline_();
 
   inline InstCount GetCycleNumFrmTime_(InstCount time);
   inline int GetSlotNumFrmTime_(InstCount time);
@@ -529,6 +578,13 @@ protected:
   FUNC_RESULT FindFeasibleSchedule_(InstSchedule *sched, InstCount trgtLngth,
                                     Milliseconds deadline);
 
+  // Explore the subtree rooted at the current node depth first. Returns
+  // RES_SUCCESS if the objective was met, RES_TIMEOUT if the deadline passed,
+  // RES_END once exmndNodeLimit nodes have been examined in total and RES_FAIL
+  // once the subtree has been exhausted.
+  FUNC_RESULT ExploreSubTree_(Milliseconds deadline,
+                              uint64_t exmndNodeLimit = UINT64_MAX);
+
   // Virtual Functions
   virtual bool WasObjctvMet_() = 0;
 
@@ -543,7 +599,7 @@ protected:
   virtual void InitNewNode_(EnumTreeNode *newNode);
 
 public:
-  Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  Enumerator(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
              InstCount schedUprBound, int16_t sigHashSize,
              SchedPriorities prirts, Pruning PruningStrategy,
              bool SchedForRPOnly, bool enblStallEnum, Milliseconds timeout,
@@ -588,7 +644,7 @@ private:
   void FreeHistNode_(HistEnumTreeNode *histNode);
 
 public:
-  LengthEnumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  LengthEnumerator(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
                    InstCount schedUprBound, int16_t sigHashSize,
                    SchedPriorities prirts, Pruning PruningStrategy,
                    bool SchedForRPOnly, bool enblStallEnum,
@@ -613,6 +669,55 @@ private:
   int SpillCostLwrBound_;
   MemAlloc<CostHistEnumTreeNode> *histNodeAlctr_;
   SPILL_COST_FUNCTION spillCostFunc_;
+  // Whether the last search stopped because the best schedule got within the
+  // optimality gap, leaving part of the tree unexplored.
+  bool isGapStop_;
+
+  // The number of partial schedules that the best-first search may store
+  // before it falls back to depth-first search. Zero disables best-first
+  // search.
+  int bestFrstNodeBudget_;
+
+  // A partial schedule stored by the best-first search, represented by the
+  // instruction (or stall) that extends an earlier stored partial schedule.
+  // Its history node stays in the history table while the search runs, so
+  // that partial schedules reaching a dominated state are not stored again.
+  struct BestFrstStep {
+    int prevStep;
+    InstCount instNum;
+    HistEnumTreeNode *hstry;
+  };
+
+  // An entry in the best-first search frontier.
+  struct BestFrstNode {
+    InstCount costLwrBound;
+    InstCount depth;
+    int step;
+  };
+
+  // Order the frontier by cost lower bound, preferring deeper partial
+  // schedules on ties since they are closer to a complete schedule.
+  static bool IsBestFrstNodeLessPromising(const BestFrstNode &a,
+                                          const BestFrstNode &b) {
+    if (a.costLwrBound != b.costLwrBound)
+      return a.costLwrBound > b.costLwrBound;
+    if (a.depth != b.depth)
+      return a.depth < b.depth;
+    return a.step > b.step;
+  }
+
+  std::vector<BestFrstStep> bestFrstSteps_;
+  // A binary heap with the most promising partial schedule on top.
+  std::vector<BestFrstNode> bestFrstFrntr_;
+  std::vector<int> bestFrstPath_;
+
+  RESTART_POLICY restartPolicy_;
+  // The number of nodes examined before the first restart.
+  int restartNodeCnt_;
+  // The growth factor of the geometric restart policy.
+  float restartGrowth_;
+  // Generates the tie-breaking order after each restart.
+  std::mt19937 restartRNG_;
 
   // Virtual Functions
   void SetupAllocators_();
@@ -627,7 +732,7 @@ private:
   bool WasObjctvMetWghtd_();
   bool WasObjctvMetFrstPss_();
   bool WasObjctvMetScndPss_();
-  bool BackTrack_();
+  bool BackTrack_(bool isSubProbExmnd = true);
   InstCount GetBestCost_();
   InstCount getBestSpillCost_();
   InstCount getBestSchedLength_();
@@ -643,8 +748,44 @@ private:
   bool EnumStall_();
   void InitNewNode_(EnumTreeNode *newNode);
 
+  // The cost lower bound of the current node in terms of the cost being
+  // minimized in this pass.
+  InstCount GetCrntCostLwrBound_();
+  // Can a partial schedule with this cost lower bound still improve on the
+  // best schedule found so far?
+  bool IsCostLwrBoundFsbl_(InstCount costLwrBound);
+
+  // Best-first search: repeatedly expand the stored partial schedule with the
+  // smallest cost lower bound, then explore whatever is left in the frontier
+  // depth first once the node budget has been used up.
+  FUNC_RESULT FindFeasibleScheduleBestFrst_(InstSchedule *sched,
+                                            InstCount trgtLngth,
+                                            Milliseconds deadline);
+  // Probe every branch of the current node, storing the feasible inner
+  // children in the frontier. Returns true if the objective was met.
+  bool ExpandBestFrstNode_(const BestFrstNode &node);
+  void StoreBestFrstNode_(const BestFrstNode &parent);
+  void PushBestFrstNode_(const BestFrstNode &node);
+  BestFrstNode PopBestFrstNode_();
+  // Rebuild a stored partial schedule by stepping forward from the root.
+  // Returns false if it is no longer feasible.
+  bool ReplayBestFrstStep_(int step);
+  bool ReplayBranch_(InstCount instNum);
+  void UnwindToRoot_();
+
+  // Search depth first, restarting from the root with a random tie-breaking
+  // order whenever the restart policy's node limit is reached. The history
+  // table is kept across restarts, so fully explored sub-problems are not
+  // searched again.
+  FUNC_RESULT FindFeasibleScheduleWithRestarts_(InstSchedule *sched,
+                                                InstCount trgtLngth,
+                                                Milliseconds deadline);
+  // The number of nodes to examine before restart number restartNum.
+  uint64_t GetRestartNodeCnt_(int restartNum);
+  void RandomizeTieBreaking_();
+
 public:
-  LengthCostEnumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  LengthCostEnumerator(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
                        InstCount schedUprBound, int16_t sigHashSize,
                        SchedPriorities prirts, Pruning PruningStrategy,
                        bool SchedForRPOnly, bool enblStallEnum,
@@ -661,7 +802,23 @@ public:
                                    Milliseconds deadline);
   bool IsCostEnum();
   SPILL_COST_FUNCTION GetSpillCostFunc() { return spillCostFunc_; }
+  // Search with best-first search, falling back to depth-first search after
+  // storing nodeBudget partial schedules. Zero selects depth-first search.
+  void SetBestFrstNodeBudget(int nodeBudget) {
+    bestFrstNodeBudget_ = nodeBudget;
+  }
+  // Restart the search of each target length according to the given policy,
+  // starting with nodeCnt nodes. The tie-breaking orders used after restarts
+  // are generated from seed.
+  void SetRestartPolicy(RESTART_POLICY policy, int nodeCnt, float growth,
+                        int seed);
+  // Keep the history table across target lengths. A sub-problem examined
+  // under a shorter target length then prunes the nodes that it dominates
+  // with a shift of the length difference. Only done for the peak cost
+  // functions.
+  void SetHstryReuse(bool isReused);
   inline InstCount GetBestCost() { return GetBestCost_(); }
+  inline bool WasGapStop() const { return isGapStop_; }
   inline InstCount getBestSpillCost() { return getBestSpillCost_(); }
   inline InstCount getBestSchedLength() { return getBestSchedLength_(); }
 
@@ -1027,7 +1184,11 @@ inline int Enumerator::GetSearchCnt() { return iterNum_; }
 inline void Enumerator::CreateNewRdyLst_() {
   ReadyList *oldLst = rdyLst_;
 
-  rdyLst_ = new ReadyList(dataDepGraph_, prirts_);
+  // Each tree node copies its parent's list, which is cheapest as a bit
+  // vector.
+  rdyLst_ = new ReadyList(dataDepGraph_, prirts_, true);
+  if (!tieBreakOrder_.empty())
+    rdyLst_->setTieBreakOrder(tieBreakOrder_.data());
 
   if (oldLst != NULL) {
     rdyLst_->CopyList(oldLst);
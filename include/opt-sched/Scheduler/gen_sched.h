@@ -53,7 +53,7 @@ class InstScheduler {
 public:
   // Constructs a scheduler for the given machine and dependence graph, with
   // the specified upper bound.
-  InstScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+  InstScheduler(DataDepStruct *dataDepGraph, const MachineModel *machMdl,
                 InstCount schedUprBound);
   // Deallocates memory used by the scheduler.
   virtual ~InstScheduler();
@@ -62,7 +62,7 @@ public:
 
 protected:
   // A pointer to the machine which this scheduler uses
-  MachineModel *machMdl_;
+  const MachineModel *machMdl_;
 
   // The issue rate of the underlying machine model.
   // TODO(ghassan): Eliminate.
@@ -104,7 +104,7 @@ class ConstrainedScheduler : public InstScheduler {
 public:
   // Constructs a constrained scheduler for the given machine and dependence
   // graph, with the specified upper bound.
-  ConstrainedScheduler(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  ConstrainedScheduler(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
                        InstCount schedUprBound);
   // Deallocates memory used by the scheduler.
   virtual ~ConstrainedScheduler();
@@ -12,6 +12,7 @@ Last Update:  Mar. 2011
 #include "opt-sched/Scheduler/bit_vector.h"
 #include "opt-sched/Scheduler/defines.h"
 #include "opt-sched/Scheduler/lnkd_lst.h"
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
@@ -67,6 +68,22 @@ struct GraphEdge {
   }
 };
 
+// A read-only view of a node's successor or predecessor edges inside the
+// compressed sparse row (CSR) edge arrays built by
+// DirAcycGraph::BuildEdgeArrays(). Entry i describes the i-th edge in the
+// node's successor (predecessor) list.
+struct GraphEdgeSpan {
+  // The node on the other side of each edge.
+  GraphNode *const *nodes;
+  // The first and second labels of each edge.
+  const UDT_GLABEL *lbls;
+  const UDT_GLABEL *lbl2s;
+  // The order of this node in the other node's predecessor (successor) list.
+  const UDT_GEDGES *ordrs;
+  // The number of edges.
+  UDT_GEDGES cnt;
+};
+
 // TODO(max): Refactor. This has far too much stuff for a simple node.
 class GraphNode {
 public:
@@ -145,6 +162,14 @@ public:
   // Gets an iterable range of the successors of this node
   const LinkedList<GraphEdge> &GetSuccessors() const;
   LinkedList<GraphEdge> &GetSuccessors();
+  // Returns this node's successor (predecessor) edges in the graph's CSR edge
+  // arrays. Only valid after DirAcycGraph::BuildEdgeArrays() and until the
+  // next edge mutation.
+  const GraphEdgeSpan &GetScsrSpan() const;
+  const GraphEdgeSpan &GetPrdcsrSpan() const;
+  // Returns the predecessor or successor span, depending on the specified
+  // direction (same convention as GetNghbrLst()).
+  const GraphEdgeSpan &GetNghbrSpan(DIRECTION dir) const;
   // Checks if a given node is successor-equivalent to this node. Two nodes
   // are successor-equivalent if they have identical successor lists.
   bool IsScsrEquvlnt(GraphNode *othrNode);
@@ -241,6 +266,9 @@ private:
   PriorityList<GraphEdge> *scsrLst_;
   // A list of the immediate predecessors of this node.
   LinkedList<GraphEdge> *prdcsrLst_;
+  // The CSR views of the two lists above. Set by DirAcycGraph.
+  GraphEdgeSpan scsrSpan_;
+  GraphEdgeSpan prdcsrSpan_;
   // A list of all recursively successors of this node.
   LinkedList<GraphNode> *rcrsvScsrLst_;
   // A list of all recursively predecessors of this node.
@@ -264,6 +292,8 @@ private:
   // The color of this node, to be used during traversal.
   GNODE_COLOR color_;
 
+  friend class DirAcycGraph;
+
 protected:
   // TODO(max): Document what this is.
   bool FindScsr_(GraphNode *&crntScsr, UDT_GNODES trgtNum, UDT_GLABEL trgtLbl);
@@ -320,6 +350,14 @@ public:
   // Fills the recursive predecessor or successor lists for each node in the
   // graph, depending on the specified direction.
   FUNC_RESULT FindRcrsvNghbrs(DIRECTION dir);
+  // Refills the recursive neighbor list of a single node in the specified
+  // direction. Returns an error if a cycle was detected.
+  FUNC_RESULT FindRcrsvNghbrs(GraphNode *node, DIRECTION dir);
+  // Packs the successor and predecessor lists of all nodes into contiguous
+  // CSR arrays and points each node's edge spans into them. The linked lists
+  // remain the mutable representation, so this must be called again after
+  // any edge is added or removed.
+  void BuildEdgeArrays();
 
   inline void CycleDetected() { cycleDetected_ = true; }
 
@@ -354,6 +392,20 @@ protected:
   // Has a cycle been detected in this graph?
   bool cycleDetected_;
 
+  // The CSR form of the successor or predecessor lists of all nodes, with
+  // one entry per edge, grouped by node number.
+  struct EdgeArrays {
+    std::vector<GraphNode *> nodes;
+    std::vector<UDT_GLABEL> lbls;
+    std::vector<UDT_GLABEL> lbl2s;
+    std::vector<UDT_GEDGES> ordrs;
+
+    void Resize(UDT_GEDGES edgeCnt);
+    GraphEdgeSpan GetSpan(UDT_GEDGES bgn, UDT_GEDGES end) const;
+  };
+  EdgeArrays scsrArrays_;
+  EdgeArrays prdcsrArrays_;
+
   // Creates a new edge between two nodes with the given numbers with the
   // given label.
   void CreateEdge_(UDT_GNODES frmNodeNum, UDT_GNODES toNodeNum, UDT_GLABEL lbl);
@@ -582,6 +634,20 @@ inline LinkedList<GraphEdge> *GraphNode::GetNghbrLst(DIRECTION dir) {
   return dir == DIR_FRWRD ? prdcsrLst_ : scsrLst_;
 }
 
+inline const GraphEdgeSpan &GraphNode::GetScsrSpan() const {
+  assert(scsrSpan_.cnt == scsrLst_->GetElmntCnt());
+  return scsrSpan_;
+}
+
+inline const GraphEdgeSpan &GraphNode::GetPrdcsrSpan() const {
+  assert(prdcsrSpan_.cnt == prdcsrLst_->GetElmntCnt());
+  return prdcsrSpan_;
+}
+
+inline const GraphEdgeSpan &GraphNode::GetNghbrSpan(DIRECTION dir) const {
+  return dir == DIR_FRWRD ? GetPrdcsrSpan() : GetScsrSpan();
+}
+
 inline GraphEdge *GraphNode::GetFrstScsrEdge() {
   return scsrLst_->GetFrstElmnt();
 }
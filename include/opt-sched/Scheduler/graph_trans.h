@@ -12,8 +12,9 @@ Last Update:  June. 2017
 #include "opt-sched/Scheduler/defines.h"
 #include "opt-sched/Scheduler/lnkd_lst.h"
 #include "opt-sched/Scheduler/sched_region.h"
-#include <list>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
@@ -102,6 +103,38 @@ private:
   // Are multiple passes enabled.
   bool IsMultiPass;
 
+  // An independent pair of nodes with no superiority between them when the
+  // pair was last checked.
+  struct IndepPair {
+    SchedInstruction *A;
+    SchedInstruction *B;
+    // The value of ChngStamp when the pair was last checked.
+    unsigned ChckStamp;
+  };
+
+  // Incremented each time an added edge changes the recursive neighbors of
+  // some nodes.
+  unsigned ChngStamp;
+  // The value of ChngStamp when the recursive neighbors of each node, indexed
+  // by node number, last changed.
+  std::vector<unsigned> NodeChngStamps;
+  // The number of recursive predecessors plus recursive successors of each
+  // node when it was last stamped. Adding edges only ever adds recursive
+  // neighbors, so the sets changed iff this number did.
+  std::vector<UDT_GEDGES> NodeRcrsvNghbrCnts;
+
+  // Stamps the nodes whose recursive neighbors the newly added edge changed.
+  // These can only be its source and the source's recursive predecessors,
+  // and its target and the target's recursive successors.
+  void noteRcrsvNghbrChng_(GraphEdge *Edge);
+  // Returns true if the recursive neighbors of either node of the pair
+  // changed after it was last checked. Nothing else that decides whether the
+  // nodes are independent and whether one is superior changes.
+  bool needsRechck_(const IndepPair &Pair) const {
+    return std::max(NodeChngStamps[Pair.A->GetNum()],
+                    NodeChngStamps[Pair.B->GetNum()]) > Pair.ChckStamp;
+  }
+
   // Return true if node A is superior to node B.
   bool NodeIsSuperior_(SchedInstruction *nodeA, SchedInstruction *nodeB) {
     return isNodeSuperior(*GetDataDepGraph_(), nodeA->GetNum(),
@@ -116,8 +149,7 @@ private:
 
   // Keep trying to find superior nodes until none can be found or there are no
   // more independent nodes.
-  void nodeMultiPass_(
-      std::list<std::pair<SchedInstruction *, SchedInstruction *>>);
+  void nodeMultiPass_(std::vector<IndepPair> IndepPairs);
 };
 
 } // namespace opt_sched
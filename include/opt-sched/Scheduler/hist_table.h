@@ -32,6 +32,7 @@ public:
   virtual ~HistEnumTreeNode();
 
   InstCount GetTime();
+  InstCount GetTrgtLngth() { return trgtLngth_; }
   void PrntPartialSched(std::ostream &out);
   bool CompPartialScheds(HistEnumTreeNode *othrHist);
   InstCount GetInstNum();
@@ -62,6 +63,9 @@ protected:
 
   SchedInstruction *inst_;
 
+  // The target length under which the sub-problem at this node was examined.
+  InstCount trgtLngth_;
+
 #ifdef IS_DEBUG
   bool isCnstrctd_;
 #endif
@@ -129,6 +133,7 @@ protected:
   bool chkCostDmntnForTwoPass(EnumTreeNode *Node, LengthCostEnumerator *E);
   bool ChkCostDmntn_(EnumTreeNode *node, LengthCostEnumerator *enumrtr,
                      InstCount &maxShft);
+  bool chkCostDmntnForShft(EnumTreeNode *Node, LengthCostEnumerator *LCE);
   virtual void Init_();
 };
 
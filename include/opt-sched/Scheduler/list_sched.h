@@ -11,6 +11,7 @@ Last Update:  Sept. 2013
 #define OPTSCHED_LIST_SCHED_LIST_SCHED_H
 
 #include "opt-sched/Scheduler/gen_sched.h"
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
@@ -19,7 +20,7 @@ class ListScheduler : public ConstrainedScheduler {
 public:
   // Creates a list scheduler for the given dependence graph, machine and
   // schedule upper bound, using the specified heuristic.
-  ListScheduler(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  ListScheduler(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
                 InstCount schedUprBound, SchedPriorities prirts);
   virtual ~ListScheduler();
 
@@ -41,7 +42,8 @@ protected:
 // regardless of latency or machine model constraints.
 class SequentialListScheduler : public ListScheduler {
 public:
-  SequentialListScheduler(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+  SequentialListScheduler(DataDepGraph *dataDepGraph,
+                          const MachineModel *machMdl,
                           InstCount schedUprBound, SchedPriorities prirts);
 
 private:
@@ -60,12 +62,39 @@ private:
 class StallSchedulingListScheduler : public ListScheduler {
 public:
   StallSchedulingListScheduler(DataDepGraph *dataDepGraph,
-                               MachineModel *machMdl, InstCount schedUprBound,
+                               const MachineModel *machMdl,
+                               InstCount schedUprBound,
                                SchedPriorities prirts);
 
   SchedInstruction *PickInst() const;
 };
 
+// A list scheduler that interleaves schedules of independent parts of the
+// region. Among the legal ready instructions, it picks the one scheduled
+// earliest in its part's schedule, breaking ties by the heuristic, so that
+// instructions get delayed only when the parts compete for issue slots. Each
+// part keeps the order of its schedule: an instruction is only legal once the
+// instructions of the previous cycle of its part's schedule are scheduled.
+class InterleavingListScheduler : public ListScheduler {
+public:
+  // parts lists the instructions of each part. prefCycles[i] is the cycle of
+  // instruction i in its part's schedule.
+  InterleavingListScheduler(DataDepGraph *dataDepGraph,
+                            const MachineModel *machMdl,
+                            InstCount schedUprBound, SchedPriorities prirts,
+                            const std::vector<std::vector<InstCount>> &parts,
+                            std::vector<InstCount> prefCycles);
+
+  SchedInstruction *PickInst() const override;
+
+private:
+  std::vector<InstCount> prefCycles_;
+  // The instructions of the previous cycle of each instruction's part.
+  std::vector<std::vector<InstCount>> prevInPart_;
+
+  bool ChkInstLglty_(SchedInstruction *inst) const override;
+};
+
 } // namespace opt_sched
 } // namespace llvm
 
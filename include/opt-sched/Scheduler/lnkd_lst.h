@@ -17,7 +17,9 @@ Last Update:  May  2020
 #include "llvm/ADT/iterator.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <cstring>
+#include <functional>
 #include <iterator>
+#include <map>
 #include <type_traits>
 
 namespace llvm {
@@ -347,11 +349,11 @@ public:
   // Insert a new element by automatically finding its place in the list.
   // If allowDplct is false, the element will not be inserted if another
   // element with the same key exists.
-  KeyedEntry<T, K> *InsrtElmnt(T *elmnt, K key, bool allowDplct);
+  virtual KeyedEntry<T, K> *InsrtElmnt(T *elmnt, K key, bool allowDplct);
   // Disable the version from LinkedList.
   void InsrtElmnt(T *) { llvm::report_fatal_error("Unimplemented.", false); }
   // Updates an entry's key and moves it to its correct place.
-  void BoostEntry(KeyedEntry<T, K> *entry, K newKey);
+  virtual void BoostEntry(KeyedEntry<T, K> *entry, K newKey);
   // Gets the next element in the list, based on the "current" element.
   // Returns NULL when the end of the list has been reached. If key is
   // provided, it is filled with the key of the retrieved element.
@@ -371,6 +373,46 @@ protected:
   virtual void InsrtEntry_(KeyedEntry<T, K> *entry, KeyedEntry<T, K> *next);
 };
 
+// A priority list that also keeps the first and last entry of each key in a
+// search tree. An insertion or a boost finds its place in time logarithmic
+// in the number of distinct keys instead of scanning the list. The entries
+// are kept in the same order as in PriorityList and are iterated the same
+// way, so either list can be used at a given use site.
+template <class T, class K = unsigned long>
+class IndexedPriorityList : public PriorityList<T, K> {
+public:
+  inline IndexedPriorityList(int maxSize = INVALID_VALUE)
+      : PriorityList<T, K>(maxSize) {}
+
+  // The same as in PriorityList.
+  using PriorityList<T, K>::InsrtElmnt;
+  KeyedEntry<T, K> *InsrtElmnt(T *elmnt, K key, bool allowDplct) override;
+  void BoostEntry(KeyedEntry<T, K> *entry, K newKey) override;
+  // Removes the entry through RmvEntry_() so that the index stays current.
+  void RmvElmnt(const T *const elmnt) override;
+
+protected:
+  // The first and the last entry with a given key.
+  struct KeyRange {
+    KeyedEntry<T, K> *frst;
+    KeyedEntry<T, K> *last;
+  };
+  // The key ranges, from the highest key to the lowest.
+  std::map<K, KeyRange, std::greater<K>> keyRanges_;
+
+  // Indexes the entries that CopyList() appends.
+  void AppendEntry_(Entry<T> *entry) override;
+  void RmvEntry_(Entry<T> *entry, bool free = true) override;
+  void Init_() override;
+  // Links in an entry that is not in the list as the first (or the last)
+  // entry with its key.
+  void Link_(KeyedEntry<T, K> *entry, bool asFrst);
+  // Adds an entry that is already in its place in the list to the index.
+  void Index_(KeyedEntry<T, K> *entry);
+  // Removes an entry from the index but not from the list.
+  void Unindex_(KeyedEntry<T, K> *entry);
+};
+
 template <class T>
 inline LinkedList<T>::LinkedList(int MaxSize)
     : LinkedList(makeDynamicOrArenaAllocator<Entry<T>>(MaxSize)) {}
@@ -757,6 +799,8 @@ void PriorityList<T, K>::BoostEntry(KeyedEntry<T, K> *entry, K newKey) {
     if (entry == LinkedList<T>::bottomEntry_ || next->key <= newKey)
       return;
 
+    // If all the following entries have larger keys, it goes to the bottom.
+    next = NULL;
     for (crnt = entry->GetNext(); crnt != NULL; crnt = crnt->GetNext()) {
       if (crnt->key <= newKey) {
         next = crnt;
@@ -782,7 +826,7 @@ void PriorityList<T, K>::CopyList(
     T *elmnt = entry->element;
     K key = entry->key;
     KeyedEntry<T, K> *newEntry = AllocEntry_(elmnt, key);
-    LinkedList<T>::AppendEntry_(newEntry);
+    this->AppendEntry_(newEntry);
     if (!keyedEntries_.empty()) {
       const auto elementNum = entry->element->GetNum();
       assert(0 <= elementNum &&
@@ -835,6 +879,126 @@ void PriorityList<T, K>::InsrtEntry_(KeyedEntry<T, K> *entry,
   LinkedList<T>::elmntCnt_++;
 }
 
+template <class T, class K>
+KeyedEntry<T, K> *IndexedPriorityList<T, K>::InsrtElmnt(T *elmnt, K key,
+                                                        bool allowDplct) {
+  if (!allowDplct) {
+    auto it = keyRanges_.find(key);
+    if (it != keyRanges_.end())
+      return it->second.last;
+  }
+
+  KeyedEntry<T, K> *newEntry = PriorityList<T, K>::AllocEntry_(elmnt, key);
+  Link_(newEntry, false);
+  LinkedList<T>::itrtrReset_ = true;
+  return newEntry;
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::BoostEntry(KeyedEntry<T, K> *entry, K newKey) {
+  KeyedEntry<T, K> *next = entry->GetNext();
+  KeyedEntry<T, K> *prev = entry->GetPrev();
+  if (entry->key == newKey)
+    return;
+
+  // Mirror PriorityList::BoostEntry(): an entry moving up goes after the
+  // entries with the same key and one moving down goes before them.
+  bool isUp = entry->key < newKey;
+  bool staysInPlace = isUp ? prev == NULL || prev->key >= newKey
+                           : next == NULL || next->key <= newKey;
+
+  if (staysInPlace) {
+    Unindex_(entry);
+    entry->key = newKey;
+    Index_(entry);
+    return;
+  }
+
+  RmvEntry_(entry, false);
+  entry->key = newKey;
+  Link_(entry, !isUp);
+  this->itrtrReset_ = true;
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::RmvElmnt(const T *const elmnt) {
+  for (Entry<T> *crnt = LinkedList<T>::topEntry_; crnt != NULL;
+       crnt = crnt->GetNext()) {
+    if (crnt->element == elmnt) {
+      RmvEntry_(crnt);
+      LinkedList<T>::itrtrReset_ = true;
+      return;
+    }
+  }
+  llvm::report_fatal_error("Invalid linked list removal.", false);
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::AppendEntry_(Entry<T> *entry) {
+  LinkedList<T>::AppendEntry_(entry);
+  Index_((KeyedEntry<T, K> *)entry);
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::RmvEntry_(Entry<T> *entry, bool free) {
+  Unindex_((KeyedEntry<T, K> *)entry);
+  LinkedList<T>::RmvEntry_(entry, free);
+}
+
+template <class T, class K> void IndexedPriorityList<T, K>::Init_() {
+  LinkedList<T>::Init_();
+  keyRanges_.clear();
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::Link_(KeyedEntry<T, K> *entry, bool asFrst) {
+  // The first range whose key is not higher than the entry's.
+  auto it = keyRanges_.lower_bound(entry->key);
+  KeyedEntry<T, K> *next;
+
+  if (it != keyRanges_.end() && it->first == entry->key) {
+    if (asFrst) {
+      next = it->second.frst;
+      it->second.frst = entry;
+    } else {
+      next = it->second.last->GetNext();
+      it->second.last = entry;
+    }
+  } else {
+    next = it == keyRanges_.end() ? NULL : it->second.frst;
+    keyRanges_.emplace_hint(it, entry->key, KeyRange{entry, entry});
+  }
+
+  PriorityList<T, K>::InsrtEntry_(entry, next);
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::Index_(KeyedEntry<T, K> *entry) {
+  auto it = keyRanges_.find(entry->key);
+  if (it == keyRanges_.end()) {
+    keyRanges_.emplace(entry->key, KeyRange{entry, entry});
+  } else if (entry->GetNext() == it->second.frst) {
+    it->second.frst = entry;
+  } else {
+    assert(entry->GetPrev() == it->second.last);
+    it->second.last = entry;
+  }
+}
+
+template <class T, class K>
+void IndexedPriorityList<T, K>::Unindex_(KeyedEntry<T, K> *entry) {
+  auto it = keyRanges_.find(entry->key);
+  assert(it != keyRanges_.end());
+  KeyRange &range = it->second;
+
+  if (range.frst == entry && range.last == entry)
+    keyRanges_.erase(it);
+  else if (range.frst == entry)
+    range.frst = entry->GetNext();
+  else if (range.last == entry)
+    range.last = entry->GetPrev();
+}
+
 } // namespace opt_sched
 } // namespace llvm
 
@@ -58,6 +58,17 @@ void Error(const char *format_string, ...);
 void Info(const char *format_string, ...);
 void Summary(const char *format_string, ...);
 
+// While an instance is alive, info and summary messages and events are
+// dropped. For nested work whose results the caller reports itself. Errors
+// are still logged.
+class Silence {
+public:
+  Silence();
+  ~Silence();
+  Silence(const Silence &) = delete;
+  Silence &operator=(const Silence &) = delete;
+};
+
 namespace detail {
 // TODO: When we get C++17, get rid of EventAttrType and EventAttrValue in favor
 // of a std::variant.
@@ -12,22 +12,35 @@ Last Update:  Sept. 2013
 #ifndef OPTSCHED_BASIC_READY_LIST_H
 #define OPTSCHED_BASIC_READY_LIST_H
 
+#include "opt-sched/Scheduler/bit_vector.h"
 #include "opt-sched/Scheduler/defines.h"
 #include "opt-sched/Scheduler/lnkd_lst.h"
 #include "opt-sched/Scheduler/sched_basic_data.h"
 #include "llvm/ADT/SmallVector.h"
 #include <cstdio>
+#include <memory>
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
 
 // A priority list of instruction that are ready to schedule at a given point
 // during the scheduling process.
+//
+// A list with static priorities can be kept as a bit vector instead. The keys
+// then never change, so all instructions are sorted by key once and the list
+// is a bit vector over their ranks in that order. Adding and removing
+// instructions are then bit operations, the iterator finds the next one bit,
+// and copying the list copies one bit per instruction. The sorted order is
+// shared by all copies of a list.
 class ReadyList {
 public:
   // Constructs a ready list for the specified dependence graph with the
-  // specified priorities.
-  ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts);
+  // specified priorities. With useRdyBits and static priorities, the list is
+  // kept as a bit vector, and instructions with the same key come in the order
+  // of their numbers. Otherwise, they come in the order they were added.
+  ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts,
+            bool useRdyBits = false);
   // Destroys the ready list and deallocates the memory used by it.
   ~ReadyList();
 
@@ -67,7 +80,8 @@ public:
   // TODO(max): Elaborate.
   void RemoveLatestSubList();
 
-  // Copies this list to another. Both lists must be empty.
+  // Copies another list, including its iterator position, to this one. This
+  // list must be empty.
   void CopyList(ReadyList *otherLst);
 
   // Searches the list for an instruction, returning whether it has been found
@@ -78,6 +92,15 @@ public:
   // Called only if the priorities change dynamically during scheduling
   void UpdatePriorities();
 
+  // Break ties with order[i] in place of the node ID of instruction i, where
+  // order is a permutation of the instruction numbers. Only applies to the
+  // NID and LLVM priority schemes. The array must outlive the list.
+  void setTieBreakOrder(const InstCount *order) { tieBreakOrder_ = order; }
+
+  // Recompute the key of every instruction in the list, e.g. after the
+  // tie-breaking order has changed.
+  void RecomputeKeys();
+
   unsigned long MaxPriority();
 
   // Prints out the ready list, nicely formatted, into an output stream.
@@ -88,18 +111,49 @@ public:
 
   template <typename InstructionVisitor>
   void ForEachReadyInstruction(InstructionVisitor &&visitor) const {
+    if (useRdyBits_) {
+      for (int rank = rdyBits_.FindFrstOne(); rank != -1;
+           rank = rdyBits_.FindNxtOne(rank))
+        visitor(*prirtyOrdr_->insts[rank]);
+      return;
+    }
     for (const SchedInstruction &Inst : prirtyLst_) {
       visitor(Inst);
     }
   }
 
 private:
+  // All instructions of a graph in priority order, for static priorities.
+  struct PrirtyOrdr {
+    // The instructions by rank, in descending key order. Ties are broken in
+    // instruction number order.
+    std::vector<SchedInstruction *> insts;
+    // The key of the instruction at each rank.
+    std::vector<unsigned long> keys;
+    // The rank of each instruction, by instruction number.
+    std::vector<InstCount> ranks;
+  };
+
   // An ordered vector of priorities
   SchedPriorities prirts_;
 
-  // The priority list containing the actual instructions.
+  DataDepGraph *dataDepGraph_;
+
+  // The priority list containing the actual instructions. Unused with static
+  // priorities.
   PriorityList<SchedInstruction> prirtyLst_;
 
+  // Whether the bit vector below holds the instructions instead of
+  // prirtyLst_.
+  bool useRdyBits_;
+  // The priority order, built on the first insertion and shared with copies.
+  std::shared_ptr<const PrirtyOrdr> prirtyOrdr_;
+  // The ranks of the instructions in the list.
+  BitVector rdyBits_;
+  // The rank of the instruction last returned by GetNextPriorityInst(), or
+  // INVALID_VALUE if the iterator has been reset.
+  InstCount itrtrRank_;
+
   // TODO(max): Document.
   LinkedList<SchedInstruction> latestSubLst_;
 
@@ -120,6 +174,9 @@ private:
 
   unsigned long maxPriority_;
 
+  // The node IDs used to break ties, or null to use the actual node IDs.
+  const InstCount *tieBreakOrder_ = nullptr;
+
   // The number of bits for each part of the priority key.
   int16_t useCntBits_;
   int16_t crtclPathBits_;
@@ -132,6 +189,9 @@ private:
   // to the ready list already.
   void AddLatestSubList_(LinkedList<SchedInstruction> *lst);
 
+  // Sorts all instructions of the graph by their current keys.
+  void BuildPrirtyOrdr_();
+
   // Calculates a new priority key given an existing key of size keySize by
   // appending bitCnt bits holding the value val, assuming val < maxVal.
   static void AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
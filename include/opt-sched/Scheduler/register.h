@@ -78,17 +78,23 @@ public:
   int GetConflictCnt() const;
   bool IsSpillCandidate() const;
 
+  // The live intervals are bit vectors indexed by instruction number, so
+  // resetLiveInterval() must be called with the number of instructions in the
+  // region before any instruction is added to them.
   // Returns true if an insertion actually occurred.
   bool AddToInterval(const SchedInstruction *inst);
+  // Adds all the instructions in a set. Returns the number of instructions
+  // that were not already in the interval.
+  int AddToInterval(const BitVector &insts);
   bool IsInInterval(const SchedInstruction *inst) const;
-  const InstSetType &GetLiveInterval() const;
+  const BitVector &GetLiveInterval() const;
 
   // Returns true if an insertion actually occurred.
   bool AddToPossibleInterval(const SchedInstruction *inst);
   bool IsInPossibleInterval(const SchedInstruction *inst) const;
-  const InstSetType &GetPossibleLiveInterval() const;
+  const BitVector &GetPossibleLiveInterval() const;
 
-  void resetLiveInterval();
+  void resetLiveInterval(int instCnt);
 
 private:
   int16_t type_;
@@ -117,12 +123,12 @@ private:
   // (Chris): The live interval set is the set of instructions that are
   // guaranteed to be in this register's live interval. This is computed
   // during the naive and closure static lower bound analysis.
-  InstSetType liveIntervalSet_;
+  BitVector liveIntervalSet_;
 
   // (Chris): The possible live interval set is the set of instructions that
   // may or may not be added to the live interval of this register. This is
   // computed during the common use lower bound analysis.
-  InstSetType possibleLiveIntervalSet_;
+  BitVector possibleLiveIntervalSet_;
 };
 
 // Represents a file of registers of a certain type and tracks their usages.
@@ -11,6 +11,8 @@ Last Update:  Mar. 2011
 #include "opt-sched/Scheduler/data_dep.h"
 #include "opt-sched/Scheduler/gen_sched.h"
 #include "opt-sched/Scheduler/hash_table.h"
+#include <algorithm>
+#include <vector>
 
 namespace llvm {
 namespace opt_sched {
@@ -29,8 +31,12 @@ protected:
   // A list of instructions sorted by scheduling order
   PriorityList<SchedInstruction> *instLst_;
 
-  // An two-dimensional array holding the next available cycle number for each
-  // issue type for each release time
+  // A disjoint-set forest per issue type over the cycles, where each cycle
+  // that has an available slot of that type is a root and each full cycle
+  // points to a later cycle. Finding the root of a cycle gives the next
+  // available cycle. Each array has an extra cycle at schedUprBound_ that is
+  // never full. The forest is valid from the cycle passed to the last call
+  // to Reset_() or InitChkng_() on.
   InstCount *nxtAvlblCycles_[MAX_ISSUTYPE_CNT];
 
   // A two-dimensional array indexed by issue type and cycle number, where
@@ -40,6 +46,10 @@ protected:
 
   int16_t *prevAvlblSlots_[MAX_ISSUTYPE_CNT];
 
+  // One past the last cycle in which a slot may have been taken since the
+  // last Reset_(). Resetting stops there.
+  InstCount dirtyCycleEnd_;
+
   bool *isFxd_;
   bool useFxng_;
 
@@ -69,6 +79,8 @@ protected:
   InstCount SchdulInst_(SchedInstruction *inst, InstCount minCycle,
                         InstCount maxCycle);
   inline InstCount FindNxtAvlblCycle_(IssueType issuType, InstCount strtCycle);
+  // Take a slot of the given type in a cycle that has one available.
+  inline void TakeSlot_(IssueType issuType, InstCount cycle);
 
   inline InstCount CmputDelay_(InstCount schedCycle, InstCount lastCycle,
                                InstCount distFrmLeaf);
@@ -94,7 +106,7 @@ protected:
   void Reset_(InstCount startIndx);
 
 public:
-  RelaxedScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+  RelaxedScheduler(DataDepStruct *dataDepGraph, const MachineModel *machMdl,
                    InstCount uprBound, DIRECTION schedDir,
                    RLXD_SCHED_TYPE schedType, InstCount maxInstCnt);
   virtual ~RelaxedScheduler();
@@ -108,17 +120,45 @@ public:
 };
 /*****************************************************************************/
 
+// A relaxed schedule of the state at an enumeration tree node, recorded before
+// any of the node's branches is fixed. The branches differ from that state by
+// the few instructions that they fix or whose release times they tighten, so
+// each branch can be checked starting from the first step of this schedule
+// that the branch changes.
+struct RlxdBaseline {
+  bool isValid = false;
+  InstCount crntCycle;
+  InstCount lastCycle;
+  // Whether the schedule was feasible, and the number of steps taken up to
+  // and including the first one that was not.
+  bool fsbl;
+  InstCount stepCnt;
+  // The release time used at each step of the priority order, or
+  // INVALID_VALUE if the instruction was fixed, and the cycle it was
+  // relaxed-scheduled in.
+  std::vector<InstCount> rlsTimes;
+  std::vector<InstCount> cycles;
+};
+/*****************************************************************************/
+
 class RJ_RelaxedScheduler : public RelaxedScheduler {
 private:
   InstCount chkdInstCnt_;
 
+  // The instructions in instLst_, in priority order.
+  std::vector<SchedInstruction *> prirtyOrdr_;
+
   void Initialize_(bool setPrirtyLst);
   void InitChkng_(InstCount crntCycle);
   void EndChkng_(InstCount crntCycle);
   bool FixInsts_(LinkedList<SchedInstruction> *fxdLst);
+  // Relax-schedule the unfixed instructions from the given step of the
+  // priority order on.
+  bool SchdulAndChkFsblty_(InstCount strtStep, InstCount crntCycle,
+                           InstCount lastCycle);
 
 public:
-  RJ_RelaxedScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+  RJ_RelaxedScheduler(DataDepStruct *dataDepGraph, const MachineModel *machMdl,
                       InstCount uprBound, DIRECTION schedDir,
                       RLXD_SCHED_TYPE schedType,
                       InstCount maxInstCnt = INVALID_VALUE);
@@ -133,6 +173,20 @@ public:
   // the given last cycle. Return true if this is feasible and false if not
   bool SchdulAndChkFsblty(InstCount crntCycle, InstCount lastCycle);
 
+  // The same check, starting from a baseline that was recorded in the same
+  // cycle for a state that this one only adds fixed instructions and later
+  // release times to. The steps before the first one that this state
+  // changes are replayed without searching for slots, and if they include
+  // the step at which the baseline became infeasible, so does this state.
+  bool SchdulAndChkFsblty(InstCount crntCycle, InstCount lastCycle,
+                          const RlxdBaseline &bsln);
+
+  // Record the relaxed schedule of the current state as a baseline for the
+  // checks of states derived from it in the given cycle. Release times
+  // earlier than that cycle are taken to be that cycle.
+  void RecordBaseline(InstCount crntCycle, InstCount lastCycle,
+                      RlxdBaseline &bsln);
+
   bool CmputDynmcLwrBound(InstCount trgtLastCycle, InstCount trgtLwrBound,
                           InstCount &schedLwrBound);
 
@@ -152,7 +206,7 @@ class LC_RelaxedScheduler : public RelaxedScheduler {
 private:
   // A list of instructions in a subgraph sorted by lower bound measured
   // relative to the sub-graph's leaf.
-  PriorityList<SchedInstruction> *subGraphInstLst_;
+  IndexedPriorityList<SchedInstruction> *subGraphInstLst_;
 
   void Initialize_();
   void InitSubGraph_();
@@ -164,7 +218,7 @@ private:
   InstCount CmputReleaseTime_(SchedInstruction *inst);
 
 public:
-  LC_RelaxedScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+  LC_RelaxedScheduler(DataDepStruct *dataDepGraph, const MachineModel *machMdl,
                       InstCount uprBound, DIRECTION schedDir);
   ~LC_RelaxedScheduler();
 
@@ -220,7 +274,7 @@ private:
                    InstCount trgtCycle);
 
 public:
-  LPP_RelaxedScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+  LPP_RelaxedScheduler(DataDepStruct *dataDepGraph, const MachineModel *machMdl,
                        InstCount uprBound, DIRECTION schedDir);
   ~LPP_RelaxedScheduler();
 
@@ -241,16 +295,30 @@ In line Functions
 
 InstCount RelaxedScheduler::FindNxtAvlblCycle_(IssueType issuType,
                                                InstCount strtCycle) {
-  for (InstCount cycleNum = strtCycle; cycleNum < schedUprBound_; cycleNum++) {
-    assert(issuType < issuTypeCnt_);
-
-    if (avlblSlots_[issuType][cycleNum] > 0) {
-      return cycleNum;
-    }
+  assert(issuType < issuTypeCnt_);
+  InstCount *nxtCycles = nxtAvlblCycles_[issuType];
+  InstCount cycleNum = strtCycle;
+
+  // Path halving: point every other cycle on the path to its grandparent.
+  while (nxtCycles[cycleNum] != cycleNum) {
+    nxtCycles[cycleNum] = nxtCycles[nxtCycles[cycleNum]];
+    cycleNum = nxtCycles[cycleNum];
   }
 
-  assert(false);
-  return INVALID_VALUE;
+  assert(cycleNum < schedUprBound_);
+  return cycleNum;
+}
+/*****************************************************************************/
+
+void RelaxedScheduler::TakeSlot_(IssueType issuType, InstCount cycle) {
+  assert(avlblSlots_[issuType][cycle] > 0);
+  avlblSlots_[issuType][cycle]--;
+  dirtyCycleEnd_ = std::max(dirtyCycleEnd_, cycle + 1);
+
+  // Merge a full cycle into the set of the following cycle.
+  if (avlblSlots_[issuType][cycle] == 0) {
+    nxtAvlblCycles_[issuType][cycle] = cycle + 1;
+  }
 }
 /*****************************************************************************/
 
@@ -103,6 +103,33 @@ const int MAX_USES_PER_INSTR = 4096;
 // function for parsing cost function names to enum values
 SPILL_COST_FUNCTION ParseSCFName(const std::string &name);
 
+// The part of an instruction's state that changes while a schedule is being
+// searched for. A DataDepGraph keeps the blocks of all of its instructions in
+// one array indexed by instruction number, so the hot state is dense and the
+// search state of a whole region can be saved or cloned with a single copy.
+struct InstSchedState {
+  // The cycle in which this instruction is currently scheduled.
+  InstCount crntSchedCycle = SCHD_UNSCHDULD;
+  // The slot in which this instruction is currently scheduled.
+  InstCount crntSchedSlot = SCHD_UNSCHDULD;
+  // TODO(ghassan): Document.
+  InstCount crntRlxdCycle = SCHD_UNSCHDULD;
+  // A lower bound on the cycle in which this instruction will be ready. This
+  // is the maximum ready cycle over the scheduled predecessors. When all
+  // predecessors have been scheduled, this value gives the cycle in which
+  // this instruction will actually become ready.
+  InstCount minRdyCycle = INVALID_VALUE;
+  // The number of unscheduled predecessors.
+  InstCount unschduldPrdcsrCnt = 0;
+  // The number of unscheduled successors.
+  InstCount unschduldScsrCnt = 0;
+  // The number of live virtual registers for which this instruction is
+  // the last use.
+  int16_t lastUseCnt = 0;
+  // Whether the instruction is currently in the Ready List.
+  bool ready = false;
+};
+
 // Forward declarations used to reduce the number of #includes.
 class DataDepGraph;
 class Register;
@@ -141,14 +168,24 @@ public:
   SchedInstruction(InstCount num, const string &name, InstType instType,
                    const string &opCode, InstCount maxInstCnt, int nodeID,
                    InstCount fileSchedCycle, InstCount fileSchedOrder,
-                   InstCount fileLB, InstCount fileUB, MachineModel *model);
+                   InstCount fileLB, InstCount fileUB,
+                   const MachineModel *model);
   // Deallocates the memory used by the instruction and destroys the object.
   ~SchedInstruction();
 
   // Prepares the instruction for scheduling. Should be called only once in
   // the lifetime of an instruction object.
-  void SetupForSchdulng(InstCount instCnt, bool isCP_FromScsr,
-                        bool isCP_FromPrdcsr);
+  void SetupForSchdulng();
+  // Refreshes the edge-derived data set up by SetupForSchdulng() after edges
+  // to or from this instruction were added or removed.
+  void UpdtNghbrInfo();
+
+  // Points the instruction's search state at storage owned by its graph. The
+  // block is set once when the instruction is created. The per-predecessor
+  // arrays must hold one entry per predecessor and are set whenever the
+  // graph is set up for scheduling.
+  void SetSchedState(InstSchedState *state);
+  void SetPrdcsrRdyCycles(InstCount *rdyCycles, InstCount *prevMinRdyCycles);
 
   // Sets the instruction's bounds to the ones specified in the input file.
   bool UseFileBounds();
@@ -362,24 +399,6 @@ public:
   // the given cycle.
   bool ProbeScsrsCrntLwrBounds(InstCount cycle);
 
-  /***************************************************************************
-   * Entry/exit-related methods                                              *
-   ***************************************************************************/
-  // TODO(max): Verify that these are indeed entry/exit-related.
-  // TODO(ghassan): Document.
-  InstCount GetRltvCrtclPath(DIRECTION dir, SchedInstruction *ref);
-
-  // Calculates the instruction's critical path distance from the given entry
-  // node assuming that the critical paths of all of its predecessors have
-  // been calculated.
-  InstCount CmputCrtclPathFrmRcrsvPrdcsr(SchedInstruction *ref);
-
-  // Calculates the instruction's critical path distance from the given exit
-  // node assuming that the critical paths of all of its successors have been
-  // calculated.
-  InstCount CmputCrtclPathFrmRcrsvScsr(SchedInstruction *ref);
-  /***************************************************************************/
-
   // Returns whether the instruction blocks a scheduling cycle, i.e. prevents
   // any other instructions from running during the same cycle.
   bool BlocksCycle() const;
@@ -391,6 +410,18 @@ public:
   void SetMustBeInBBEntry(bool val);
   void SetMustBeInBBExit(bool val);
 
+  // Returns the instruction that comes before this one in its class of
+  // interchangeable instructions, or NULL if there is none. See
+  // DataDepGraph::FindEquvlntClasses().
+  SchedInstruction *GetPrevEquvlnt() const { return prevEquvlnt_; }
+  void SetPrevEquvlnt(SchedInstruction *inst) { prevEquvlnt_ = inst; }
+  // Returns whether an instruction interchangeable with this one has to be
+  // scheduled before it. Searches only need to try interchangeable
+  // instructions in one fixed order.
+  bool IsEquvlntBlckd() const {
+    return prevEquvlnt_ != NULL && !prevEquvlnt_->IsSchduld();
+  }
+
   // Add a register definition to this instruction node.
   void AddDef(Register *reg);
   // Add a register usage to this instruction node.
@@ -425,7 +456,7 @@ public:
   void ComputeAdjustedUseCnt(SchedInstruction *inst);
 
   int16_t CmputLastUseCnt();
-  int16_t GetLastUseCnt() const { return lastUseCnt_; }
+  int16_t GetLastUseCnt() const { return schedState_->lastUseCnt; }
 
   InstType GetCrtclPathFrmRoot() const { return crtclPathFrmRoot_; }
 
@@ -487,36 +518,19 @@ protected:
   /***************************************************************************
    * Used during scheduling                                                  *
    ***************************************************************************/
-  // Whether the instruction is currently in the Ready List.
-  bool ready_;
+  // This instruction's block in the owning graph's search state.
+  InstSchedState *schedState_;
   // Each entry in this array holds the cycle in which this instruction will
   // become partially ready by satisfying the dependence of one predecessor.
   // For a predecessor that has not been scheduled the corresponding entry is
-  // set to -1.
+  // set to -1. Part of the owning graph's search state.
   InstCount *rdyCyclePerPrdcsr_;
-  // A lower bound on the cycle in which this instruction will be ready. This
-  // is the maximum entry in the "readyCyclePerPrdcsr_" array. When all
-  // predecessors have been scheduled, this value gives the cycle in which
-  // this instruction will actually become ready.
-  InstCount minRdyCycle_;
-  // The previous value of the minRdyCycle_, saved before the scheduling of a
-  // predecessor to enable backtracking if this predecessor is unscheduled.
+  // The previous value of the minimum ready cycle, saved before the
+  // scheduling of a predecessor to enable backtracking if this predecessor is
+  // unscheduled. Part of the owning graph's search state.
   InstCount *prevMinRdyCyclePerPrdcsr_;
-  // An array of predecessor latencies indexed by predecessor number.
-  InstCount *ltncyPerPrdcsr_;
-  // The number of unscheduled predecessors.
-  InstCount unschduldPrdcsrCnt_;
-  // The number of unscheduled successors.
-  InstCount unschduldScsrCnt_;
   /***************************************************************************/
 
-  // The cycle in which this instruction is currently scheduled.
-  InstCount crntSchedCycle_;
-  // The slot in which this instruction is currently scheduled.
-  InstCount crntSchedSlot_;
-  // TODO(ghassan): Document.
-  InstCount crntRlxdCycle_;
-
   // The lower bound, as read from the input file (if any).
   InstCount fileLwrBound_;
   // The upper bound, as read from the input file (if any).
@@ -536,17 +550,6 @@ protected:
   // scheduling process started.
   InstCount preFxdCycle_;
 
-  /***************************************************************************
-   * Recursive lower bounds                                                  *
-   ***************************************************************************/
-  // The critical-path distances from recursive successors to be used in
-  // recursive lower bound computations.
-  InstCount *crtclPathFrmRcrsvScsr_;
-  // The critical-path distances from recursive predecessors to be used in
-  // recursive lower bound computations.
-  InstCount *crtclPathFrmRcrsvPrdcsr_;
-  /***************************************************************************/
-
   /***************************************************************************
    * Used for BB-Spill scheduling                                            *
    ***************************************************************************/
@@ -561,9 +564,6 @@ protected:
   // The number of uses minus live-out registers. Live-out registers are uses
   // in the artifical leaf instruction.
   int16_t adjustedUseCnt_;
-  // The number of live virtual registers for which this instruction is
-  // the last use. This value changes dynamically during scheduling
-  int16_t lastUseCnt_;
   /***************************************************************************/
 
   // Whether this instruction blocks its cycle, i.e. does not allow other
@@ -575,18 +575,18 @@ protected:
   bool mustBeInBBEntry_;
   bool mustBeInBBExit_;
 
+  // The previous instruction in this instruction's class of interchangeable
+  // instructions, if any.
+  SchedInstruction *prevEquvlnt_;
+
   // TODO(ghassan): Document.
-  InstCount CmputCrtclPath_(DIRECTION dir, SchedInstruction *ref = NULL);
+  InstCount CmputCrtclPath_(DIRECTION dir);
   // Allocate the memory needed for data structures used in this node.
-  // Arguments as follows:
-  //   instCnt: The maximum number of instructions in the graph.
-  //   isCP_FromScsr: Whether this instruction will keep track of critical
-  //     paths from successors.
-  //   isCP_FromPrdcsr: Whether this instruction will keep track of critical
-  //     paths from predecessors.
-  void AllocMem_(InstCount instCnt, bool isCP_FromScsr, bool isCP_FromPrdcsr);
+  void AllocMem_();
   // Deallocates the memory used by the node's data structures.
   void DeAllocMem_();
+  // Sets the neighbor counts and builds the sorted predecessor list.
+  void SetupNghbrInfo_();
   // Sets the predecessor order numbers on the edges between this node and its
   // predecessors.
   void SetPrdcsrNums_();
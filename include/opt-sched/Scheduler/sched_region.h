@@ -17,6 +17,7 @@ Last Update:  Jan. 2020
 #include "opt-sched/Scheduler/data_dep.h"
 // For Enumerator, LengthCostEnumerator, EnumTreeNode and Pruning.
 #include "opt-sched/Scheduler/enumerator.h"
+#include <functional>
 
 namespace llvm {
 namespace opt_sched {
@@ -66,12 +67,27 @@ inline GT_POSITION &operator&=(GT_POSITION &lhs, GT_POSITION rhs) {
 
 class ListScheduler;
 
+// A snapshot of the enumerator's progress, taken each time it finds a better
+// schedule.
+struct EnumImprovement {
+  // Time since the enumeration of the region started.
+  Milliseconds elapsed;
+  InstCount length;
+  // The cost of the new best schedule relative to costLwrBound.
+  InstCount cost;
+  // The static lower bound on the cost.
+  InstCount costLwrBound;
+  InstCount spillCost;
+  InstCount spillCostLwrBound;
+};
+
 class SchedRegion {
 public:
   // TODO(max): Document.
-  SchedRegion(MachineModel *machMdl, DataDepGraph *dataDepGraph, long rgnNum,
-              int16_t sigHashSize, LB_ALG lbAlg, SchedPriorities hurstcPrirts,
-              SchedPriorities enumPrirts, bool vrfySched,
+  SchedRegion(const MachineModel *machMdl, DataDepGraph *dataDepGraph,
+              long rgnNum, int16_t sigHashSize, LB_ALG lbAlg,
+              SchedPriorities hurstcPrirts, SchedPriorities enumPrirts,
+              bool vrfySched,
               Pruning PruningStrategy, SchedulerType HeurSchedType,
               SPILL_COST_FUNCTION spillCostFunc,
               GT_POSITION GraphTransPosition);
@@ -136,6 +152,15 @@ public:
   // TODO(max): Document.
   virtual bool ChkCostFsblty(InstCount trgtLngth, EnumTreeNode *treeNode,
                              InstCount &RPCost) = 0;
+  // Checks the cost feasibility of scheduling an instruction next without
+  // scheduling it. Returns false only if ChkCostFsblty() would return false
+  // after scheduling the instruction, setting RPCost as it would. Regions that
+  // cannot tell without scheduling return true.
+  virtual bool ChkCostFsbltyBeforeSchdul(InstCount /*trgtLngth*/,
+                                         SchedInstruction * /*inst*/,
+                                         InstCount & /*RPCost*/) {
+    return true;
+  }
   // TODO(max): Document.
   virtual void SchdulInst(SchedInstruction *inst, InstCount cycleNum,
                           InstCount slotNum, bool trackCnflcts) = 0;
@@ -174,6 +199,25 @@ public:
   bool enumFoundSchedule() { return EnumFoundSchedule; }
   void setEnumFoundSchedule() { EnumFoundSchedule = true; }
 
+  // Stop enumerating once the best schedule is within absGap, or within
+  // relGap percent, of the cost lower bound. The schedule is then not reported
+  // as optimal, unless what was left to search could not have improved on it.
+  // Only applies to the weighted cost and to the first pass of the two-pass
+  // algorithm. Both default to zero, which disables the check.
+  void setOptimalityGap(InstCount absGap, float relGap) {
+    OptimalityGap_ = absGap;
+    OptimalityGapPercent_ = relGap;
+  }
+  // Whether the best schedule found so far is close enough to the lower bound
+  // to stop enumerating, without being known to be optimal.
+  bool isOptimalityGapClosed() const;
+
+  // Called each time the enumerator improves on the best schedule.
+  void setImprovementCallback(
+      std::function<void(const EnumImprovement &)> Callback) {
+    ImprovementCallback_ = std::move(Callback);
+  }
+
 private:
   // The algorithm to use for calculated lower bounds.
   LB_ALG lbAlg_;
@@ -240,11 +284,23 @@ private:
   // Whether or not we are using two-pass version of algorithm
   bool TwoPassEnabled_;
 
+  // Whether this region schedules an independent part of another region,
+  // which reports the part's results as its own.
+  bool IsIndependentPart_ = false;
+
+  // How far from the cost lower bound enumeration may stop.
+  InstCount OptimalityGap_ = 0;
+  float OptimalityGapPercent_ = 0;
+
+  std::function<void(const EnumImprovement &)> ImprovementCallback_;
+  // When the enumeration of the region started.
+  Milliseconds EnumStartTime_ = 0;
+
 protected:
   // The dependence graph of this region.
   DataDepGraph *dataDepGraph_;
   // The machine model used by this region.
-  MachineModel *machMdl_;
+  const MachineModel *machMdl_;
 
   // The schedule currently used by the enumerator
   InstSchedule *enumCrntSched_;
@@ -295,6 +351,9 @@ protected:
 
   void setCostLwrBound(InstCount CostLwrBound) { costLwrBound_ = CostLwrBound; }
 
+  // Report the new best schedule to the improvement callback.
+  void reportImprovement(InstSchedule *sched);
+
   void setSpillCostLwrBound(InstCount SpillCostLwrBound) {
     SpillCostLwrBound_ = SpillCostLwrBound;
     BestSpillCost_ = SpillCostLwrBound;
@@ -306,6 +365,12 @@ protected:
 
   Pruning GetPruningStrategy() const { return prune_; }
 
+  LB_ALG GetLwrBoundAlg() const { return lbAlg_; }
+
+  long GetRgnNum() const { return rgnNum_; }
+
+  bool GetVrfySched() const { return vrfySched_; }
+
   // TODO(max): Document.
   void UseFileBounds_();
 
@@ -358,6 +423,10 @@ protected:
   // (Chris) Get the SLIL for each set
   virtual const std::vector<int> &GetSLIL_() const = 0;
 
+  // Allocates a region of the same kind that schedules the given independent
+  // part of this region for length only.
+  virtual SchedRegion *AllocPartRgn_(DataDepGraph *partGraph) = 0;
+
   FUNC_RESULT runACO(InstSchedule *ReturnSched, InstSchedule *InitSched,
                      bool IsPostBB);
 
@@ -367,6 +436,21 @@ protected:
                                         InstSchedule *&bestSched);
   FUNC_RESULT applyGraphTransformation(GraphTrans *GT);
   void updateBoundsAfterGraphTransformations(bool BbSchedulerEnabled);
+  // Recomputes the cost of the heuristic schedule after the lower bounds
+  // changed, taking it as the best schedule if that makes it optimal.
+  void updateHeuristicCost(InstSchedule *heuristicSched, bool &isLstOptml,
+                           InstSchedule *&bestSched);
+
+  // Splits the region into parts that share no edges, schedules each part
+  // for length in a region of its own and raises the schedule length lower
+  // bound to the length of the longest part that was scheduled optimally.
+  // Returns the parts' schedules interleaved into a schedule of this region,
+  // or nullptr if the region does not split.
+  InstSchedule *scheduleIndependentParts(Milliseconds rgnTimeout,
+                                         Milliseconds lngthTimeout,
+                                         InstSchedule *heuristicSched,
+                                         bool &isLstOptml,
+                                         InstSchedule *&bestSched);
 };
 
 } // namespace opt_sched
@@ -25,6 +25,17 @@ namespace llvm {
 namespace opt_sched {
 namespace stats {
 
+// While an instance is alive, distribution and timeout stats drop their
+// samples, so that work nested in a region is not counted as a region of its
+// own. Counters keep adding up the work done.
+class PauseSampling {
+public:
+  PauseSampling();
+  ~PauseSampling();
+  PauseSampling(const PauseSampling &) = delete;
+  PauseSampling &operator=(const PauseSampling &) = delete;
+};
+
 // An abstract base class for statistical records.
 class Stat {
 public:
@@ -288,6 +299,8 @@ extern IntDistributionStat regionBuildTime;
 extern IntDistributionStat heuristicTime;
 extern IntDistributionStat AcoTime;
 extern IntDistributionStat boundComputationTime;
+extern IntDistributionStat lowerBoundComputationTime;
+extern IntDistributionStat relaxedLowerBoundTime;
 extern IntDistributionStat enumerationTime;
 extern IntDistributionStat enumerationToHeuristicTimeRatio;
 extern IntDistributionStat verificationTime;
@@ -50,8 +50,9 @@ double RandDouble(double min, double max) {
 //#endif
 
 ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph,
-                           MachineModel *machineModel, InstCount upperBound,
-                           SchedPriorities priorities, bool vrfySched,
+                           const MachineModel *machineModel,
+                           InstCount upperBound, SchedPriorities priorities,
+                           bool vrfySched,
                            bool IsPostBB)
     : ConstrainedScheduler(dataDepGraph, machineModel, upperBound) {
   VrfySched_ = vrfySched;
@@ -311,7 +312,8 @@ ACOScheduler::FindOneSchedule(InstCount TargetRPCost) {
       unsigned long heuristic;
       SchedInstruction *rInst = rdyLst_->GetNextPriorityInst(heuristic);
       while (rInst != NULL) {
-        if (ACO_SCHED_STALLS || ChkInstLglty_(rInst)) {
+        if ((ACO_SCHED_STALLS || ChkInstLglty_(rInst)) &&
+            !rInst->IsEquvlntBlckd()) {
           Choice c;
           c.inst = rInst;
           c.heuristic = (double)heuristic * maxPriorityInv + 1;
@@ -338,6 +340,8 @@ ACOScheduler::FindOneSchedule(InstCount TargetRPCost) {
 
         for (SchedInstruction *fIns = futureReady->GetFrstElmnt(); fIns;
              fIns = futureReady->GetNxtElmnt()) {
+          if (fIns->IsEquvlntBlckd())
+            continue;
           bool changed;
           unsigned long heuristic = rdyLst_->CmputKey_(fIns, false, changed);
           Choice c;
@@ -59,6 +59,7 @@ BBWithSpill::BBWithSpill(const OptSchedTarget *OST_, DataDepGraph *dataDepGraph,
   schedCostFactor_ = COST_WGHT_BASE;
   trackLiveRangeLngths_ = true;
   NeedsComputeSLIL = (spillCostFunc == SCF_SLIL);
+  SelectSpillCostPolicy_();
 
   regTypeCnt_ = OST->MM->GetRegTypeCnt();
   regFiles_ = dataDepGraph->getRegFiles();
@@ -67,7 +68,12 @@ BBWithSpill::BBWithSpill(const OptSchedTarget *OST_, DataDepGraph *dataDepGraph,
   spillCosts_ = new InstCount[dataDepGraph_->GetInstCnt()];
   peakRegPressures_ = new InstCount[regTypeCnt_];
   regPressures_.resize(regTypeCnt_);
+  prbRegPressures_.resize(regTypeCnt_);
+  prbPeakRegPressures_.resize(regTypeCnt_);
   sumOfLiveIntervalLengths_.resize(regTypeCnt_, 0);
+  slilIntrvlRegCnts_.resize(dataDepGraph_->GetInstCnt(), 0);
+  slilPsblIntrvlRegs_.resize(dataDepGraph_->GetInstCnt());
+  slilLwrBoundDeltas_.resize(dataDepGraph_->GetInstCnt(), 0);
 
   entryInstCnt_ = 0;
   exitInstCnt_ = 0;
@@ -123,6 +129,18 @@ ConstrainedScheduler *BBWithSpill::AllocHeuristicScheduler_() {
 }
 /*****************************************************************************/
 
+SchedRegion *BBWithSpill::AllocPartRgn_(DataDepGraph *partGraph) {
+  // The part's graph has no registers, so its cost is its length. Not SLIL,
+  // which takes a list schedule with no excess pressure as optimal.
+  return new BBWithSpill(OST, partGraph, GetRgnNum(), GetSigHashSize(),
+                         GetLwrBoundAlg(), GetHeuristicPriorities(),
+                         GetEnumPriorities(), GetVrfySched(),
+                         GetPruningStrategy(), false, enblStallEnum_, 0,
+                         SCF_PERP, GetHeuristicSchedulerType(),
+                         GT_POSITION::NONE);
+}
+/*****************************************************************************/
+
 void BBWithSpill::SetupPhysRegs_() {
   int physRegCnt;
   for (int i = 0; i < regTypeCnt_; i++) {
@@ -171,7 +189,7 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
   const auto RegFiles = llvm::makeMutableArrayRef(regFiles_, regTypeCnt_);
   for (RegisterFile &File : RegFiles) {
     for (Register &Reg : File) {
-      Reg.resetLiveInterval();
+      Reg.resetLiveInterval(dataDepGraph_->GetInstCnt());
     }
   }
 
@@ -198,6 +216,8 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
   // between A and B, where A defines a register that B uses. Then, the live
   // range length of A increases by 1.
   auto closureLowerBound = naiveLowerBound;
+  // Scratch vector for the intersections, allocated once for the whole DAG.
+  llvm::opt_sched::BitVector betweenBV(dataDepGraph_->GetInstCnt());
   for (int i = 0; i < dataDepGraph_->GetInstCnt(); ++i) {
     const auto &inst = dataDepGraph_->GetInstByIndx(i);
     // For each register this instruction defines, compute the intersection
@@ -210,13 +230,8 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
                              ->GetRcrsvNghbrBitVector(DIR_BKWRD);
         assert(recSuccBV->GetSize() == recPredBV->GetSize() &&
                "Successor list size doesn't match predecessor list size!");
-        for (int k = 0; k < recSuccBV->GetSize(); ++k) {
-          if (recSuccBV->GetBit(k) & recPredBV->GetBit(k)) {
-            if (def->AddToInterval(dataDepGraph_->GetInstByIndx(k))) {
-              ++closureLowerBound;
-            }
-          }
-        }
+        betweenBV.SetToAnd(*recSuccBV, *recPredBV);
+        closureLowerBound += def->AddToInterval(betweenBV);
       }
     }
   }
@@ -254,8 +269,10 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
     for (const auto &p : usedInsts) {
       Logger::Info("  Live interval of Register %d:%d (defined by Inst %d):",
                    p.second->GetType(), p.second->GetNum(), p.first->GetNum());
-      for (const auto &s : p.second->GetLiveInterval()) {
-        Logger::Info("    %d", s->GetNum());
+      const auto &interval = p.second->GetLiveInterval();
+      for (int s = interval.FindFrstOne(); s != -1;
+           s = interval.FindNxtOne(s)) {
+        Logger::Info("    %d", s);
       }
     }
 #endif
@@ -335,14 +352,63 @@ InstCount BBWithSpill::cmputSpillCostLwrBound() {
         ComputeSLILStaticLowerBound(regTypeCnt_, regFiles_, dataDepGraph_);
     dynamicSlilLowerBound_ = spillCostLwrBound;
     staticSlilLowerBound_ = spillCostLwrBound;
+    CmputSLILIntrvlInfo_();
   }
   return spillCostLwrBound;
 }
+/*****************************************************************************/
+
+void BBWithSpill::CmputSLILIntrvlInfo_() {
+  std::fill(slilIntrvlRegCnts_.begin(), slilIntrvlRegCnts_.end(), 0);
+  for (auto &Regs : slilPsblIntrvlRegs_)
+    Regs.clear();
+
+  for (int16_t i = 0; i < regTypeCnt_; i++) {
+    for (const Register &Reg : regFiles_[i]) {
+      const auto &intrvl = Reg.GetLiveInterval();
+      const auto &psblIntrvl = Reg.GetPossibleLiveInterval();
+      for (int j = intrvl.FindFrstOne(); j != -1; j = intrvl.FindNxtOne(j))
+        slilIntrvlRegCnts_[j]++;
+      for (int j = psblIntrvl.FindFrstOne(); j != -1;
+           j = psblIntrvl.FindNxtOne(j))
+        if (!intrvl.GetBit(j))
+          slilPsblIntrvlRegs_[j].push_back(&Reg);
+    }
+  }
+}
+/*****************************************************************************/
+
+// The dynamic lower bound grows by one for every register that is live after
+// the instruction is scheduled (plus every register whose last use is the
+// instruction) and whose static or possible live interval does not include
+// the instruction. A register whose static interval includes the instruction
+// is always live at this point unless this is its last use, since the
+// instruction is then its def, one of its uses or between its def and one of
+// its uses. Hence, only the possible intervals need a liveness check.
+InstCount
+BBWithSpill::CmputSLILLwrBoundDelta_(const SchedInstruction *inst) const {
+  InstCount delta = -slilIntrvlRegCnts_[inst->GetNum()];
+
+  for (int16_t i = 0; i < regTypeCnt_; i++)
+    delta += liveRegs_[i].GetOneCnt();
+
+  for (const Register *use : inst->GetUses())
+    if (!use->IsLive() &&
+        (use->IsInInterval(inst) || !use->IsInPossibleInterval(inst)))
+      delta++;
+
+  for (const Register *reg : slilPsblIntrvlRegs_[inst->GetNum()])
+    if (liveRegs_[reg->GetType()].GetBit(reg->GetNum()))
+      delta--;
+
+  return delta;
+}
 
 /*****************************************************************************/
 
 void BBWithSpill::addRecordedCost(SPILL_COST_FUNCTION Scf) {
   NeedsComputeSLIL |= (Scf == SCF_SLIL);
+  SelectSpillCostPolicy_();
   if (!llvm::is_contained(recordedCostFunctions, Scf))
     recordedCostFunctions.push_back(Scf);
 }
@@ -445,32 +511,51 @@ InstCount BBWithSpill::CmputCost_(InstSchedule *sched, COST_COMP_MODE compMode,
 /*****************************************************************************/
 
 void BBWithSpill::CmputCrntSpillCost_() {
-  switch (GetSpillCostFunc()) {
+  crntSpillCost_ =
+      CmputCrntSpillCost_(GetSpillCostFunc(), peakSpillCost_, totSpillCost_);
+}
+/*****************************************************************************/
+
+InstCount BBWithSpill::CmputCrntSpillCost_(SPILL_COST_FUNCTION SpillCF,
+                                           InstCount peakSpillCost,
+                                           InstCount totSpillCost) const {
+  switch (SpillCF) {
   case SCF_PERP:
   case SCF_PRP:
   case SCF_PEAK_PER_TYPE:
   case SCF_TARGET:
-    crntSpillCost_ = peakSpillCost_;
-    break;
+    return peakSpillCost;
   case SCF_SUM:
-    crntSpillCost_ = totSpillCost_;
-    break;
+    return totSpillCost;
   case SCF_PEAK_PLUS_AVG:
-    crntSpillCost_ =
-        peakSpillCost_ + totSpillCost_ / dataDepGraph_->GetInstCnt();
-    break;
+    return peakSpillCost + totSpillCost / dataDepGraph_->GetInstCnt();
   case SCF_SLIL:
-    crntSpillCost_ = slilSpillCost_;
-    break;
+    return slilSpillCost_;
   default:
-    crntSpillCost_ = peakSpillCost_;
-    break;
+    return peakSpillCost;
   }
 }
 /*****************************************************************************/
 
+template <SPILL_COST_FUNCTION SCF, bool TRACK_SLIL>
+struct BBWithSpill::FixedSpillCostPolicy {
+  static SPILL_COST_FUNCTION spillCostFunc(BBWithSpill *) { return SCF; }
+  static bool tracksSLIL(const BBWithSpill *) { return TRACK_SLIL; }
+};
+
+struct BBWithSpill::DynmcSpillCostPolicy {
+  static SPILL_COST_FUNCTION spillCostFunc(BBWithSpill *rgn) {
+    return rgn->GetSpillCostFunc();
+  }
+  static bool tracksSLIL(const BBWithSpill *rgn) { return rgn->needsSLIL(); }
+};
+/*****************************************************************************/
+
+template <typename Policy>
 void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
                                             bool trackCnflcts) {
+  const SPILL_COST_FUNCTION spillCostFunc = Policy::spillCostFunc(this);
+  const bool tracksSLIL = Policy::tracksSLIL(this);
   int16_t regType;
   int regNum, physRegNum;
   int liveRegs;
@@ -504,12 +589,8 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
       // (Chris): The SLIL calculation below the def and use for-loops doesn't
       // consider the last use of a register. Thus, an additional increment must
       // happen here.
-      if (needsSLIL()) {
+      if (tracksSLIL)
         sumOfLiveIntervalLengths_[regType]++;
-        if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
-          ++dynamicSlilLowerBound_;
-        }
-      }
 
       liveRegs_[regType].SetBit(regNum, false, use->GetWght());
 
@@ -576,23 +657,39 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
       peakRegPressures_[i] = liveRegs;
 
     // (Chris): Compute sum of live range lengths at this point
-    if (needsSLIL()) {
+    if (tracksSLIL)
       sumOfLiveIntervalLengths_[i] += liveRegs_[i].GetOneCnt();
-      for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-        if (liveRegs_[i].GetBit(j)) {
-          const Register *reg = regFiles_[i].GetReg(j);
-          if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-            ++dynamicSlilLowerBound_;
-          }
-        }
+  }
+
+  crntStepNum_++;
+
+  if (tracksSLIL) {
+    InstCount slilDelta = CmputSLILLwrBoundDelta_(inst);
+
+#ifdef IS_DEBUG_SLIL_DYNAMIC_LB
+    InstCount scanDelta = 0;
+    for (Register *use : inst->GetUses())
+      if (!use->IsLive() && !use->IsInInterval(inst) &&
+          !use->IsInPossibleInterval(inst))
+        scanDelta++;
+    for (int16_t i = 0; i < regTypeCnt_; i++)
+      for (int j = liveRegs_[i].FindFrstOne(); j != -1;
+           j = liveRegs_[i].FindNxtOne(j)) {
+        const Register *reg = regFiles_[i].GetReg(j);
+        if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst))
+          scanDelta++;
       }
-    }
+    assert(slilDelta == scanDelta && "Incremental SLIL lower bound mismatch!");
+#endif
+
+    slilLwrBoundDeltas_[crntStepNum_] = slilDelta;
+    dynamicSlilLowerBound_ += slilDelta;
   }
 
-  if (GetSpillCostFunc() == SCF_SLIL)
-    slilSpillCost_ = CmputCostForFunction(GetSpillCostFunc());
+  if (spillCostFunc == SCF_SLIL)
+    slilSpillCost_ = CmputCostForFunction(spillCostFunc);
   else
-    newSpillCost = CmputCostForFunction(GetSpillCostFunc());
+    newSpillCost = CmputCostForFunction(spillCostFunc);
 
 #ifdef IS_DEBUG_SLIL_CORRECT
   if (OPTSCHED_gPrintSpills) {
@@ -605,7 +702,6 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
   }
 #endif
 
-  crntStepNum_++;
   spillCosts_[crntStepNum_] = newSpillCost;
 
 #ifdef IS_DEBUG_REG_PRESSURE
@@ -616,7 +712,8 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 
   peakSpillCost_ = std::max(peakSpillCost_, newSpillCost);
 
-  CmputCrntSpillCost_();
+  crntSpillCost_ =
+      CmputCrntSpillCost_(spillCostFunc, peakSpillCost_, totSpillCost_);
 
   schduldInstCnt_++;
   if (inst->MustBeInBBEntry())
@@ -626,7 +723,9 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 }
 /*****************************************************************************/
 
+template <typename Policy>
 void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
+  const bool tracksSLIL = Policy::tracksSLIL(this);
   int16_t regType;
   int regNum, physRegNum;
   bool isLive;
@@ -637,20 +736,13 @@ void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
 #endif
 
   // (Chris): Update the SLIL for all live regs at this point.
-  if (needsSLIL()) {
+  if (tracksSLIL) {
     for (int i = 0; i < regTypeCnt_; ++i) {
-      for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-        if (liveRegs_[i].GetBit(j)) {
-          const Register *reg = regFiles_[i].GetReg(j);
-          sumOfLiveIntervalLengths_[i]--;
-          if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-            --dynamicSlilLowerBound_;
-          }
-        }
-      }
+      sumOfLiveIntervalLengths_[i] -= liveRegs_[i].GetOneCnt();
       assert(sumOfLiveIntervalLengths_[i] >= 0 &&
              "UpdateSpillInfoForUnSchdul_: SLIL negative!");
     }
+    dynamicSlilLowerBound_ -= slilLwrBoundDeltas_[crntStepNum_];
   }
 
   // Update Live regs
@@ -696,11 +788,8 @@ void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
     if (isLive == false) {
       // (Chris): Since this was the last use, the above SLIL calculation didn't
       // take this instruction into account.
-      if (needsSLIL()) {
+      if (tracksSLIL) {
         sumOfLiveIntervalLengths_[regType]--;
-        if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
-          --dynamicSlilLowerBound_;
-        }
         assert(sumOfLiveIntervalLengths_[regType] >= 0 &&
                "UpdateSpillInfoForUnSchdul_: SLIL negative!");
       }
@@ -731,6 +820,49 @@ void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
 }
 /*****************************************************************************/
 
+template <typename Policy> void BBWithSpill::UseSpillCostPolicy_() {
+  updtSpillInfoForSchdul_ = &BBWithSpill::UpdateSpillInfoForSchdul_<Policy>;
+  updtSpillInfoForUnSchdul_ = &BBWithSpill::UpdateSpillInfoForUnSchdul_<Policy>;
+}
+/*****************************************************************************/
+
+void BBWithSpill::SelectSpillCostPolicy_() {
+  // SLIL is also tracked when it is only recorded, which the fixed policies
+  // do not cover.
+  if (needsSLIL() != (GetSpillCostFunc() == SCF_SLIL)) {
+    UseSpillCostPolicy_<DynmcSpillCostPolicy>();
+    return;
+  }
+
+  switch (GetSpillCostFunc()) {
+  case SCF_PERP:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_PERP, false>>();
+    break;
+  case SCF_PRP:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_PRP, false>>();
+    break;
+  case SCF_PEAK_PER_TYPE:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_PEAK_PER_TYPE, false>>();
+    break;
+  case SCF_SUM:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_SUM, false>>();
+    break;
+  case SCF_PEAK_PLUS_AVG:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_PEAK_PLUS_AVG, false>>();
+    break;
+  case SCF_SLIL:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_SLIL, true>>();
+    break;
+  case SCF_TARGET:
+    UseSpillCostPolicy_<FixedSpillCostPolicy<SCF_TARGET, false>>();
+    break;
+  default:
+    UseSpillCostPolicy_<DynmcSpillCostPolicy>();
+    break;
+  }
+}
+/*****************************************************************************/
+
 void BBWithSpill::SchdulInst(SchedInstruction *inst, InstCount cycleNum,
                              InstCount slotNum, bool trackCnflcts) {
   crntCycleNum_ = cycleNum;
@@ -738,7 +870,7 @@ void BBWithSpill::SchdulInst(SchedInstruction *inst, InstCount cycleNum,
   if (inst == NULL)
     return;
   assert(inst != NULL);
-  UpdateSpillInfoForSchdul_(inst, trackCnflcts);
+  (this->*updtSpillInfoForSchdul_)(inst, trackCnflcts);
 }
 /*****************************************************************************/
 
@@ -756,7 +888,7 @@ void BBWithSpill::UnschdulInst(SchedInstruction *inst, InstCount cycleNum,
     return;
   }
 
-  UpdateSpillInfoForUnSchdul_(inst);
+  (this->*updtSpillInfoForUnSchdul_)(inst);
   peakSpillCost_ = trgtNode->GetPeakSpillCost();
   CmputCrntSpillCost_();
 }
@@ -791,6 +923,42 @@ Enumerator *BBWithSpill::AllocEnumrtr_(Milliseconds timeout) {
       GetEnumPriorities(), GetPruningStrategy(), SchedForRPOnly_, enblStallEnum,
       timeout, GetSpillCostFunc(), 0, NULL);
 
+  Config &schedIni = SchedulerOptions::getInstance();
+  bool isBestFrst =
+      schedIni.GetString("ENUM_SEARCH_STRATEGY", "DFS") == "BEST_FIRST";
+  // The best-first search archives partial schedules before their subtrees
+  // are searched, so its history does not carry over to the next length.
+  if (isBestFrst)
+    enumrtr_->SetBestFrstNodeBudget(
+        schedIni.GetInt("BEST_FIRST_NODE_BUDGET", 100000));
+  else
+    enumrtr_->SetHstryReuse(schedIni.GetBool("ENUM_REUSE_HISTORY", false));
+
+  std::string restartPolicy = schedIni.GetString("ENUM_RESTART_POLICY", "NONE");
+  if (restartPolicy != "NONE") {
+    // Restarts cut a depth-first search short. The best-first search would
+    // silently take precedence over them.
+    if (isBestFrst)
+      llvm::report_fatal_error(
+          "ENUM_RESTART_POLICY " + restartPolicy +
+              " requires the DFS ENUM_SEARCH_STRATEGY",
+          false);
+    RESTART_POLICY policy;
+    if (restartPolicy == "LUBY")
+      policy = RSP_LUBY;
+    else if (restartPolicy == "GEOMETRIC")
+      policy = RSP_GEOMETRIC;
+    else
+      llvm::report_fatal_error(
+          "Unrecognized option for ENUM_RESTART_POLICY setting: " +
+              restartPolicy,
+          false);
+    enumrtr_->SetRestartPolicy(
+        policy, schedIni.GetInt("ENUM_RESTART_NODES", 1000),
+        schedIni.GetFloat("ENUM_RESTART_GROWTH", 1.5),
+        schedIni.GetInt("ENUM_RESTART_SEED", 0));
+  }
+
   return enumrtr_;
 }
 /*****************************************************************************/
@@ -803,6 +971,9 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
   int iterCnt = 0;
   int costLwrBound = 0;
   bool timeout = false;
+  // The best schedule, possibly from the heuristic, may already be close
+  // enough to the lower bound.
+  bool isGapClosed = isOptimalityGapClosed();
 
   Milliseconds rgnDeadline, lngthDeadline;
   rgnDeadline =
@@ -811,7 +982,8 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
       (rgnTimeout == INVALID_VALUE) ? INVALID_VALUE : startTime + lngthTimeout;
   assert(lngthDeadline <= rgnDeadline);
 
-  for (trgtLngth = schedLwrBound_; trgtLngth <= schedUprBound_; trgtLngth++) {
+  for (trgtLngth = schedLwrBound_; trgtLngth <= schedUprBound_ && !isGapClosed;
+       trgtLngth++) {
     InitForSchdulng();
     Logger::Event("Enumerating", "target_length", trgtLngth);
 
@@ -839,6 +1011,18 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
       break;
     }
 
+    // The best schedule is still proven optimal if nothing of this length
+    // can cost less and no longer schedule can either.
+    if (isOptimalityGapClosed()) {
+      bool isLngthDone = !enumrtr_->WasGapStop() ||
+                         (!isTwoPassEnabled() &&
+                          GetBestCost() <= (trgtLngth - schedLwrBound_) *
+                                               schedCostFactor_);
+      CmputSchedUprBound_();
+      isGapClosed = !isLngthDone || trgtLngth < schedUprBound_;
+      break;
+    }
+
     enumrtr_->Reset();
     enumCrntSched_->Reset();
 
@@ -865,35 +1049,50 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
   }
   if (timeout)
     rslt = RES_TIMEOUT;
+  // Stopping at the optimality gap with part of the search space left leaves
+  // optimality unproven, like a timeout.
+  if (isGapClosed) {
+    Logger::Info("Best cost %d is within the optimality gap. Stopping "
+                 "enumeration.",
+                 GetBestCost());
+    rslt = RES_TIMEOUT;
+  }
 
   return rslt;
 }
 /*****************************************************************************/
 
 InstCount BBWithSpill::CmputCostForFunction(SPILL_COST_FUNCTION SpillCF) {
+  return CmputCostForFunction(SpillCF, regPressures_, peakRegPressures_);
+}
+
+InstCount
+BBWithSpill::CmputCostForFunction(SPILL_COST_FUNCTION SpillCF,
+                                  const SmallVectorImpl<unsigned> &RegPressures,
+                                  const InstCount *PeakRegPressures) {
   // return the requested cost
   switch (SpillCF) {
   case SCF_TARGET:
-    return OST->getCost(regPressures_);
+    return OST->getCost(RegPressures);
 
   case SCF_SLIL:
     return std::accumulate(sumOfLiveIntervalLengths_.begin(),
                            sumOfLiveIntervalLengths_.end(), 0);
 
   case SCF_PRP:
-    return std::accumulate(regPressures_.begin(), regPressures_.end(), 0);
+    return std::accumulate(RegPressures.begin(), RegPressures.end(), 0);
 
   case SCF_PEAK_PER_TYPE: {
     InstCount SC = 0;
     for (int i = 0; i < regTypeCnt_; i++)
-      SC += std::max(0, peakRegPressures_[i] - machMdl_->GetPhysRegCnt(i));
+      SC += std::max(0, PeakRegPressures[i] - machMdl_->GetPhysRegCnt(i));
     return SC;
   }
   default: {
     // Default is PERP (Some SCF like SUM rely on PERP being the default here)
     int i = 0;
     InstCount SC = 0;
-    std::for_each(regPressures_.begin(), regPressures_.end(),
+    std::for_each(RegPressures.begin(), RegPressures.end(),
                   [&](InstCount RP) {
                     SC += std::max(0, RP - machMdl_->GetPhysRegCnt(i++));
                   });
@@ -932,6 +1131,7 @@ void BBWithSpill::UpdtOptmlSchedFrstPss(InstSchedule *crntSched,
     SetBestSchedLength(crntSched->GetCrntLngth());
     enumBestSched_->Copy(crntSched);
     bestSched_ = enumBestSched_;
+    reportImprovement(crntSched);
   }
 }
 
@@ -946,6 +1146,7 @@ void BBWithSpill::UpdtOptmlSchedScndPss(InstSchedule *crntSched,
     SetBestSchedLength(crntSched->GetCrntLngth());
     enumBestSched_->Copy(crntSched);
     bestSched_ = enumBestSched_;
+    reportImprovement(crntSched);
 
     if (!enumFoundSchedule())
       setEnumFoundSchedule();
@@ -966,6 +1167,7 @@ void BBWithSpill::UpdtOptmlSchedWghtd(InstSchedule *crntSched,
     SetBestSchedLength(crntSched->GetCrntLngth());
     enumBestSched_->Copy(crntSched);
     bestSched_ = enumBestSched_;
+    reportImprovement(crntSched);
   }
 }
 
@@ -979,6 +1181,7 @@ void BBWithSpill::SetupForSchdulng_() {
   }
 
   SetupPhysRegs_();
+  SetupRPDeltaTable_();
 
   entryInstCnt_ = dataDepGraph_->GetEntryInstCnt();
   exitInstCnt_ = dataDepGraph_->GetExitInstCnt();
@@ -1085,6 +1288,78 @@ bool BBWithSpill::ChkCostFsbltyWghtd(InstCount trgtLngth, EnumTreeNode *node,
 
 /*****************************************************************************/
 
+void BBWithSpill::SetupRPDeltaTable_() {
+  InstCount instCnt = dataDepGraph_->GetInstCnt();
+
+  rpDeltaDefWghts_.assign(instCnt * regTypeCnt_, 0);
+  rpDeltaUses_.clear();
+  rpDeltaUseBgns_.resize(instCnt + 1);
+
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph_->GetInstByIndx(i);
+    assert(inst->GetNum() == i);
+
+    for (const Register *def : inst->GetDefs())
+      rpDeltaDefWghts_[i * regTypeCnt_ + def->GetType()] += def->GetWght();
+
+    rpDeltaUseBgns_[i] = rpDeltaUses_.size();
+    for (const Register *use : inst->GetUses())
+      rpDeltaUses_.push_back({use, use->GetType(), use->GetWght()});
+  }
+  rpDeltaUseBgns_[instCnt] = rpDeltaUses_.size();
+}
+/*****************************************************************************/
+
+// Mirrors UpdateSpillInfoForSchdul_() and ChkCostFsblty() using the delta
+// table. This saves scheduling and unscheduling the instruction when it turns
+// out to be cost infeasible.
+bool BBWithSpill::ChkCostFsbltyBeforeSchdul(InstCount trgtLngth,
+                                            SchedInstruction *inst,
+                                            InstCount &RPCost) {
+  // The SLIL feasibility test uses the dynamic SLIL lower bound, which needs
+  // the updated live registers.
+  if (GetSpillCostFunc() == SCF_SLIL)
+    return true;
+
+  InstCount instNum = inst->GetNum();
+  const int *defWghts = &rpDeltaDefWghts_[instNum * regTypeCnt_];
+  for (int16_t i = 0; i < regTypeCnt_; i++)
+    prbRegPressures_[i] = liveRegs_[i].GetWghtedCnt() + defWghts[i];
+
+  for (int j = rpDeltaUseBgns_[instNum]; j < rpDeltaUseBgns_[instNum + 1];
+       j++) {
+    const RPDeltaUse &use = rpDeltaUses_[j];
+    if (use.reg->GetCrntUseCnt() + 1 == use.reg->GetUseCnt())
+      prbRegPressures_[use.type] -= use.wght;
+  }
+
+  for (int16_t i = 0; i < regTypeCnt_; i++)
+    prbPeakRegPressures_[i] =
+        std::max(peakRegPressures_[i], (InstCount)prbRegPressures_[i]);
+
+  InstCount newSpillCost = CmputCostForFunction(
+      GetSpillCostFunc(), prbRegPressures_, prbPeakRegPressures_.data());
+  InstCount spillCost = CmputCrntSpillCost_(
+      GetSpillCostFunc(), std::max(peakSpillCost_, newSpillCost),
+      totSpillCost_ + newSpillCost);
+  InstCount crntCost =
+      spillCost * SCW_ + trgtLngth * schedCostFactor_ - GetCostLwrBound();
+
+  bool fsbl;
+  if (isTwoPassEnabled()) {
+    if (!IsSecondPass())
+      fsbl = spillCost < getBestSpillCost();
+    else
+      fsbl = spillCost <= getSpillCostConstraint();
+    if (!fsbl)
+      RPCost = spillCost;
+  } else
+    fsbl = crntCost < GetBestCost();
+
+  return fsbl;
+}
+/*****************************************************************************/
+
 void BBWithSpill::SetSttcLwrBounds(EnumTreeNode *) {
   // Nothing.
 }
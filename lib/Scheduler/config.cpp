@@ -1,7 +1,9 @@
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/logger.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 using namespace llvm::opt_sched;
@@ -147,7 +149,47 @@ list<float> Config::GetFloatList(const string &name) const {
   return Split<float>(GetString(name, ""));
 }
 
+std::shared_ptr<const Config>
+llvm::opt_sched::loadCachedConfig(const string &filepath) {
+  struct CachedConfig {
+    llvm::sys::TimePoint<> modTime;
+    uint64_t size;
+    std::shared_ptr<const Config> config;
+  };
+  static std::mutex cacheMutex;
+  static std::map<string, CachedConfig> cache;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(filepath, status)) {
+    // Nothing to tell a later version of the file apart by. Load whatever
+    // can be read, which is nothing if the file does not exist.
+    std::shared_ptr<Config> config = std::make_shared<Config>();
+    config->Load(filepath);
+    return config;
+  }
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  CachedConfig &cached = cache[filepath];
+  if (!cached.config || cached.modTime != status.getLastModificationTime() ||
+      cached.size != status.getSize()) {
+    std::shared_ptr<Config> config = std::make_shared<Config>();
+    config->Load(filepath);
+    cached.modTime = status.getLastModificationTime();
+    cached.size = status.getSize();
+    cached.config = config;
+  }
+  return cached.config;
+}
+
 SchedulerOptions &SchedulerOptions::getInstance() {
   static SchedulerOptions instance; // The instance will always be destroyed.
   return instance;
 }
+
+void SchedulerOptions::LoadIfChanged(const string &filepath) {
+  std::shared_ptr<const Config> config = loadCachedConfig(filepath);
+  if (config == LoadedConfig)
+    return;
+  static_cast<Config &>(*this) = *config;
+  LoadedConfig = config;
+}
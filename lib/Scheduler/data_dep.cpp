@@ -2,6 +2,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <map>
 
 #include "opt-sched/Scheduler/data_dep.h"
 #include "opt-sched/Scheduler/graph_trans.h"
@@ -36,7 +38,7 @@ static const char *GetDependenceTypeName(DependenceType depType) {
   llvm_unreachable("Unknown dependence type!");
 }
 
-DataDepStruct::DataDepStruct(MachineModel *machMdl) {
+DataDepStruct::DataDepStruct(const MachineModel *machMdl) {
   machMdl_ = machMdl;
   issuTypeCnt_ = (int16_t)machMdl->GetIssueTypeCnt();
   instCntPerIssuType_ = new InstCount[issuTypeCnt_];
@@ -144,7 +146,8 @@ InstCount DataDepStruct::CmputAbslutUprBound_() {
   return schedUprBound_;
 }
 
-DataDepGraph::DataDepGraph(MachineModel *machMdl, LATENCY_PRECISION ltncyPrcsn)
+DataDepGraph::DataDepGraph(const MachineModel *machMdl,
+                           LATENCY_PRECISION ltncyPrcsn)
     : DataDepStruct(machMdl) {
   int i;
 
@@ -178,6 +181,7 @@ DataDepGraph::DataDepGraph(MachineModel *machMdl, LATENCY_PRECISION ltncyPrcsn)
 
   dagFileFormat_ = DFF_BB;
   wasSetupForSchduling_ = false;
+  wasTrnstvClsrCmputd_ = false;
   strcpy(dagID_, "unknown");
 
   instTypeCnt_ = (int16_t)machMdl->GetInstTypeCnt();
@@ -221,7 +225,7 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
 
   for (i = 0; i < instCnt_; i++) {
     SchedInstruction *inst = insts_[i];
-    inst->SetupForSchdulng(instCnt_, cmputTrnstvClsr, cmputTrnstvClsr);
+    inst->SetupForSchdulng();
     InstType instType = inst->GetInstType();
     IssueType issuType = machMdl_->GetIssueType(instType);
     assert(issuType < issuTypeCnt_);
@@ -237,6 +241,10 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
 
   //  Logger::Info("Max use count = %d", maxUseCnt_);
 
+  // The edge orders were just set above, so the edge lists can be packed.
+  BuildEdgeArrays();
+  SetupPrdcsrRdyCycles_();
+
   // Do a depth-first search leading to a topological sort
   if (!dpthFrstSrchDone_) {
     DepthFirstSearch();
@@ -246,27 +254,41 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
   bkwrdLwrBounds_ = new InstCount[instCnt_];
 
   CmputCrtclPaths_();
+  rltvCrtclPathsBuilt_ = false;
+  sprirInstsBuilt_ = false;
 
   if (cmputTrnstvClsr) {
     if (FindRcrsvNghbrs(DIR_FRWRD) == RES_ERROR)
       return RES_ERROR;
     if (FindRcrsvNghbrs(DIR_BKWRD) == RES_ERROR)
       return RES_ERROR;
-    CmputRltvCrtclPaths_(DIR_FRWRD);
-    CmputRltvCrtclPaths_(DIR_BKWRD);
   }
 
   CmputAbslutUprBound_();
   CmputBasicLwrBounds_();
   wasSetupForSchduling_ = true;
+  wasTrnstvClsrCmputd_ = cmputTrnstvClsr;
+  chngdEdges_.clear();
   return RES_SUCCESS;
 }
 
 FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
+  // The recursive neighbors are only valid if the transitive closure was
+  // computed last time. Otherwise, they are rebuilt from scratch.
+  bool isIncrmntl = cmputTrnstvClsr && wasTrnstvClsrCmputd_;
+
+  if (isIncrmntl) {
+    for (auto &edge : chngdEdges_) {
+      edge.first->UpdtNghbrInfo();
+      edge.second->UpdtNghbrInfo();
+    }
+  }
+
   InstCount i;
   for (i = 0; i < instCnt_; i++) {
     SchedInstruction *inst = insts_[i];
-    inst->SetupForSchdulng(instCnt_, cmputTrnstvClsr, cmputTrnstvClsr);
+    if (!isIncrmntl)
+      inst->SetupForSchdulng();
     InstType instType = inst->GetInstType();
     IssueType issuType = machMdl_->GetIssueType(instType);
     assert(issuType < issuTypeCnt_);
@@ -276,6 +298,10 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
     inst->SetMustBeInBBExit(false);
   }
 
+  // Graph transformations may have changed the edges since the last setup.
+  BuildEdgeArrays();
+  SetupPrdcsrRdyCycles_();
+
   // Do a depth-first search leading to a topological sort
   DepthFirstSearch();
 
@@ -286,22 +312,96 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
   bkwrdLwrBounds_ = new InstCount[instCnt_];
 
   CmputCrtclPaths_();
+  rltvCrtclPathsBuilt_ = false;
+  sprirInstsBuilt_ = false;
 
-  if (cmputTrnstvClsr) {
+  if (isIncrmntl) {
+    if (UpdtRcrsvInfo_(DIR_FRWRD) == RES_ERROR)
+      return RES_ERROR;
+    if (UpdtRcrsvInfo_(DIR_BKWRD) == RES_ERROR)
+      return RES_ERROR;
+  } else if (cmputTrnstvClsr) {
     if (FindRcrsvNghbrs(DIR_FRWRD) == RES_ERROR)
       return RES_ERROR;
     if (FindRcrsvNghbrs(DIR_BKWRD) == RES_ERROR)
       return RES_ERROR;
-    CmputRltvCrtclPaths_(DIR_FRWRD);
-    CmputRltvCrtclPaths_(DIR_BKWRD);
   }
 
+  wasTrnstvClsrCmputd_ = cmputTrnstvClsr;
+  chngdEdges_.clear();
+
   CmputAbslutUprBound_();
   CmputBasicLwrBounds_();
 
   return RES_SUCCESS;
 }
 
+FUNC_RESULT DataDepGraph::CmputTrnstvClsr() {
+  assert(wasSetupForSchduling_);
+
+  if (wasTrnstvClsrCmputd_)
+    return RES_SUCCESS;
+
+  if (FindRcrsvNghbrs(DIR_FRWRD) == RES_ERROR)
+    return RES_ERROR;
+  if (FindRcrsvNghbrs(DIR_BKWRD) == RES_ERROR)
+    return RES_ERROR;
+
+  wasTrnstvClsrCmputd_ = true;
+  return RES_SUCCESS;
+}
+
+void DataDepGraph::NoteEdgeChange(SchedInstruction *frmNode,
+                                  SchedInstruction *toNode) {
+  rltvCrtclPathsBuilt_ = false;
+  sprirInstsBuilt_ = false;
+  if (wasSetupForSchduling_)
+    chngdEdges_.push_back(std::make_pair(frmNode, toNode));
+}
+
+FUNC_RESULT DataDepGraph::UpdtRcrsvInfo_(DIRECTION dir) {
+  // A node's recursive successors can only change if one of the changed
+  // edges starts at the node or at one of its recursive successors (in the
+  // current graph, since removing an edge never makes a node reach anything
+  // new). Backward, the same holds for the nodes reached from the edges'
+  // targets. Collect these nodes by walking the graph against the given
+  // direction.
+  BitVector isAffctd(instCnt_);
+  std::vector<SchedInstruction *> affctdInsts;
+
+  for (auto &edge : chngdEdges_) {
+    SchedInstruction *inst = dir == DIR_FRWRD ? edge.first : edge.second;
+    if (!isAffctd.GetBit(inst->GetNum())) {
+      isAffctd.SetBit(inst->GetNum());
+      affctdInsts.push_back(inst);
+    }
+  }
+
+  for (size_t j = 0; j < affctdInsts.size(); j++) {
+    const GraphEdgeSpan &nghbrs = affctdInsts[j]->GetNghbrSpan(dir);
+    for (UDT_GEDGES k = 0; k < nghbrs.cnt; k++) {
+      SchedInstruction *nghbr = (SchedInstruction *)nghbrs.nodes[k];
+      if (!isAffctd.GetBit(nghbr->GetNum())) {
+        isAffctd.SetBit(nghbr->GetNum());
+        affctdInsts.push_back(nghbr);
+      }
+    }
+  }
+
+  // Stale bits left from before the change could make the searches below
+  // report a false cycle.
+  for (SchedInstruction *ref : affctdInsts)
+    ref->AllocRcrsvInfo(dir, instCnt_);
+
+  // Redo the same searches FindRcrsvNghbrs() would, so that the lists keep
+  // the order a full update gives them.
+  for (SchedInstruction *ref : affctdInsts)
+    if (FindRcrsvNghbrs(ref, dir) == RES_ERROR)
+      return RES_ERROR;
+
+  return RES_SUCCESS;
+}
+
 void DataDepGraph::CmputBasicLwrBounds_() {
   for (InstCount i = 0; i < instCnt_; i++) {
     SchedInstruction *inst = GetInstByIndx(i);
@@ -489,6 +589,20 @@ FUNC_RESULT DataDepGraph::Finish_() {
   return RES_SUCCESS;
 }
 
+void DataDepGraph::SetupPrdcsrRdyCycles_() {
+  UDT_GEDGES prdcsrTot = (UDT_GEDGES)prdcsrArrays_.nodes.size();
+  schedState_.prdcsrRdyCycles.assign(prdcsrTot, INVALID_VALUE);
+  schedState_.prevMinRdyCycles.assign(prdcsrTot, INVALID_VALUE);
+
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = insts_[i];
+    // The instruction's slice starts where its CSR predecessor span does.
+    size_t bgn = inst->GetPrdcsrSpan().nodes - prdcsrArrays_.nodes.data();
+    inst->SetPrdcsrRdyCycles(schedState_.prdcsrRdyCycles.data() + bgn,
+                             schedState_.prevMinRdyCycles.data() + bgn);
+  }
+}
+
 void DataDepGraph::AllocArrays_(InstCount instCnt) {
   InstCount i;
 
@@ -496,6 +610,7 @@ void DataDepGraph::AllocArrays_(InstCount instCnt) {
   nodeCnt_ = instCnt;
   insts_ = new SchedInstruction *[instCnt_];
   nodes_ = (GraphNode **)insts_;
+  schedState_.insts.assign(instCnt_, InstSchedState());
 
   for (i = 0; i < instCnt_; i++) {
     insts_[i] = NULL;
@@ -518,7 +633,7 @@ FUNC_RESULT DataDepGraph::ParseF2Blocks_(SpecsBuffer *buf) {
 }
 
 FUNC_RESULT DataDepGraph::ParseF2Nodes_(SpecsBuffer *buf,
-                                        MachineModel *machMdl) {
+                                        const MachineModel *machMdl) {
   NXTLINE_TYPE nxtLine;
   InstCount i;
   InstCount nodeNum;
@@ -732,7 +847,7 @@ InstCount DataDepGraph::GetAdjustedFileSchedCycle(InstCount instNum) {
 }
 
 FUNC_RESULT DataDepGraph::ParseF2Edges_(SpecsBuffer *buf,
-                                        MachineModel *machMdl) {
+                                        const MachineModel *machMdl) {
   int pieceCnt;
   char *strngs[INBUF_MAX_PIECES_PERLINE];
   int lngths[INBUF_MAX_PIECES_PERLINE];
@@ -840,6 +955,7 @@ SchedInstruction *DataDepGraph::CreateNode_(
     maxFileSchedOrder_ = fileSchedOrder;
 
   insts_[instNum] = newInstPtr;
+  newInstPtr->SetSchedState(&schedState_.insts[instNum]);
 
   return newInstPtr;
 }
@@ -884,6 +1000,7 @@ GraphEdge *DataDepGraph::CreateEdge(SchedInstruction *frmNode,
     if (crntLtncy < ltncy) {
       edge->label = ltncy;
       edge->from->UpdtMaxEdgLbl(ltncy);
+      NoteEdgeChange(frmNode, toNode);
     }
 
     return nullptr;
@@ -893,6 +1010,7 @@ GraphEdge *DataDepGraph::CreateEdge(SchedInstruction *frmNode,
 
   frmNode->AddScsr(newEdg);
   toNode->AddPrdcsr(newEdg);
+  NoteEdgeChange(frmNode, toNode);
 
   if (ltncy > maxLtncy_) {
     maxLtncy_ = ltncy;
@@ -936,6 +1054,7 @@ void DataDepGraph::CreateEdge_(InstCount frmNodeNum, InstCount toNodeNum,
 
     frmNode->AddScsr(edge);
     toNode->AddPrdcsr(edge);
+    NoteEdgeChange(insts_[frmNodeNum], insts_[toNodeNum]);
   } else {
     if (ltncy > edge->label) {
 #ifdef IS_DEBUG_DAG
@@ -944,6 +1063,7 @@ void DataDepGraph::CreateEdge_(InstCount frmNodeNum, InstCount toNodeNum,
 #endif
       edge->label = ltncy;
       edge->from->UpdtMaxEdgLbl(ltncy);
+      NoteEdgeChange(insts_[frmNodeNum], insts_[toNodeNum]);
     }
   }
 
@@ -1126,63 +1246,79 @@ bool DataDepGraph::UseFileBounds() {
   return match;
 }
 
-void DataDepGraph::CmputRltvCrtclPaths_(DIRECTION dir) {
-  InstCount i;
+// Fills paths[i * instCnt + j] with the longest path from instruction i to
+// instruction j, or with the lowest value of T if there is none. When a node
+// is visited in reverse topological order, the rows of all its successors
+// are final, so its row is their max-plus combination.
+template <typename T>
+static void fillRltvCrtclPaths(DataDepGraph *graph, std::vector<T> &paths) {
+  const T noPath = std::numeric_limits<T>::lowest();
+  const size_t instCnt = graph->GetInstCnt();
 
-  if (dir == DIR_FRWRD) {
-    for (i = 0; i < instCnt_; i++) {
-      CmputCrtclPathsFrmRcrsvPrdcsr_(insts_[i]);
-    }
-  } else {
-    assert(dir == DIR_BKWRD);
+  paths.assign(instCnt * instCnt, noPath);
+
+  for (size_t ordr = instCnt; ordr-- > 0;) {
+    SchedInstruction *inst = graph->GetInstByTplgclOrdr(ordr);
+    T *row = &paths[inst->GetNum() * instCnt];
+    row[inst->GetNum()] = 0;
+
+    const GraphEdgeSpan &scsrs = inst->GetScsrSpan();
+    for (UDT_GEDGES e = 0; e < scsrs.cnt; e++) {
+      const T ltncy = scsrs.lbls[e];
+      const T *scsrRow = &paths[scsrs.nodes[e]->GetNum() * instCnt];
 
-    for (i = 0; i < instCnt_; i++) {
-      CmputCrtclPathsFrmRcrsvScsr_(insts_[i]);
+      // Branch-free so that it vectorizes. Missing paths stay at noPath
+      // instead of creeping up by the latency.
+      for (size_t j = 0; j < instCnt; j++)
+        row[j] = std::max<T>(row[j],
+                             scsrRow[j] < 0 ? noPath : scsrRow[j] + ltncy);
     }
   }
 }
 
-void DataDepGraph::CmputCrtclPathsFrmRcrsvPrdcsr_(SchedInstruction *ref) {
-  LinkedList<GraphNode> *rcrsvScsrLst = ref->GetRcrsvNghbrLst(DIR_FRWRD);
-  SchedInstruction *inst = GetLeafInst();
-  GraphNode *node;
+void DataDepGraph::BuildRltvCrtclPaths_() {
+  // The topological order and the edge arrays are only current right after
+  // a setup.
+  assert(dpthFrstSrchDone_ && chngdEdges_.empty());
 
-  assert(rcrsvScsrLst != NULL);
-
-  // Visit the nodes in reverse topological order
-  for (node = rcrsvScsrLst->GetLastElmnt(); node != NULL;
-       node = rcrsvScsrLst->GetPrevElmnt()) {
-    inst = (SchedInstruction *)node;
-    inst->CmputCrtclPathFrmRcrsvPrdcsr(ref);
+  // No path is longer than the critical path through the whole graph.
+  if (GetRootInst()->GetCrtclPath(DIR_BKWRD) <=
+      std::numeric_limits<int16_t>::max()) {
+    rltvCrtclPaths32_.clear();
+    fillRltvCrtclPaths(this, rltvCrtclPaths16_);
+  } else {
+    rltvCrtclPaths16_.clear();
+    fillRltvCrtclPaths(this, rltvCrtclPaths32_);
   }
 
-  assert(inst == GetLeafInst()); // the last instruction must be the leaf
-
-  // The forward CP of the root relative to this entry must be
-  // equal to the backward CP of the entry relative to the leaf
-  assert(inst->CmputCrtclPathFrmRcrsvPrdcsr(ref) ==
-         ref->GetCrtclPath(DIR_BKWRD));
+  rltvCrtclPathsBuilt_ = true;
 }
 
-void DataDepGraph::CmputCrtclPathsFrmRcrsvScsr_(SchedInstruction *ref) {
-  LinkedList<GraphNode> *rcrsvPrdcsrLst = ref->GetRcrsvNghbrLst(DIR_BKWRD);
-  SchedInstruction *inst = GetRootInst();
-  GraphNode *node;
+void DataDepGraph::BuildSprirInsts_() {
+  assert(dpthFrstSrchDone_ && chngdEdges_.empty());
+  sprirInsts_.assign(instCnt_, BitVector(instCnt_));
 
-  assert(rcrsvPrdcsrLst != NULL);
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = insts_[i];
+    const GraphEdgeSpan &scsrs = inst->GetScsrSpan();
+    if (scsrs.cnt == 0)
+      continue;
 
-  // Visit the nodes in reverse topological order
-  for (node = rcrsvPrdcsrLst->GetLastElmnt(); node != NULL;
-       node = rcrsvPrdcsrLst->GetPrevElmnt()) {
-    inst = (SchedInstruction *)node;
-    inst->CmputCrtclPathFrmRcrsvScsr(ref);
+    // A superior instruction is a predecessor of each of inst's successors,
+    // so the predecessors of any one of them are the only candidates.
+    const GraphEdgeSpan &cnddts = scsrs.nodes[0]->GetPrdcsrSpan();
+    for (UDT_GEDGES e = 0; e < cnddts.cnt; e++) {
+      SchedInstruction *cnddt =
+          static_cast<SchedInstruction *>(cnddts.nodes[e]);
+      if (cnddt != inst && cnddt->GetIssueType() == inst->GetIssueType() &&
+          cnddt->BlocksCycle() == inst->BlocksCycle() &&
+          cnddt->IsPipelined() == inst->IsPipelined() &&
+          inst->IsScsrDmntd(cnddt))
+        sprirInsts_[i].SetBit(cnddt->GetNum());
+    }
   }
 
-  assert(inst == GetRootInst()); // the last instruction must be the root
-
-  // The backward CP of the root relative to this exit must be
-  // equal to the forward CP of th exit relative to the root
-  assert(inst->CmputCrtclPathFrmRcrsvScsr(ref) == ref->GetCrtclPath(DIR_FRWRD));
+  sprirInstsBuilt_ = true;
 }
 
 void DataDepGraph::PrintLwrBounds(DIRECTION dir, std::ostream &out,
@@ -1221,6 +1357,128 @@ void DataDepGraph::CountDeps(InstCount &totDepCnt, InstCount &crossDepCnt) {
   }
 }
 
+InstCount DataDepGraph::FindIndpndntCmpnnts(std::vector<InstCount> &cmpnnts) {
+  SchedInstruction *root = GetRootInst();
+  SchedInstruction *leaf = GetLeafInst();
+  std::vector<SchedInstruction *> stack;
+  InstCount cmpnntCnt = 0;
+
+  cmpnnts.assign(instCnt_, INVALID_VALUE);
+
+  for (InstCount i = 0; i < instCnt_; i++) {
+    if (insts_[i] == root || insts_[i] == leaf ||
+        cmpnnts[i] != INVALID_VALUE)
+      continue;
+
+    cmpnnts[i] = cmpnntCnt;
+    stack.push_back(insts_[i]);
+
+    while (!stack.empty()) {
+      SchedInstruction *inst = stack.back();
+      stack.pop_back();
+
+      for (DIRECTION dir : {DIR_FRWRD, DIR_BKWRD}) {
+        const LinkedList<GraphEdge> &edges = dir == DIR_FRWRD
+                                                 ? inst->GetSuccessors()
+                                                 : inst->GetPredecessors();
+        for (const GraphEdge &edge : edges) {
+          GraphNode *nghbr = edge.GetOtherNode(inst);
+          if (nghbr == root || nghbr == leaf ||
+              cmpnnts[nghbr->GetNum()] != INVALID_VALUE)
+            continue;
+
+          cmpnnts[nghbr->GetNum()] = cmpnntCnt;
+          stack.push_back(static_cast<SchedInstruction *>(nghbr));
+        }
+      }
+    }
+
+    cmpnntCnt++;
+  }
+
+  return cmpnntCnt;
+}
+
+InstCount DataDepGraph::FindEquvlntClasses() {
+  SchedInstruction *root = GetRootInst();
+  SchedInstruction *leaf = GetLeafInst();
+  // The last instruction seen so far with a given key.
+  std::map<std::vector<int>, SchedInstruction *> lastInClass;
+  std::vector<int> key;
+  std::vector<std::vector<int>> itemKeys;
+  InstCount linkCnt = 0;
+
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = insts_[i];
+    inst->SetPrevEquvlnt(NULL);
+    if (inst == root || inst == leaf ||
+        inst->GetPreFxdCycle() != INVALID_VALUE)
+      continue;
+
+    key.clear();
+    key.push_back(inst->GetInstType());
+    key.push_back(inst->MustBeInBBEntry());
+    key.push_back(inst->MustBeInBBExit());
+
+    for (DIRECTION dir : {DIR_FRWRD, DIR_BKWRD}) {
+      const LinkedList<GraphEdge> &edges = dir == DIR_FRWRD
+                                               ? inst->GetSuccessors()
+                                               : inst->GetPredecessors();
+      itemKeys.clear();
+      for (const GraphEdge &edge : edges)
+        itemKeys.push_back({edge.GetOtherNode(inst)->GetNum(), edge.label,
+                            edge.label2, edge.IsArtificial});
+      std::sort(itemKeys.begin(), itemKeys.end());
+      key.push_back(itemKeys.size());
+      for (const std::vector<int> &edgeKey : itemKeys)
+        key.insert(key.end(), edgeKey.begin(), edgeKey.end());
+    }
+
+    // The same registers have to be used.
+    itemKeys.clear();
+    for (const Register *use : inst->GetUses())
+      itemKeys.push_back({use->GetType(), use->GetNum()});
+    std::sort(itemKeys.begin(), itemKeys.end());
+    key.push_back(itemKeys.size());
+    for (const std::vector<int> &useKey : itemKeys)
+      key.insert(key.end(), useKey.begin(), useKey.end());
+
+    // The defined registers only have to look alike, but an instruction whose
+    // registers have other definitions is left alone.
+    bool hasSharedDef = false;
+    itemKeys.clear();
+    for (const Register *def : inst->GetDefs()) {
+      if (def->GetDefCnt() != 1 || def->IsPhysical() || def->IsLiveIn()) {
+        hasSharedDef = true;
+        break;
+      }
+      std::vector<int> defKey = {def->GetType(), def->GetWght(),
+                                 def->IsLiveOut()};
+      for (const SchedInstruction *user : def->GetUseList())
+        defKey.push_back(user->GetNum());
+      std::sort(defKey.begin() + 3, defKey.end());
+      itemKeys.push_back(std::move(defKey));
+    }
+    if (hasSharedDef)
+      continue;
+    std::sort(itemKeys.begin(), itemKeys.end());
+    key.push_back(itemKeys.size());
+    for (const std::vector<int> &defKey : itemKeys) {
+      key.push_back(defKey.size());
+      key.insert(key.end(), defKey.begin(), defKey.end());
+    }
+
+    SchedInstruction *&last = lastInClass[key];
+    if (last != NULL) {
+      inst->SetPrevEquvlnt(last);
+      linkCnt++;
+    }
+    last = inst;
+  }
+
+  return linkCnt;
+}
+
 /*void DataDepGraph::CountDefs(RegisterFile regFiles[]) {
   int intDefCnt = 0, fpDefCnt = 0;
 
@@ -1301,14 +1559,71 @@ void DataDepGraph::PrintEdgeCntPerLtncyInfo() {
   Logger::Info("Total edge count: %d", totEdgeCnt);
 }
 
-InstCount DataDepGraph::GetRltvCrtclPath(SchedInstruction *ref,
-                                         SchedInstruction *inst,
-                                         DIRECTION dir) {
-  return inst->GetRltvCrtclPath(dir, ref);
+DataDepCmpnntGraph::DataDepCmpnntGraph(DataDepGraph *fullGraph,
+                                       const MachineModel *machMdl,
+                                       const std::vector<InstCount> &instNums,
+                                       int cmpnntNum)
+    : DataDepGraph(machMdl, LTP_PRECISE), fullInstNums_(instNums) {
+  SchedInstruction *fullRoot = fullGraph->GetRootInst();
+  SchedInstruction *fullLeaf = fullGraph->GetLeafInst();
+  const InstCount rootNum = instNums.size();
+  const InstCount leafNum = rootNum + 1;
+  // The number in the copy of each instruction of the full graph.
+  std::vector<InstCount> cmpnntInstNums(fullGraph->GetInstCnt(),
+                                        INVALID_VALUE);
+
+  // Cut the full graph's ID short enough to leave room for ".<number>".
+  const int maxFullIDLen = MAX_NAMESIZE - 13;
+  snprintf(dagID_, MAX_NAMESIZE, "%.*s.%d", maxFullIDLen,
+           fullGraph->GetDagID(), cmpnntNum);
+  weight_ = fullGraph->GetWeight();
+  AllocArrays_(rootNum + 2);
+  fullInstNums_.push_back(fullRoot->GetNum());
+  fullInstNums_.push_back(fullLeaf->GetNum());
+
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = fullGraph->GetInstByIndx(fullInstNums_[i]);
+    cmpnntInstNums[inst->GetNum()] = i;
+    // The ready list expects node IDs below the instruction count. The
+    // numbers are in the full graph's order, so renumbering keeps the order.
+    CreateNode_(i, inst->GetName(), inst->GetInstType(), inst->GetOpCode(), i,
+                inst->GetFileSchedOrder(), inst->GetFileSchedCycle(), 0, 0, 0);
+  }
+
+  for (InstCount i = 0; i < rootNum; i++) {
+    SchedInstruction *inst = fullGraph->GetInstByIndx(fullInstNums_[i]);
+
+    for (GraphEdge &edge : inst->GetPredecessors())
+      if (edge.from == fullRoot)
+        CreateEdge_(rootNum, i, edge.label, (DependenceType)edge.label2,
+                    edge.IsArtificial);
+
+    for (GraphEdge &edge : inst->GetSuccessors()) {
+      InstCount toNum = cmpnntInstNums[edge.to->GetNum()];
+      assert(toNum != INVALID_VALUE);
+      CreateEdge_(i, toNum, edge.label, (DependenceType)edge.label2,
+                  edge.IsArtificial);
+    }
+  }
+
+  // Like the full graph, hang the instructions without predecessors
+  // (successors) from the artificial root (leaf).
+  for (InstCount i = 0; i < rootNum; i++) {
+    if (insts_[i]->GetPrdcsrCnt() == 0)
+      CreateEdge_(rootNum, i, 0, DEP_OTHER);
+    if (insts_[i]->GetScsrCnt() == 0)
+      CreateEdge_(i, leafNum, 0, DEP_OTHER);
+  }
+
+  for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++)
+    RegFiles[i].SetRegType(i);
+
+  if (Finish_() == RES_ERROR)
+    llvm::report_fatal_error("Invalid component graph.", false);
 }
 
 DataDepSubGraph::DataDepSubGraph(DataDepGraph *fullGraph, InstCount maxInstCnt,
-                                 MachineModel *machMdl)
+                                 const MachineModel *machMdl)
     : DataDepStruct(machMdl) {
   InstCount i;
 
@@ -1528,12 +1843,14 @@ void DataDepSubGraph::CreateRootAndLeafInsts_() {
                            INVALID_VALUE, INVALID_VALUE, 0, 0, machMdl_);
 
   rootInst_->SetIssueType(issuType);
+  rootInst_->SetSchedState(&rootState_);
 
   leafInst_ =
       new SchedInstruction(INVALID_VALUE, "leaf", instType, " ", maxInstCnt_, 0,
                            INVALID_VALUE, INVALID_VALUE, 0, 0, machMdl_);
 
   leafInst_->SetIssueType(issuType);
+  leafInst_->SetSchedState(&leafState_);
 
   InstCount rootIndx = 0;
   InstCount leafIndx = instCnt_ - 1;
@@ -2384,7 +2701,7 @@ InstCount DataDepSubGraph::CmputTwoInstDynmcLwrBound_() {
          inst1->IsRcrsvPrdcsr(inst2) == false);
 
   if (inst1->IsRcrsvScsr(inst2)) {
-    ltncyLB = inst2->GetRltvCrtclPath(DIR_FRWRD, inst1);
+    ltncyLB = fullGraph_->GetRltvCrtclPath(inst1, inst2, DIR_FRWRD);
     assert(ltncyLB != INVALID_VALUE);
     ltncyLB += 1;
   }
@@ -2477,7 +2794,7 @@ InstCount DataDepSubGraph::GetRltvCrtclPath(SchedInstruction *ref,
     assert(inst != rootInst_ && inst != leafInst_);
     assert(IsInGraph(ref));
     assert(IsInGraph(inst));
-    rltvCP = inst->GetRltvCrtclPath(dir, ref);
+    rltvCP = fullGraph_->GetRltvCrtclPath(ref, inst, dir);
   }
 
   return rltvCP;
@@ -2559,7 +2876,7 @@ InstCount DataDepSubGraph::CmputExtrnlLtncy_(
   assert(IsInGraph(pred) && IsInGraph(scsr) == false);
   assert(pred->IsRcrsvScsr(scsr) && scsr->IsRcrsvPrdcsr(pred));
 
-  int ltncy = scsr->GetRltvCrtclPath(DIR_FRWRD, pred);
+  int ltncy = fullGraph_->GetRltvCrtclPath(pred, scsr, DIR_FRWRD);
   assert(ltncy >= 0);
 
   if (ltncy > 1) {
@@ -2596,8 +2913,8 @@ InstCount DataDepSubGraph::GetDistFrmLeaf(SchedInstruction *inst) {
   return distFrmLeaf;
 }
 
-InstSchedule::InstSchedule(MachineModel *machMdl, DataDepGraph *dataDepGraph,
-                           bool vrfy) {
+InstSchedule::InstSchedule(const MachineModel *machMdl,
+                           DataDepGraph *dataDepGraph, bool vrfy) {
   machMdl_ = machMdl;
   issuRate_ = machMdl->GetIssueRate();
   totInstCnt_ = dataDepGraph->GetInstCnt();
@@ -2866,7 +3183,8 @@ void InstSchedule::PrintInstList(FILE *file, DataDepGraph *dataDepGraph,
 #endif
 }
 
-bool InstSchedule::Verify(MachineModel *machMdl, DataDepGraph *dataDepGraph) {
+bool InstSchedule::Verify(const MachineModel *machMdl,
+                          DataDepGraph *dataDepGraph) {
   if (schduldInstCnt_ < totInstCnt_) {
     Logger::Error("Invalid schedule: too few scheduled instructions: %d of %d",
                   schduldInstCnt_, totInstCnt_);
@@ -2907,7 +3225,7 @@ bool InstSchedule::Verify(MachineModel *machMdl, DataDepGraph *dataDepGraph) {
   return true;
 }
 
-bool InstSchedule::VerifySlots_(MachineModel *machMdl,
+bool InstSchedule::VerifySlots_(const MachineModel *machMdl,
                                 DataDepGraph *dataDepGraph) {
   InstCount i;
   int slotsPerCycle[MAX_ISSUTYPE_CNT];
@@ -7,6 +7,7 @@
 #include "opt-sched/Scheduler/utilities.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -36,6 +37,7 @@ EnumTreeNode::~EnumTreeNode() {
     }
     exmndInsts_->Reset();
     delete exmndInsts_;
+    delete exmndInstSet_;
 
     assert(chldrn_ != NULL);
     delete chldrn_;
@@ -93,6 +95,7 @@ void EnumTreeNode::Construct(EnumTreeNode *prevNode, SchedInstruction *inst,
 
   if (isCnstrctd_ == false) {
     exmndInsts_ = new LinkedList<ExaminedInst>(instCnt);
+    exmndInstSet_ = new BitVector(instCnt);
     chldrn_ = new LinkedList<HistEnumTreeNode>(instCnt);
     frwrdLwrBounds_ = new InstCount[instCnt];
   }
@@ -120,6 +123,7 @@ void EnumTreeNode::Reset() {
   if (exmndInsts_ != NULL) {
     for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt();
          exmndInst != NULL; exmndInst = exmndInsts_->GetNxtElmnt()) {
+      exmndInstSet_->SetBit(exmndInst->GetInst()->GetNum(), false);
       delete exmndInst;
     }
     exmndInsts_->Reset();
@@ -254,6 +258,7 @@ void EnumTreeNode::NewBranchExmnd(SchedInstruction *inst, bool isLegal,
           exmndInst =
               new ExaminedInst(inst, wasRlxInfsbl, enumrtr_->dirctTightndLst_);
           exmndInsts_->InsrtElmnt(exmndInst);
+          exmndInstSet_->SetBit(inst->GetNum());
         }
       }
     }
@@ -275,6 +280,23 @@ void EnumTreeNode::NewBranchExmnd(SchedInstruction *inst, bool isLegal,
 }
 /*****************************************************************************/
 
+void EnumTreeNode::ResetBranches() {
+  for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt();
+       exmndInst != NULL; exmndInst = exmndInsts_->GetNxtElmnt()) {
+    exmndInstSet_->SetBit(exmndInst->GetInst()->GetNum(), false);
+    delete exmndInst;
+  }
+  exmndInsts_->Reset();
+
+  crntBrnchNum_ = 0;
+  legalInstCnt_ = 0;
+  isFsbl_ = true;
+  isLngthFsbl_ = true;
+  SetBranchCnt(rdyLst_->GetInstCnt(), isLeaf_);
+  rdyLst_->ResetIterator();
+}
+/*****************************************************************************/
+
 void EnumTreeNode::SetBranchCnt(InstCount rdyLstSize, bool isLeaf) {
   assert(isLeaf == false || rdyLstSize == 0);
   isLeaf_ = isLeaf;
@@ -319,28 +341,22 @@ bool EnumTreeNode::WasSprirNodeExmnd(SchedInstruction *cnddtInst) {
   if (cnddtInst == NULL)
     return false;
 
+  // The superiority relation is static, so the graph keeps it precomputed
+  // and the check takes one AND per 64 instructions.
+  if (exmndInstSet_->Intersects(
+          enumrtr_->dataDepGraph_->GetSprirInsts(cnddtInst)))
+    return true;
+
+#ifdef IS_DEBUG_NODEDOM
   for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt(); exmndInst != NULL;
        exmndInst = exmndInsts_->GetNxtElmnt()) {
     SchedInstruction *inst = exmndInst->GetInst();
-    assert(inst != cnddtInst);
-
     if (inst->GetIssueType() == cnddtInst->GetIssueType() &&
-        inst->BlocksCycle() == cnddtInst->BlocksCycle() &&
-        inst->IsPipelined() == cnddtInst->IsPipelined()) {
-      if (cnddtInst->IsScsrDmntd(inst)) {
-        return true;
-      } else {
-#ifdef IS_DEBUG
-        assert(!cnddtInst->IsScsrEquvlnt(inst));
-#ifdef IS_DEBUG_NODEDOM
-        if (inst->IsScsrDmntd(cnddtInst)) {
-          stats::negativeNodeDominationHits++;
-        }
-#endif
-#endif
-      }
+        inst->IsScsrDmntd(cnddtInst)) {
+      stats::negativeNodeDominationHits++;
     }
   }
+#endif
 
   return false;
 }
@@ -432,7 +448,7 @@ EnumTreeNode::ExaminedInst::~ExaminedInst() {
 /****************************************************************************/
 /****************************************************************************/
 
-Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+Enumerator::Enumerator(DataDepGraph *dataDepGraph, const MachineModel *machMdl,
                        InstCount schedUprBound, int16_t sigHashSize,
                        SchedPriorities prirts, Pruning PruningStrategy,
                        bool SchedForRPOnly, bool enblStallEnum,
@@ -488,6 +504,9 @@ Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
   Milliseconds histTableInitTime = Utilities::GetProcessorTime();
 
   exmndSubProbs_ = NULL;
+  isHstryReused_ = false;
+  isHstryKept_ = false;
+  isBestFrstSrch_ = false;
 
   if (IsHistDom()) {
     exmndSubProbs_ =
@@ -560,7 +579,7 @@ void Enumerator::SetupAllocators_() {
 void Enumerator::ResetAllocators_() {
   nodeAlctr_->Reset();
 
-  if (IsHistDom())
+  if (IsHistDom() && !isHstryKept_)
     hashTblEntryAlctr_->Reset();
 }
 /****************************************************************************/
@@ -583,7 +602,12 @@ void Enumerator::FreeAllocators_() {
 
 void Enumerator::Reset() {
   if (IsHistDom()) {
-    exmndSubProbs_->Clear(false, hashTblEntryAlctr_);
+    // A reused table grows with every target length tried. Past the cap,
+    // start the next length over with an empty table.
+    isHstryKept_ = isHstryReused_ &&
+                   exmndSubProbs_->GetEntryCnt() < MAX_REUSED_HIST_ENTRY_CNT;
+    if (!isHstryKept_)
+      exmndSubProbs_->Clear(false, hashTblEntryAlctr_);
   }
 
   ResetAllocators_();
@@ -652,6 +676,15 @@ bool Enumerator::Initialize_(InstSchedule *sched, InstCount trgtLngth) {
 
   rlxdSchdulr_->SetupPrirtyLst();
 
+  if (prune_.rlxd) {
+    // One node per issue slot of the target length, plus the root.
+    size_t nodeTimeCnt = trgtSchedLngth_ * issuRate_ + 1;
+    if (rlxdBaselines_.size() < nodeTimeCnt) {
+      rlxdBaselines_.resize(nodeTimeCnt);
+      rlxdChkCnts_.resize(nodeTimeCnt);
+    }
+  }
+
   createdNodeCnt_ = 0;
   fxdInstCnt_ = 0;
   rdyLst_ = NULL;
@@ -871,12 +904,6 @@ void AppendAndCheckSuffixSchedules(
 FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
                                               InstCount trgtLngth,
                                               Milliseconds deadline) {
-  EnumTreeNode *nxtNode = NULL;
-  bool allNodesExplrd = false;
-  bool foundFsblBrnch = false;
-  bool isCrntNodeFsbl = true;
-  bool isTimeout = false;
-
   if (!isCnstrctd_)
     return RES_ERROR;
 
@@ -890,12 +917,39 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
   uint64_t prevNodeCnt = exmndNodeCnt_;
 #endif
 
-  while (!(allNodesExplrd || WasObjctvMet_())) {
+  FUNC_RESULT rslt = ExploreSubTree_(deadline);
+
+#ifdef IS_DEBUG_NODES
+  uint64_t crntNodeCnt = exmndNodeCnt_ - prevNodeCnt;
+  stats::nodesPerLength.Record(crntNodeCnt);
+#endif
+
+  if (rslt == RES_TIMEOUT)
+    return RES_TIMEOUT;
+  // Logger::Info("\nEnumeration at length %d done\n", trgtLngth);
+  return fsblSchedCnt_ > 0 ? RES_SUCCESS : RES_FAIL;
+}
+/****************************************************************************/
+
+FUNC_RESULT Enumerator::ExploreSubTree_(Milliseconds deadline,
+                                        uint64_t exmndNodeLimit) {
+  EnumTreeNode *subTreeRoot = crntNode_;
+  EnumTreeNode *nxtNode = NULL;
+  bool allNodesExplrd = false;
+  bool foundFsblBrnch = false;
+  bool isCrntNodeFsbl = true;
+
+  while (!allNodesExplrd) {
+    if (WasObjctvMet_())
+      return RES_SUCCESS;
+
     if (deadline != INVALID_VALUE && Utilities::GetProcessorTime() > deadline) {
-      isTimeout = true;
-      break;
+      return RES_TIMEOUT;
     }
 
+    if (exmndNodeCnt_ >= exmndNodeLimit)
+      return RES_END;
+
     mostRecentMatchingHistNode_ = nullptr;
 
     if (isCrntNodeFsbl) {
@@ -934,7 +988,7 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
     } else {
       // All branches from the current node have been explored, and no more
       // branches that lead to feasible nodes have been found.
-      if (crntNode_ == rootNode_) {
+      if (crntNode_ == subTreeRoot) {
         allNodesExplrd = true;
       } else {
         isCrntNodeFsbl = BackTrack_();
@@ -949,15 +1003,7 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
 #endif
   }
 
-#ifdef IS_DEBUG_NODES
-  uint64_t crntNodeCnt = exmndNodeCnt_ - prevNodeCnt;
-  stats::nodesPerLength.Record(crntNodeCnt);
-#endif
-
-  if (isTimeout)
-    return RES_TIMEOUT;
-  // Logger::Info("\nEnumeration at length %d done\n", trgtLngth);
-  return fsblSchedCnt_ > 0 ? RES_SUCCESS : RES_FAIL;
+  return RES_FAIL;
 }
 /****************************************************************************/
 
@@ -1020,6 +1066,13 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
     } else {
       inst = rdyLst_->GetNextPriorityInst();
       assert(inst != NULL);
+      // An interchangeable instruction that comes before this one is ready
+      // too, and the subtree under it covers this branch.
+      if (inst->IsEquvlntBlckd()) {
+        crntNode_->NewBranchExmnd(inst, false, false, false, false, DIR_FRWRD,
+                                  false);
+        continue;
+      }
       bool isLegal = ChkInstLglty_(inst);
       isLngthFsbl = isLegal;
 
@@ -1119,6 +1172,10 @@ bool Enumerator::ProbeBranch_(SchedInstruction *inst, EnumTreeNode *&newNode,
       }
   }
 
+  if (prune_.rlxd) {
+    RecordRlxdBaseline_();
+  }
+
   if (inst != NULL) {
     inst->Schedule(crntCycleNum_, crntSlotNum_);
     DoRsrvSlots_(inst);
@@ -1300,6 +1357,11 @@ void Enumerator::StepFrwrd_(EnumTreeNode *&newNode) {
 void Enumerator::InitNewNode_(EnumTreeNode *newNode) {
   crntNode_ = newNode;
 
+  if (prune_.rlxd) {
+    rlxdBaselines_[crntNode_->GetTime()].isValid = false;
+    rlxdChkCnts_[crntNode_->GetTime()] = 0;
+  }
+
   crntNode_->SetCrntCycleBlkd(isCrntCycleBlkd_);
   crntNode_->SetRealSlotNum(crntRealSlotNum_);
 
@@ -1475,14 +1537,18 @@ void SetTotalCostsAndSuffixes(EnumTreeNode *const currentNode,
 }
 } // end anonymous namespace
 
-bool Enumerator::BackTrack_() {
+bool Enumerator::BackTrack_(bool isSubProbExmnd) {
   bool fsbl = true;
   SchedInstruction *inst = crntNode_->GetInst();
   EnumTreeNode *trgtNode = crntNode_->GetParent();
 
   rdyLst_->RemoveLatestSubList();
 
-  if (IsHistDom()) {
+  if (IsHistDom() && !isSubProbExmnd) {
+    // Nothing can be concluded about a partially explored sub-problem, so it
+    // is not archived. Its history node is not freed either, since archived
+    // nodes below it refer to it as their predecessor.
+  } else if (IsHistDom()) {
     assert(!crntNode_->IsArchived());
     HistEnumTreeNode *crntHstry = crntNode_->GetHistory();
     exmndSubProbs_->InsertElement(crntNode_->GetSig(), crntHstry,
@@ -1504,8 +1570,9 @@ bool Enumerator::BackTrack_() {
 
   MovToPrevSlot_(crntNode_->GetRealSlotNum());
 
-  trgtNode->NewBranchExmnd(inst, true, false, false, crntNode_->IsFeasible(),
-                           DIR_BKWRD, prevNode->IsLngthFsbl());
+  if (isSubProbExmnd)
+    trgtNode->NewBranchExmnd(inst, true, false, false, crntNode_->IsFeasible(),
+                             DIR_BKWRD, prevNode->IsLngthFsbl());
 
 #ifdef IS_DEBUG_FLOW
   InstCount instNum = inst == NULL ? SCHD_STALL : inst->GetNum();
@@ -1564,10 +1631,28 @@ bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
     stats::signatureMatches++;
 #endif
 
-    if (exNode->DoesMatch(newNode, this)) {
+    // A sub-problem examined under a shorter target length can only dominate
+    // nodes that are behind it by the length difference. Rule the others out
+    // before matching the scheduled instructions.
+    InstCount shft = trgtSchedLngth_ - exNode->GetTrgtLngth();
+    if (shft > 0 && exNode->GetTime() + shft * issuRate_ > newNode->GetTime())
+      continue;
+
+    // The best-first search stores nodes before exploring their subtrees, so
+    // a stored node must not dominate a descendant reached through stalls.
+    // Depth-first search only stores explored nodes, which are never
+    // ancestors of the node being examined.
+    if (exNode->DoesMatch(newNode, this) &&
+        !(isBestFrstSrch_ &&
+          newNode->GetHistory()->IsPrdcsrViaStalls(exNode))) {
       if (!mostRecentMatchWasSet) {
+        // A suffix found under a shorter target length may not be the best
+        // one under this length.
         mostRecentMatchingHistNode_ =
-            (exNode->GetSuffix() != nullptr) ? exNode : nullptr;
+            (exNode->GetSuffix() != nullptr &&
+             exNode->GetTrgtLngth() == trgtSchedLngth_)
+                ? exNode
+                : nullptr;
         mostRecentMatchWasSet = true;
       }
 
@@ -1810,12 +1895,34 @@ void Enumerator::RestoreCrntLwrBounds_(SchedInstruction *unschduldInst) {
 }
 /*****************************************************************************/
 
+void Enumerator::RecordRlxdBaseline_() {
+  assert(IsStateClear_());
+  InstCount time = crntNode_->GetTime();
+  RlxdBaseline &bsln = rlxdBaselines_[time];
+
+  if (rlxdChkCnts_[time] > 0 && !bsln.isValid) {
+    rlxdSchdulr_->RecordBaseline(crntCycleNum_, trgtSchedLngth_ - 1, bsln);
+  }
+}
+/*****************************************************************************/
+
 bool Enumerator::RlxdSchdul_(EnumTreeNode *newNode) {
   assert(newNode != NULL);
   LinkedList<SchedInstruction> *rsrcFxdLst = new LinkedList<SchedInstruction>;
-
-  bool fsbl =
-      rlxdSchdulr_->SchdulAndChkFsblty(crntCycleNum_, trgtSchedLngth_ - 1);
+  InstCount time = crntNode_->GetTime();
+  const RlxdBaseline &bsln = rlxdBaselines_[time];
+
+  bool fsbl = bsln.isValid
+                  ? rlxdSchdulr_->SchdulAndChkFsblty(crntCycleNum_,
+                                                     trgtSchedLngth_ - 1, bsln)
+                  : rlxdSchdulr_->SchdulAndChkFsblty(crntCycleNum_,
+                                                     trgtSchedLngth_ - 1);
+  rlxdChkCnts_[time]++;
+#ifdef IS_DEBUG_RLXD_BASELINE
+  assert(!bsln.isValid ||
+         fsbl == rlxdSchdulr_->SchdulAndChkFsblty(crntCycleNum_,
+                                                  trgtSchedLngth_ - 1));
+#endif
 
   for (SchedInstruction *inst = rsrcFxdLst->GetFrstElmnt(); inst != NULL;
        inst = rsrcFxdLst->GetNxtElmnt()) {
@@ -1892,10 +1999,11 @@ bool Enumerator::EnumStall_() { return enblStallEnum_; }
 /*****************************************************************************/
 
 LengthEnumerator::LengthEnumerator(
-    DataDepGraph *dataDepGraph, MachineModel *machMdl, InstCount schedUprBound,
-    int16_t sigHashSize, SchedPriorities prirts, Pruning PruningStrategy,
-    bool SchedForRPOnly, bool enblStallEnum, Milliseconds timeout,
-    InstCount preFxdInstCnt, SchedInstruction *preFxdInsts[])
+    DataDepGraph *dataDepGraph, const MachineModel *machMdl,
+    InstCount schedUprBound, int16_t sigHashSize, SchedPriorities prirts,
+    Pruning PruningStrategy, bool SchedForRPOnly, bool enblStallEnum,
+    Milliseconds timeout, InstCount preFxdInstCnt,
+    SchedInstruction *preFxdInsts[])
     : Enumerator(dataDepGraph, machMdl, schedUprBound, sigHashSize, prirts,
                  PruningStrategy, SchedForRPOnly, enblStallEnum, timeout,
                  preFxdInstCnt, preFxdInsts) {
@@ -1979,11 +2087,11 @@ void LengthEnumerator::FreeHistNode_(HistEnumTreeNode *histNode) {
 /*****************************************************************************/
 
 LengthCostEnumerator::LengthCostEnumerator(
-    DataDepGraph *dataDepGraph, MachineModel *machMdl, InstCount schedUprBound,
-    int16_t sigHashSize, SchedPriorities prirts, Pruning PruningStrategy,
-    bool SchedForRPOnly, bool enblStallEnum, Milliseconds timeout,
-    SPILL_COST_FUNCTION spillCostFunc, InstCount preFxdInstCnt,
-    SchedInstruction *preFxdInsts[])
+    DataDepGraph *dataDepGraph, const MachineModel *machMdl,
+    InstCount schedUprBound, int16_t sigHashSize, SchedPriorities prirts,
+    Pruning PruningStrategy, bool SchedForRPOnly, bool enblStallEnum,
+    Milliseconds timeout, SPILL_COST_FUNCTION spillCostFunc,
+    InstCount preFxdInstCnt, SchedInstruction *preFxdInsts[])
     : Enumerator(dataDepGraph, machMdl, schedUprBound, sigHashSize, prirts,
                  PruningStrategy, SchedForRPOnly, enblStallEnum, timeout,
                  preFxdInstCnt, preFxdInsts) {
@@ -1994,11 +2102,18 @@ LengthCostEnumerator::LengthCostEnumerator(
   isEarlySubProbDom_ = false;
   costLwrBound_ = 0;
   spillCostFunc_ = spillCostFunc;
+  isGapStop_ = false;
+  bestFrstNodeBudget_ = 0;
+  restartPolicy_ = RSP_NONE;
+  restartNodeCnt_ = 0;
+  restartGrowth_ = 1;
   tmpHstryNode_ = new CostHistEnumTreeNode;
 }
 /*****************************************************************************/
 
 LengthCostEnumerator::~LengthCostEnumerator() {
+  // The history table must be empty before its entry allocator is freed.
+  isHstryReused_ = false;
   Reset();
   FreeAllocators_();
 }
@@ -2017,7 +2132,7 @@ void LengthCostEnumerator::SetupAllocators_() {
 
 void LengthCostEnumerator::ResetAllocators_() {
   Enumerator::ResetAllocators_();
-  if (IsHistDom())
+  if (IsHistDom() && !isHstryKept_)
     histNodeAlctr_->Reset();
 }
 /****************************************************************************/
@@ -2059,6 +2174,7 @@ FUNC_RESULT LengthCostEnumerator::FindFeasibleSchedule(InstSchedule *sched,
                                                        Milliseconds deadline) {
   rgn_ = rgn;
   costLwrBound_ = costLwrBound;
+  isGapStop_ = false;
   SpillCostLwrBound_ = rgn_->getSpillCostLwrBound();
 
   this->setIsSecondPass(rgn_->IsSecondPass());
@@ -2069,7 +2185,15 @@ FUNC_RESULT LengthCostEnumerator::FindFeasibleSchedule(InstSchedule *sched,
   else
     TrgtSpillConstraint_ = SpillCostLwrBound_;
 
-  FUNC_RESULT rslt = FindFeasibleSchedule_(sched, trgtLngth, deadline);
+  FUNC_RESULT rslt;
+  // Without cost pruning there are no cost lower bounds to order the search
+  // by.
+  if (bestFrstNodeBudget_ > 0 && prune_.spillCost)
+    rslt = FindFeasibleScheduleBestFrst_(sched, trgtLngth, deadline);
+  else if (restartPolicy_ != RSP_NONE)
+    rslt = FindFeasibleScheduleWithRestarts_(sched, trgtLngth, deadline);
+  else
+    rslt = FindFeasibleSchedule_(sched, trgtLngth, deadline);
 
 #ifdef IS_DEBUG_TRACE_ENUM
   stats::costChecksPerLength.Record(costChkCnt_);
@@ -2082,6 +2206,312 @@ FUNC_RESULT LengthCostEnumerator::FindFeasibleSchedule(InstSchedule *sched,
 }
 /*****************************************************************************/
 
+FUNC_RESULT LengthCostEnumerator::FindFeasibleScheduleBestFrst_(
+    InstSchedule *sched, InstCount trgtLngth, Milliseconds deadline) {
+  if (!isCnstrctd_)
+    return RES_ERROR;
+
+  assert(trgtLngth <= schedUprBound_);
+
+  if (Initialize_(sched, trgtLngth) == false) {
+    return RES_FAIL;
+  }
+
+  bestFrstSteps_.clear();
+  bestFrstFrntr_.clear();
+  PushBestFrstNode_({GetCrntCostLwrBound_(), 0, INVALID_VALUE});
+  bool isObjctvMet = false;
+  isBestFrstSrch_ = true;
+
+  while (!bestFrstFrntr_.empty() && !isObjctvMet) {
+    if (deadline != INVALID_VALUE && Utilities::GetProcessorTime() > deadline) {
+      isBestFrstSrch_ = false;
+      return RES_TIMEOUT;
+    }
+
+    if ((int)bestFrstSteps_.size() >= bestFrstNodeBudget_)
+      break;
+
+    BestFrstNode node = PopBestFrstNode_();
+    // The frontier is ordered by cost lower bound, so nothing left in it can
+    // improve on the best schedule either.
+    if (!IsCostLwrBoundFsbl_(node.costLwrBound)) {
+      bestFrstFrntr_.clear();
+      break;
+    }
+
+    if (ReplayBestFrstStep_(node.step))
+      isObjctvMet = ExpandBestFrstNode_(node);
+
+    if (!isObjctvMet)
+      UnwindToRoot_();
+  }
+  isBestFrstSrch_ = false;
+
+  if (!bestFrstFrntr_.empty() && !isObjctvMet) {
+#ifdef IS_DEBUG_FLOW
+    Logger::Info("Best-first search stored %d nodes. Falling back to DFS.",
+                 (int)bestFrstSteps_.size());
+#endif
+    // The stored nodes are in the history table without having been
+    // explored. Drop them and search the whole tree depth first, now bounded
+    // by the best schedule found so far.
+    bestFrstFrntr_.clear();
+    if (IsHistDom())
+      exmndSubProbs_->Clear(false, hashTblEntryAlctr_);
+    FUNC_RESULT rslt = ExploreSubTree_(deadline);
+    if (rslt == RES_TIMEOUT)
+      return RES_TIMEOUT;
+  }
+
+  return fsblSchedCnt_ > 0 ? RES_SUCCESS : RES_FAIL;
+}
+/*****************************************************************************/
+
+bool LengthCostEnumerator::ExpandBestFrstNode_(const BestFrstNode &node) {
+  EnumTreeNode *nxtNode = NULL;
+  bool isCrntNodeFsbl = true;
+
+  while (isCrntNodeFsbl) {
+    mostRecentMatchingHistNode_ = nullptr;
+
+    if (!FindNxtFsblBrnch_(nxtNode))
+      break;
+
+    StepFrwrd_(nxtNode);
+    SchedInstruction *inst = crntNode_->GetInst();
+
+    if (IsHistDom() && mostRecentMatchingHistNode_ != nullptr) {
+      // The sub-problem is covered by concatenating the best known suffix.
+      AppendAndCheckSuffixSchedules(mostRecentMatchingHistNode_, rgn_,
+                                    crntSched_, trgtSchedLngth_, this,
+                                    crntNode_, dataDepGraph_);
+    } else if (crntNode_->IsLeaf()) {
+      if (WasObjctvMet_())
+        return true;
+    } else {
+      StoreBestFrstNode_(node);
+    }
+
+    // The child's subtree has not been explored, so it is not archived, but
+    // its parent still has to move on to the next branch.
+    isCrntNodeFsbl = BackTrack_(false);
+    crntNode_->NewBranchExmnd(inst, true, false, false, true, DIR_FRWRD, true);
+  }
+
+  return false;
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::StoreBestFrstNode_(const BestFrstNode &parent) {
+  HistEnumTreeNode *hstry = NULL;
+
+  if (IsHistDom()) {
+    // Archive the node like an inner node with no feasible schedule found
+    // below it yet. Its subtree will still be searched, so it may dominate
+    // nodes that reach the same state later.
+    crntNode_->SetTotalCost(crntNode_->GetCostLwrBound());
+    crntNode_->setTotalSpillCost(crntNode_->getSpillCostLwrBound());
+    crntNode_->Archive();
+    hstry = crntNode_->GetHistory();
+    exmndSubProbs_->InsertElement(crntNode_->GetSig(), hstry,
+                                  hashTblEntryAlctr_);
+  }
+
+  bestFrstSteps_.push_back({parent.step, crntNode_->GetInstNum(), hstry});
+  PushBestFrstNode_({GetCrntCostLwrBound_(), parent.depth + 1,
+                     (int)bestFrstSteps_.size() - 1});
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::PushBestFrstNode_(const BestFrstNode &node) {
+  bestFrstFrntr_.push_back(node);
+  std::push_heap(bestFrstFrntr_.begin(), bestFrstFrntr_.end(),
+                 IsBestFrstNodeLessPromising);
+}
+/*****************************************************************************/
+
+LengthCostEnumerator::BestFrstNode LengthCostEnumerator::PopBestFrstNode_() {
+  std::pop_heap(bestFrstFrntr_.begin(), bestFrstFrntr_.end(),
+                IsBestFrstNodeLessPromising);
+  BestFrstNode node = bestFrstFrntr_.back();
+  bestFrstFrntr_.pop_back();
+  return node;
+}
+/*****************************************************************************/
+
+bool LengthCostEnumerator::ReplayBestFrstStep_(int step) {
+  assert(crntNode_ == rootNode_);
+
+  bestFrstPath_.clear();
+  for (; step != INVALID_VALUE; step = bestFrstSteps_[step].prevStep)
+    bestFrstPath_.push_back(step);
+
+  // Every node on the path is in the history table and would be found to
+  // dominate itself, so replay without history domination and reattach the
+  // stored history nodes instead.
+  bool isHistDom = prune_.histDom;
+  prune_.histDom = false;
+  bool fsbl = true;
+
+  for (auto it = bestFrstPath_.rbegin(); fsbl && it != bestFrstPath_.rend();
+       ++it) {
+    const BestFrstStep &crntStep = bestFrstSteps_[*it];
+    fsbl = ReplayBranch_(crntStep.instNum);
+    if (fsbl && isHistDom) {
+      crntNode_->SetHistory(crntStep.hstry);
+      crntNode_->SetTotalCost(crntNode_->GetCostLwrBound());
+      crntNode_->setTotalSpillCost(crntNode_->getSpillCostLwrBound());
+      crntNode_->Archive();
+    }
+  }
+
+  prune_.histDom = isHistDom;
+  return fsbl;
+}
+/*****************************************************************************/
+
+bool LengthCostEnumerator::ReplayBranch_(InstCount instNum) {
+  SchedInstruction *inst = NULL;
+  EnumTreeNode *newNode = NULL;
+  bool isNodeDmntd = false, isRlxInfsbl = false, isLngthFsbl = true;
+
+  if (SchedForRPOnly_)
+    crntNode_->SetFoundInstWithUse(IsUseInRdyLst_());
+
+  if (instNum != SCHD_STALL) {
+    inst = dataDepGraph_->GetInstByIndx(instNum);
+
+    // Move the ready list iterator to the instruction so that stepping
+    // forward removes it from the ready list.
+    SchedInstruction *rdyInst;
+    rdyLst_->ResetIterator();
+    do {
+      rdyInst = rdyLst_->GetNextPriorityInst();
+    } while (rdyInst != NULL && rdyInst != inst);
+    assert(rdyInst == inst);
+
+    if (rdyInst == NULL || !ChkInstLglty_(inst))
+      return false;
+  }
+
+  // The cost checks are repeated, since the best schedule may have improved
+  // since this branch was stored.
+  if (!ProbeBranch_(inst, newNode, isNodeDmntd, isRlxInfsbl, isLngthFsbl)) {
+    RestoreCrntState_(inst, newNode);
+    return false;
+  }
+
+  StepFrwrd_(newNode);
+  return true;
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::UnwindToRoot_() {
+  while (crntNode_ != rootNode_)
+    BackTrack_(false);
+
+  // The root outlives every expansion, so forget the branches examined while
+  // expanding it. Otherwise node superiority could prune the replay of one of
+  // its children because of a sibling that was examined later.
+  rootNode_->ResetBranches();
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::SetRestartPolicy(RESTART_POLICY policy,
+                                            int nodeCnt, float growth,
+                                            int seed) {
+  assert(policy == RSP_NONE || nodeCnt > 0);
+  assert(policy != RSP_GEOMETRIC || growth > 1);
+  restartPolicy_ = policy;
+  restartNodeCnt_ = nodeCnt;
+  restartGrowth_ = growth;
+  restartRNG_.seed(seed);
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::SetHstryReuse(bool isReused) {
+  // With the other cost functions, only the sub-problems without a schedule
+  // of their target length carry over, which is rarely worth the longer
+  // history lists.
+  isHstryReused_ = isReused && IsHistDom() &&
+                   (spillCostFunc_ == SCF_TARGET || spillCostFunc_ == SCF_PRP ||
+                    spillCostFunc_ == SCF_PERP);
+}
+/*****************************************************************************/
+
+FUNC_RESULT LengthCostEnumerator::FindFeasibleScheduleWithRestarts_(
+    InstSchedule *sched, InstCount trgtLngth, Milliseconds deadline) {
+  if (!isCnstrctd_)
+    return RES_ERROR;
+
+  assert(trgtLngth <= schedUprBound_);
+
+  // The first run uses the enumeration heuristic as is.
+  tieBreakOrder_.clear();
+
+  if (Initialize_(sched, trgtLngth) == false) {
+    return RES_FAIL;
+  }
+
+  FUNC_RESULT rslt;
+  for (int restartNum = 0;; restartNum++) {
+    rslt = ExploreSubTree_(deadline,
+                           exmndNodeCnt_ + GetRestartNodeCnt_(restartNum));
+    if (rslt != RES_END)
+      break;
+
+#ifdef IS_DEBUG_FLOW
+    Logger::Info("Restarting the enumeration of length %d after %llu nodes.",
+                 trgtLngth, (unsigned long long)exmndNodeCnt_);
+#endif
+    // The partially explored nodes on the way back up are not archived,
+    // unlike the sub-problems that were fully explored below them.
+    UnwindToRoot_();
+    RandomizeTieBreaking_();
+    rdyLst_->RecomputeKeys();
+  }
+
+  if (rslt == RES_TIMEOUT)
+    return RES_TIMEOUT;
+  return fsblSchedCnt_ > 0 ? RES_SUCCESS : RES_FAIL;
+}
+/*****************************************************************************/
+
+// The i-th term, counting from 1, of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+static uint64_t GetLubyTerm(uint64_t i) {
+  for (int k = 1;; k++) {
+    uint64_t pow = (uint64_t)1 << k;
+    if (i == pow - 1)
+      return pow / 2;
+    if (i < pow - 1)
+      return GetLubyTerm(i - pow / 2 + 1);
+  }
+}
+
+uint64_t LengthCostEnumerator::GetRestartNodeCnt_(int restartNum) {
+  if (restartPolicy_ == RSP_LUBY)
+    return restartNodeCnt_ * GetLubyTerm(restartNum + 1);
+
+  double nodeCnt = restartNodeCnt_ * std::pow(restartGrowth_, restartNum);
+  // Stop restarting once the limit no longer fits.
+  if (nodeCnt >= (double)(UINT64_MAX / 2))
+    return UINT64_MAX / 2;
+  return (uint64_t)nodeCnt;
+}
+/*****************************************************************************/
+
+void LengthCostEnumerator::RandomizeTieBreaking_() {
+  tieBreakOrder_.resize(totInstCnt_);
+  for (InstCount i = 0; i < totInstCnt_; i++)
+    tieBreakOrder_[i] = i;
+  std::shuffle(tieBreakOrder_.begin(), tieBreakOrder_.end(), restartRNG_);
+
+  // The ready lists that already exist point to the same order.
+  rdyLst_->setTieBreakOrder(tieBreakOrder_.data());
+}
+/*****************************************************************************/
+
 bool LengthCostEnumerator::WasObjctvMet_() {
   if (!IsSchedComplete_())
     return false;
@@ -2092,14 +2522,20 @@ bool LengthCostEnumerator::WasObjctvMet_() {
     return false;
   }
 
+  bool isObjctvMet;
   if (!rgn_->isTwoPassEnabled())
-    return WasObjctvMetWghtd_();
+    isObjctvMet = WasObjctvMetWghtd_();
   else {
     if (!rgn_->IsSecondPass())
-      return WasObjctvMetFrstPss_();
+      isObjctvMet = WasObjctvMetFrstPss_();
     else
-      return WasObjctvMetScndPss_();
+      isObjctvMet = WasObjctvMetScndPss_();
   }
+
+  // Also stop once the best schedule is close enough to the lower bound.
+  if (!isObjctvMet && rgn_->isOptimalityGapClosed())
+    isGapStop_ = true;
+  return isObjctvMet || isGapStop_;
 }
 /*****************************************************************************/
 
@@ -2222,6 +2658,18 @@ bool LengthCostEnumerator::ChkCostFsblty_(SchedInstruction *inst,
 
   costChkCnt_++;
 
+  // Try to rule out the branch before updating the region's register pressure
+  // state, which would only have to be undone.
+  if (prune_.spillCost && inst != NULL &&
+      !rgn_->ChkCostFsbltyBeforeSchdul(trgtSchedLngth_, inst, RPCost)) {
+    costPruneCnt_++;
+#ifdef IS_DEBUG_FLOW
+    Logger::Info("Detected cost infeasibility of inst %d in cycle %d",
+                 inst->GetNum(), crntCycleNum_);
+#endif
+    return false;
+  }
+
   rgn_->SchdulInst(inst, crntCycleNum_, crntSlotNum_, false);
 
   if (prune_.spillCost) {
@@ -2242,24 +2690,17 @@ bool LengthCostEnumerator::ChkCostFsblty_(SchedInstruction *inst,
 }
 /*****************************************************************************/
 
-bool LengthCostEnumerator::BackTrack_() {
+bool LengthCostEnumerator::BackTrack_(bool isSubProbExmnd) {
   SchedInstruction *inst = crntNode_->GetInst();
 
   rgn_->UnschdulInst(inst, crntCycleNum_, crntSlotNum_, crntNode_->GetParent());
 
-  bool fsbl = Enumerator::BackTrack_();
+  bool fsbl = Enumerator::BackTrack_(isSubProbExmnd);
 
   if (prune_.spillCost) {
     if (fsbl) {
       assert(crntNode_->GetCostLwrBound() >= 0);
-      if (!rgn_->isTwoPassEnabled())
-        fsbl = crntNode_->GetCostLwrBound() < GetBestCost_();
-      else {
-        if (!rgn_->IsSecondPass())
-          fsbl = crntNode_->getSpillCostLwrBound() < getBestSpillCost();
-        else
-          fsbl = crntNode_->getSpillCostLwrBound() <= getBestSpillCost();
-      }
+      fsbl = IsCostLwrBoundFsbl_(GetCrntCostLwrBound_());
     }
   }
 
@@ -2267,6 +2708,22 @@ bool LengthCostEnumerator::BackTrack_() {
 }
 /*****************************************************************************/
 
+InstCount LengthCostEnumerator::GetCrntCostLwrBound_() {
+  if (!rgn_->isTwoPassEnabled())
+    return crntNode_->GetCostLwrBound();
+  return crntNode_->getSpillCostLwrBound();
+}
+/*****************************************************************************/
+
+bool LengthCostEnumerator::IsCostLwrBoundFsbl_(InstCount costLwrBound) {
+  if (!rgn_->isTwoPassEnabled())
+    return costLwrBound < GetBestCost_();
+  if (!rgn_->IsSecondPass())
+    return costLwrBound < getBestSpillCost_();
+  return costLwrBound <= getBestSpillCost_();
+}
+/*****************************************************************************/
+
 InstCount LengthCostEnumerator::GetBestCost_() { return rgn_->GetBestCost(); }
 
 InstCount LengthCostEnumerator::getBestSpillCost_() {
@@ -7,7 +7,8 @@
 
 using namespace llvm::opt_sched;
 
-InstScheduler::InstScheduler(DataDepStruct *dataDepGraph, MachineModel *machMdl,
+InstScheduler::InstScheduler(DataDepStruct *dataDepGraph,
+                             const MachineModel *machMdl,
                              InstCount schedUprBound) {
   assert(dataDepGraph != NULL);
   assert(machMdl != NULL);
@@ -60,7 +61,7 @@ void ConstrainedScheduler::ResetRsrvSlots_() {
 }
 
 ConstrainedScheduler::ConstrainedScheduler(DataDepGraph *dataDepGraph,
-                                           MachineModel *machMdl,
+                                           const MachineModel *machMdl,
                                            InstCount schedUprBound)
     : InstScheduler(dataDepGraph, machMdl, schedUprBound) {
   dataDepGraph_ = dataDepGraph;
@@ -142,13 +143,14 @@ bool ConstrainedScheduler::Initialize_(InstCount trgtSchedLngth,
 }
 
 void ConstrainedScheduler::SchdulInst_(SchedInstruction *inst, InstCount) {
-  InstCount prdcsrNum, scsrRdyCycle;
+  InstCount scsrRdyCycle;
+  const GraphEdgeSpan &scsrs = inst->GetScsrSpan();
 
   // Notify each successor of this instruction that it has been scheduled.
-  for (SchedInstruction *crntScsr = inst->GetFrstScsr(&prdcsrNum);
-       crntScsr != NULL; crntScsr = inst->GetNxtScsr(&prdcsrNum)) {
+  for (UDT_GEDGES i = 0; i < scsrs.cnt; i++) {
+    SchedInstruction *crntScsr = (SchedInstruction *)scsrs.nodes[i];
     bool wasLastPrdcsr =
-        crntScsr->PrdcsrSchduld(prdcsrNum, crntCycleNum_, scsrRdyCycle);
+        crntScsr->PrdcsrSchduld(scsrs.ordrs[i], crntCycleNum_, scsrRdyCycle);
 
     if (wasLastPrdcsr) {
       // If all other predecessors of this successor have been scheduled then
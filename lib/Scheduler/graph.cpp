@@ -17,6 +17,9 @@ GraphNode::GraphNode(UDT_GNODES num, UDT_GNODES maxNodeCnt) {
   scsrLst_ = new PriorityList<GraphEdge>(maxNodeCnt);
   prdcsrLst_ = new LinkedList<GraphEdge>(maxNodeCnt);
 
+  scsrSpan_ = GraphEdgeSpan{NULL, NULL, NULL, NULL, 0};
+  prdcsrSpan_ = GraphEdgeSpan{NULL, NULL, NULL, NULL, 0};
+
   rcrsvScsrLst_ = NULL;
   rcrsvPrdcsrLst_ = NULL;
   isRcrsvScsr_ = NULL;
@@ -366,28 +369,35 @@ FUNC_RESULT DirAcycGraph::DepthFirstSearch() {
 
 FUNC_RESULT DirAcycGraph::FindRcrsvNghbrs(DIRECTION dir) {
   for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
-    GraphNode *node = nodes_[i];
+    FindRcrsvNghbrs(nodes_[i], dir);
+  }
 
-    // Set the colors of all nodes to white (not visited yet) before starting
-    // each recursive search.
-    for (UDT_GNODES j = 0; j < nodeCnt_; j++) {
-      nodes_[j]->SetColor(COL_WHITE);
-    }
+  if (cycleDetected_)
+    return RES_ERROR;
+  else
+    return RES_SUCCESS;
+}
 
-    node->AllocRcrsvInfo(dir, nodeCnt_);
+FUNC_RESULT DirAcycGraph::FindRcrsvNghbrs(GraphNode *node, DIRECTION dir) {
+  // Set the colors of all nodes to white (not visited yet) before starting
+  // each recursive search.
+  for (UDT_GNODES j = 0; j < nodeCnt_; j++) {
+    nodes_[j]->SetColor(COL_WHITE);
+  }
 
-    node->FindRcrsvNghbrs(dir, this);
+  node->AllocRcrsvInfo(dir, nodeCnt_);
 
-    assert((dir == DIR_FRWRD &&
-            node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == leaf_) ||
-           (dir == DIR_BKWRD &&
-            node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == root_) ||
-           node == root_ || node == leaf_);
-    assert(node != root_ ||
-           node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == nodeCnt_ - 1);
-    assert(node != leaf_ ||
-           node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == 0);
-  }
+  node->FindRcrsvNghbrs(dir, this);
+
+  assert((dir == DIR_FRWRD &&
+          node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == leaf_) ||
+         (dir == DIR_BKWRD &&
+          node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == root_) ||
+         node == root_ || node == leaf_);
+  assert(node != root_ ||
+         node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == nodeCnt_ - 1);
+  assert(node != leaf_ ||
+         node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == 0);
 
   if (cycleDetected_)
     return RES_ERROR;
@@ -395,6 +405,58 @@ FUNC_RESULT DirAcycGraph::FindRcrsvNghbrs(DIRECTION dir) {
     return RES_SUCCESS;
 }
 
+void DirAcycGraph::EdgeArrays::Resize(UDT_GEDGES edgeCnt) {
+  nodes.resize(edgeCnt);
+  lbls.resize(edgeCnt);
+  lbl2s.resize(edgeCnt);
+  ordrs.resize(edgeCnt);
+}
+
+GraphEdgeSpan DirAcycGraph::EdgeArrays::GetSpan(UDT_GEDGES bgn,
+                                                UDT_GEDGES end) const {
+  return GraphEdgeSpan{nodes.data() + bgn, lbls.data() + bgn,
+                       lbl2s.data() + bgn, ordrs.data() + bgn, end - bgn};
+}
+
+void DirAcycGraph::BuildEdgeArrays() {
+  UDT_GEDGES scsrTot = 0, prdcsrTot = 0;
+  for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
+    scsrTot += nodes_[i]->GetScsrCnt();
+    prdcsrTot += nodes_[i]->GetPrdcsrCnt();
+  }
+  assert(scsrTot == prdcsrTot);
+
+  scsrArrays_.Resize(scsrTot);
+  prdcsrArrays_.Resize(prdcsrTot);
+
+  UDT_GEDGES scsrBgn = 0, prdcsrBgn = 0;
+  for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
+    GraphNode *node = nodes_[i];
+
+    UDT_GEDGES j = scsrBgn;
+    for (GraphEdge &edge : *node->scsrLst_) {
+      scsrArrays_.nodes[j] = edge.to;
+      scsrArrays_.lbls[j] = edge.label;
+      scsrArrays_.lbl2s[j] = edge.label2;
+      scsrArrays_.ordrs[j] = edge.predOrder;
+      j++;
+    }
+    node->scsrSpan_ = scsrArrays_.GetSpan(scsrBgn, j);
+    scsrBgn = j;
+
+    j = prdcsrBgn;
+    for (GraphEdge &edge : *node->prdcsrLst_) {
+      prdcsrArrays_.nodes[j] = edge.from;
+      prdcsrArrays_.lbls[j] = edge.label;
+      prdcsrArrays_.lbl2s[j] = edge.label2;
+      prdcsrArrays_.ordrs[j] = edge.succOrder;
+      j++;
+    }
+    node->prdcsrSpan_ = prdcsrArrays_.GetSpan(prdcsrBgn, j);
+    prdcsrBgn = j;
+  }
+}
+
 void DirAcycGraph::Print(FILE *outFile) {
   fprintf(outFile, "Number of Nodes= %d    Number of Edges= %d\n", nodeCnt_,
           edgeCnt_);
@@ -6,7 +6,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include <algorithm>
-#include <list>
+#include <utility>
 #include <vector>
 
 // #define IS_DEBUG_GRAPH_TRANS
@@ -24,33 +24,27 @@ bool llvm::opt_sched::areNodesIndependent(const SchedInstruction *A,
   return A != B && !A->IsRcrsvPrdcsr(B) && !A->IsRcrsvScsr(B);
 }
 
-static void UpdateRecursiveNeighbors(SchedInstruction *A, SchedInstruction *B) {
-  // Update lists for the nodes themselves.
-  A->AddRcrsvScsr(B);
-  B->AddRcrsvPrdcsr(A);
-
-  for (GraphNode &X : *A->GetRecursivePredecessors()) {
-    if (!B->IsRcrsvPrdcsr(&X)) {
-      B->AddRcrsvPrdcsr(&X);
-      X.AddRcrsvScsr(B);
+static void UpdateRecursiveNeighbors(DataDepGraph &DDG, SchedInstruction *A,
+                                     SchedInstruction *B) {
+  // A and every recursive predecessor of A now reach B and every recursive
+  // successor of B. Find the pairs that are new a word at a time instead of
+  // testing every combination.
+  BitVector BAndScsrs(*B->GetRcrsvNghbrBitVector(DIR_FRWRD));
+  BAndScsrs.SetBit(B->GetNum());
+  BitVector NewScsrs(BAndScsrs.GetSize());
+
+  auto Connect = [&](GraphNode &X) {
+    NewScsrs.SetToAndNot(BAndScsrs, *X.GetRcrsvNghbrBitVector(DIR_FRWRD));
+    for (int Y = NewScsrs.FindFrstOne(); Y != -1; Y = NewScsrs.FindNxtOne(Y)) {
+      SchedInstruction *NodeY = DDG.GetInstByIndx(Y);
+      X.AddRcrsvScsr(NodeY);
+      NodeY->AddRcrsvPrdcsr(&X);
     }
-  }
-
-  for (GraphNode &Y : *B->GetRecursiveSuccessors()) {
-    if (!A->IsRcrsvScsr(&Y)) {
-      A->AddRcrsvScsr(&Y);
-      Y.AddRcrsvPrdcsr(A);
-    }
-  }
+  };
 
-  for (GraphNode &X : *A->GetRecursivePredecessors()) {
-    for (GraphNode &Y : *B->GetRecursiveSuccessors()) {
-      if (!X.IsRcrsvScsr(&Y)) {
-        Y.AddRcrsvPrdcsr(&X);
-        X.AddRcrsvScsr(&Y);
-      }
-    }
-  }
+  Connect(*A);
+  for (GraphNode &X : *A->GetRecursivePredecessors())
+    Connect(X);
 }
 
 GraphEdge *llvm::opt_sched::addSuperiorEdge(DataDepGraph &DDG,
@@ -58,7 +52,7 @@ GraphEdge *llvm::opt_sched::addSuperiorEdge(DataDepGraph &DDG,
                                             SchedInstruction *B, int latency) {
   GraphEdge *e = DDG.CreateEdge(A, B, latency, DEP_OTHER);
   e->IsArtificial = true;
-  UpdateRecursiveNeighbors(A, B);
+  UpdateRecursiveNeighbors(DDG, A, B);
 
   return e;
 }
@@ -74,6 +68,7 @@ StaticNodeSupTrans::StaticNodeSupTrans(DataDepGraph *dataDepGraph,
                                        bool IsMultiPass_)
     : GraphTrans(dataDepGraph) {
   IsMultiPass = IsMultiPass_;
+  ChngStamp = 0;
 }
 
 static GraphEdge *addRPSuperiorEdge(DataDepGraph &DDG, SchedInstruction *A,
@@ -96,14 +91,40 @@ GraphEdge *StaticNodeSupTrans::TryAddingSuperiorEdge_(SchedInstruction *nodeA,
   return nullptr;
 }
 
+void StaticNodeSupTrans::noteRcrsvNghbrChng_(GraphEdge *Edge) {
+  ++ChngStamp;
+
+  auto Stamp = [&](GraphNode &Node) {
+    UDT_GEDGES Cnt = Node.GetRcrsvPrdcsrCnt() + Node.GetRcrsvScsrCnt();
+    if (Cnt != NodeRcrsvNghbrCnts[Node.GetNum()]) {
+      NodeRcrsvNghbrCnts[Node.GetNum()] = Cnt;
+      NodeChngStamps[Node.GetNum()] = ChngStamp;
+    }
+  };
+
+  Stamp(*Edge->from);
+  for (GraphNode &X : *Edge->from->GetRecursivePredecessors())
+    Stamp(X);
+  Stamp(*Edge->to);
+  for (GraphNode &Y : *Edge->to->GetRecursiveSuccessors())
+    Stamp(Y);
+}
+
 FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
   InstCount numNodes = GetNumNodesInGraph_();
   DataDepGraph *graph = GetDataDepGraph_();
   // A list of independent nodes.
-  std::list<std::pair<SchedInstruction *, SchedInstruction *>> indepNodes;
+  std::vector<IndepPair> indepPairs;
   Statistics stats;
   Logger::Event("GraphTransRPNodeSuperiority");
 
+  NodeChngStamps.assign(numNodes, ChngStamp);
+  NodeRcrsvNghbrCnts.resize(numNodes);
+  for (int i = 0; i < numNodes; i++) {
+    SchedInstruction *inst = graph->GetInstByIndx(i);
+    NodeRcrsvNghbrCnts[i] = inst->GetRcrsvPrdcsrCnt() + inst->GetRcrsvScsrCnt();
+  }
+
   // For the first pass visit all nodes. Add sets of independent nodes to a
   // list.
   for (int i = 0; i < numNodes; i++) {
@@ -121,8 +142,10 @@ FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
         // nodes to a list for
         // future passes.
         if (!edge)
-          indepNodes.push_back(std::make_pair(nodeA, nodeB));
+          indepPairs.push_back({nodeA, nodeB, ChngStamp});
         else {
+          if (IsMultiPass)
+            noteRcrsvNghbrChng_(edge);
           stats.NumEdgesAdded++;
           removeRedundantEdges(*graph, edge->from->GetNum(), edge->to->GetNum(),
                                stats);
@@ -135,7 +158,7 @@ FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
                 stats.NumEdgesAdded, "removed_edges", stats.NumEdgesRemoved);
 
   if (IsMultiPass)
-    nodeMultiPass_(indepNodes);
+    nodeMultiPass_(std::move(indepPairs));
 
   return RES_SUCCESS;
 }
@@ -275,33 +298,38 @@ bool StaticNodeSupTrans::isNodeSuperior(DataDepGraph &DDG, int A, int B) {
                       [](int netLengthened) { return netLengthened <= 0; });
 }
 
-void StaticNodeSupTrans::nodeMultiPass_(
-    std::list<std::pair<SchedInstruction *, SchedInstruction *>> indepNodes) {
+void StaticNodeSupTrans::nodeMultiPass_(std::vector<IndepPair> IndepPairs) {
   Logger::Event("MultiPassGraphTransRPNodeSuperiority");
   // Try to add superior edges until there are no more independent nodes or no
-  // edges can be added.
+  // edges can be added. A pair whose nodes kept their recursive neighbors
+  // since it was last checked would fail the same way again, so each pass
+  // only rechecks the pairs touched by the edges added since.
   bool didAddEdge = true;
-  while (didAddEdge && indepNodes.size() > 0) {
-    std::list<std::pair<SchedInstruction *, SchedInstruction *>>::iterator
-        pair = indepNodes.begin();
+  while (didAddEdge && IndepPairs.size() > 0) {
     didAddEdge = false;
+    size_t keptCnt = 0;
 
-    while (pair != indepNodes.end()) {
-      SchedInstruction *nodeA = (*pair).first;
-      SchedInstruction *nodeB = (*pair).second;
+    for (size_t i = 0; i < IndepPairs.size(); i++) {
+      IndepPair &pair = IndepPairs[i];
 
-      if (!areNodesIndependent(nodeA, nodeB)) {
-        pair = indepNodes.erase(pair);
-      } else {
-        bool result = TryAddingSuperiorEdge_(nodeA, nodeB);
+      if (needsRechck_(pair)) {
+        if (!areNodesIndependent(pair.A, pair.B))
+          continue;
+
+        pair.ChckStamp = ChngStamp;
+        GraphEdge *edge = TryAddingSuperiorEdge_(pair.A, pair.B);
         // If a superior edge was added remove the pair of nodes from the list.
-        if (result) {
-          pair = indepNodes.erase(pair);
+        if (edge) {
+          noteRcrsvNghbrChng_(edge);
           didAddEdge = true;
-        } else
-          pair++;
+          continue;
+        }
       }
+
+      IndepPairs[keptCnt++] = pair;
     }
+
+    IndepPairs.resize(keptCnt);
   }
 }
 
@@ -318,11 +346,14 @@ static bool isRedundant(SchedInstruction *NodeI, SchedInstruction *NodeJ,
 }
 
 static LinkedList<GraphEdge>::iterator
-removeEdge(LinkedList<GraphEdge> &Succs, LinkedList<GraphEdge>::iterator it,
+removeEdge(DataDepGraph &DDG, LinkedList<GraphEdge> &Succs,
+           LinkedList<GraphEdge>::iterator it,
            StaticNodeSupTrans::Statistics &stats) {
   GraphEdge &e = *it;
   it = Succs.RemoveAt(it);
   e.to->RemovePredFrom(e.from);
+  DDG.NoteEdgeChange(static_cast<SchedInstruction *>(e.from),
+                     static_cast<SchedInstruction *>(e.to));
   DEBUG_LOG("  Deleting GraphEdge* at %p: (%zu, %zu)", (void *)&e,
             e.from->GetNum(), e.to->GetNum());
   delete &e;
@@ -343,7 +374,7 @@ void StaticNodeSupTrans::removeRedundantEdges(DataDepGraph &DDG, //
     LinkedList<GraphEdge> &ISuccs = NodeI->GetSuccessors();
     for (auto it = ISuccs.begin(); it != ISuccs.end();) {
       if (isRedundant(NodeI, NodeJ, *it)) {
-        it = removeEdge(ISuccs, it, stats);
+        it = removeEdge(DDG, ISuccs, it, stats);
       } else {
         ++it;
       }
@@ -358,7 +389,7 @@ void StaticNodeSupTrans::removeRedundantEdges(DataDepGraph &DDG, //
 
     for (auto it = PSuccs.begin(); it != PSuccs.end();) {
       if (isRedundant(NodeI, NodeJ, *it)) {
-        it = removeEdge(PSuccs, it, stats);
+        it = removeEdge(DDG, PSuccs, it, stats);
       } else {
         ++it;
       }
@@ -20,6 +20,13 @@ using namespace llvm::opt_sched;
 
 static constexpr auto SmallSize = StaticNodeSupILPTrans::SmallSize;
 
+static size_t castUnsigned(int x) {
+  assert(x >= 0); // sanity check
+  return size_t(x);
+}
+
+static size_t getNum(GraphNode *Node) { return castUnsigned(Node->GetNum()); }
+
 llvm::SmallVector<int, SmallSize>
 StaticNodeSupILPTrans::createDistanceTable(DataDepGraph &DDG) {
   const int NegativeInfinity = std::numeric_limits<int>::lowest();
@@ -37,18 +44,19 @@ StaticNodeSupILPTrans::createDistanceTable(DataDepGraph &DDG) {
       NegativeInfinity);
   MutableArrayRef2D<int> DistanceTable(DistanceTable_, NumNodes, NumNodes);
 
-  // DISTANCE(i, i) = 0
+  // DISTANCE(i, j) is the longest path from i to j saturated at MaxLatency,
+  // which the graph's relative critical path matrix already holds.
   for (size_t I = 0; I < NumNodes; ++I) {
     for (size_t J = 0; J < NumNodes; ++J) {
-      SchedInstruction *NodeI = DDG.GetInstByIndx(I);
-      SchedInstruction *NodeJ = DDG.GetInstByIndx(J);
+      const int Path = DDG.GetRltvCrtclPath(I, J);
+      if (Path != INVALID_VALUE)
+        DistanceTable[{I, J}] = std::min(Path, MaxLatency);
+    }
+  }
 
-      DistanceTable[{I, J}] =
-          NodeI->IsRcrsvScsr(NodeJ)
-              ? std::min(NodeJ->GetRltvCrtclPath(DIR_FRWRD, NodeI), MaxLatency)
-              : NegativeInfinity;
+  for (size_t I = 0; I < NumNodes; ++I) {
+    for (size_t J = 0; J < NumNodes; ++J)
       DEBUG_LOG(" DISTANCE(%d, %d) = %d", I, J, (DistanceTable[{I, J}]));
-    }
   }
 
   DEBUG_LOG("Finished creating DISTANCE() table\n");
@@ -56,13 +64,6 @@ StaticNodeSupILPTrans::createDistanceTable(DataDepGraph &DDG) {
   return DistanceTable_;
 }
 
-static size_t castUnsigned(int x) {
-  assert(x >= 0); // sanity check
-  return size_t(x);
-}
-
-static size_t getNum(GraphNode *Node) { return castUnsigned(Node->GetNum()); }
-
 static int computeSuperiorArrayValue(DataDepGraph &DDG,
                                      ArrayRef2D<int> DistanceTable, //
                                      const int i_, const int j_) {
@@ -269,37 +270,35 @@ void StaticNodeSupILPTrans::updateDistanceTable(Data &Data, int i_, int j_) {
   }
 
   const int MaxLatency = DDG.GetMaxLtncy();
+  const size_t NumNodes = DistanceTable.rows();
+
+  // The latency 0 edge (i, j) connects every p that reaches i (including i)
+  // to every k reachable from j (including j), so:
+  //   DISTANCE(p, k) = max(DISTANCE(p, k), DISTANCE(p, i) + DISTANCE(j, k))
+  // The table itself is used to find p and k. Unlike the graph's recursive
+  // neighbor lists, it already accounts for the superior edges added earlier
+  // in this transformation. Row j and column i don't change here, since that
+  // would require a cycle through (i, j).
+  llvm::SmallVector<size_t, SmallSize> JSuccessors;
+  for (size_t k = 0; k < NumNodes; ++k) {
+    if (DistanceTable[{j, k}] >= 0)
+      JSuccessors.push_back(k);
+  }
 
-  SchedInstruction *NodeI = DDG.GetInstByIndx(i);
-  SchedInstruction *NodeJ = DDG.GetInstByIndx(j);
+  for (size_t p = 0; p < NumNodes; ++p) {
+    const int DistanceToI = DistanceTable[{p, i}];
+    if (DistanceToI < 0)
+      continue;
+
+    for (size_t k : JSuccessors) {
+      const int OldDistance = DistanceTable[{p, k}];
+      const int NewDistance =
+          std::min(MaxLatency, DistanceToI + DistanceTable[{j, k}]);
 
-  LinkedList<GraphNode> *JSuccessors = NodeJ->GetRecursiveSuccessors();
-  LinkedList<GraphNode> *IPredecessors = NodeI->GetRecursivePredecessors();
-
-  for (GraphNode &Succ : *JSuccessors) {
-    const size_t k = getNum(&Succ);
-    const int OldDistance = DistanceTable[{i, k}];
-    // The "new" DISTANCE(i, k) = DISTANCE(j, k) because we added a latency 0
-    // edge (i, j), but only if this "new distance" is larger.
-    const int NewDistance = std::min(MaxLatency, DistanceTable[{j, k}]);
-
-    if (NewDistance > OldDistance) {
-      DEBUG_LOG("  Increased DISTANCE(%d, %d) = %d (old = %d)", i, k,
-                NewDistance, OldDistance);
-      setDistanceTable(Data, i, k, NewDistance);
-
-      for (GraphNode &Pred : *IPredecessors) {
-        const size_t p = getNum(&Pred);
-        const int NewPossiblePK =
-            std::min(MaxLatency, NewDistance + DistanceTable[{p, i}]);
-        const int OldPK = DistanceTable[{p, k}];
-
-        if (NewPossiblePK > OldPK) {
-          DEBUG_LOG("   Increased (i, k) distance resulted in increased "
-                    "DISTANCE(%d, %d) = %d (old = %d)",
-                    p, k, NewPossiblePK, OldPK);
-          setDistanceTable(Data, p, k, NewPossiblePK);
-        }
+      if (NewDistance > OldDistance) {
+        DEBUG_LOG("  Increased DISTANCE(%d, %d) = %d (old = %d)", p, k,
+                  NewDistance, OldDistance);
+        setDistanceTable(Data, p, k, NewDistance);
       }
     }
   }
@@ -336,11 +335,14 @@ static bool isRedundant(SchedInstruction *NodeI, SchedInstruction *NodeJ,
 }
 
 static LinkedList<GraphEdge>::iterator
-removeEdge(LinkedList<GraphEdge> &Succs, LinkedList<GraphEdge>::iterator it,
+removeEdge(DataDepGraph &DDG, LinkedList<GraphEdge> &Succs,
+           LinkedList<GraphEdge>::iterator it,
            StaticNodeSupILPTrans::Statistics &stats) {
   GraphEdge &e = *it;
   it = Succs.RemoveAt(it);
   e.to->RemovePredFrom(e.from);
+  DDG.NoteEdgeChange(static_cast<SchedInstruction *>(e.from),
+                     static_cast<SchedInstruction *>(e.to));
   DEBUG_LOG("  Deleting GraphEdge* at %p: (%zu, %zu)", (void *)&e,
             e.from->GetNum(), e.to->GetNum());
   delete &e;
@@ -363,7 +365,7 @@ void StaticNodeSupILPTrans::removeRedundantEdges(DataDepGraph &DDG,
     LinkedList<GraphEdge> &ISuccs = NodeI->GetSuccessors();
     for (auto it = ISuccs.begin(); it != ISuccs.end();) {
       if (isRedundant(NodeI, NodeJ, DistanceTable, *it)) {
-        it = removeEdge(ISuccs, it, stats);
+        it = removeEdge(DDG, ISuccs, it, stats);
       } else {
         ++it;
       }
@@ -378,7 +380,7 @@ void StaticNodeSupILPTrans::removeRedundantEdges(DataDepGraph &DDG,
 
     for (auto it = PSuccs.begin(); it != PSuccs.end();) {
       if (isRedundant(NodeI, NodeJ, DistanceTable, *it)) {
-        it = removeEdge(PSuccs, it, stats);
+        it = removeEdge(DDG, PSuccs, it, stats);
       } else {
         ++it;
       }
@@ -20,6 +20,7 @@ void HistEnumTreeNode::Construct(EnumTreeNode *node, bool) {
 
   time_ = node->time_;
   inst_ = node->inst_;
+  trgtLngth_ = node->enumrtr_->trgtSchedLngth_;
 
 #ifdef IS_DEBUG
   isCnstrctd_ = true;
@@ -52,6 +53,7 @@ void HistEnumTreeNode::SetRsrvSlots_(EnumTreeNode *node) {
 void HistEnumTreeNode::Init_() {
   time_ = 0;
   inst_ = NULL;
+  trgtLngth_ = INVALID_VALUE;
   prevNode_ = NULL;
 #ifdef IS_DEBUG
   isCnstrctd_ = false;
@@ -125,16 +127,15 @@ void HistEnumTreeNode::SetLwrBounds_(InstCount lwrBounds[],
     // If an instruction is scheduled after its static lower bound then its
     // successors will potentially be pushed down and should be checked.
     if (inst != NULL && cycleNum > inst->GetLwrBound(DIR_FRWRD)) {
-      UDT_GLABEL ltncy;
-      DependenceType depType;
+      const GraphEdgeSpan &scsrs = inst->GetScsrSpan();
 
       // Examine all the unscheduled successors of this instruction
       // to see if any of them is pushed down.
-      for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
-           scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+      for (UDT_GEDGES i = 0; i < scsrs.cnt; i++) {
+        SchedInstruction *scsr = (SchedInstruction *)scsrs.nodes[i];
         if (scsr->IsSchduld() == false) {
           InstCount num = scsr->GetNum();
-          InstCount thisBound = cycleNum + ltncy;
+          InstCount thisBound = cycleNum + scsrs.lbls[i];
           if (thisBound > lwrBounds[num])
             lwrBounds[num] = thisBound;
         }
@@ -198,6 +199,16 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
   if (othrCrntCycleBlkd != crntCycleBlkd_)
     return false;
 
+  // With a shift, the other node's remaining instructions are moved shft
+  // cycles earlier. They must land after the last cycle of this node, whose
+  // free slots may not match theirs.
+  if (shft > 0) {
+    InstCount othrNxtCycle = enumrtr->GetCycleNumFrmTime_(othrTime + 1);
+    if (enumrtr->GetCycleNumFrmTime_(thisTime) + shft >= othrNxtCycle ||
+        rsrvSlots_ != NULL)
+      return false;
+  }
+
   if (rsrvSlots_ != NULL) {
     if (node->rsrvSlots_ == NULL)
       return false;
@@ -214,7 +225,7 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
 
   bool isAbslutDmnnt = true;
 
-  if (enumrtr->getIsSecondPass()) {
+  if (enumrtr->getIsSecondPass() || shft > 0) {
     InstCount entryCnt;
     InstCount minTimeToExmn = GetMinTimeToExmn_(thisTime, enumrtr);
 
@@ -239,17 +250,16 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
       // successors will potentially be pushed down and should be checked.
       if (inst != NULL &&
           (cycleNum > inst->GetLwrBound(DIR_FRWRD) || shft > 0)) {
-        UDT_GLABEL ltncy;
-        DependenceType depType;
+        const GraphEdgeSpan &scsrs = inst->GetScsrSpan();
 
         // Examine all the unscheduled successors of this instruction to see if
         // any of them is pushed down.
-        for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
-             scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+        for (UDT_GEDGES i = 0; i < scsrs.cnt; i++) {
+          SchedInstruction *scsr = (SchedInstruction *)scsrs.nodes[i];
           if (scsr->IsSchduld() == false) {
             InstCount nxtAvlblCycle = nxtAvlblCycles[scsr->GetIssueType()];
             InstCount num = scsr->GetNum();
-            InstCount thisBound = cycleNum + ltncy;
+            InstCount thisBound = cycleNum + scsrs.lbls[i];
             thisBound = std::max(thisBound, nxtAvlblCycle);
             InstCount sttcBound = scsr->GetLwrBound(DIR_FRWRD);
             InstCount normBound = std::max(sttcBound, nxtAvlblCycle);
@@ -288,7 +298,7 @@ void HistEnumTreeNode::CmputNxtAvlblCycles_(Enumerator *enumrtr,
   InstCount time;
   InstCount cycleNum = crntCycle;
 
-  MachineModel *machMdl = enumrtr->machMdl_;
+  const MachineModel *machMdl = enumrtr->machMdl_;
   int issuTypeCnt = machMdl->GetIssueTypeCnt();
 
   for (int i = 0; i < issuTypeCnt; i++) {
@@ -296,10 +306,10 @@ void HistEnumTreeNode::CmputNxtAvlblCycles_(Enumerator *enumrtr,
     nxtAvlblCycles[i] = crntCycle;
   }
 
+  // Stop at the root, which has no instruction.
   for (crntNode = this, time = thisTime;
-       crntNode != NULL && cycleNum == crntCycle;
+       crntNode->prevNode_ != NULL && cycleNum == crntCycle;
        crntNode = crntNode->prevNode_, time--) {
-    assert(crntNode->prevNode_ != NULL);
     SchedInstruction *inst = crntNode->inst_;
     cycleNum = enumrtr->GetCycleNumFrmTime_(time);
 
@@ -413,7 +423,16 @@ bool CostHistEnumTreeNode::DoesDominate(EnumTreeNode *node,
 #endif
   assert(enumrtr->IsCostEnum());
 
-  InstCount shft = 0;
+  auto *LCE = static_cast<LengthCostEnumerator *>(enumrtr);
+
+  // A history node kept from a shorter target length only covers the
+  // schedules of nodes that are behind it by at least the length difference.
+  // The first pass of the two-pass mode does not tighten the lower bounds
+  // needed to tell.
+  InstCount shft = LCE->getTrgtLngth() - trgtLngth_;
+  assert(shft >= 0);
+  if (shft > 0 && LCE->getIsTwoPass() && !LCE->getIsSecondPass())
+    return false;
 
   // If the history node does not dominate the current node, we cannot
   // draw any conclusion and no pruning can be done.
@@ -426,10 +445,12 @@ bool CostHistEnumTreeNode::DoesDominate(EnumTreeNode *node,
   if (isLngthFsbl_ == false)
     return true;
 
+  if (shft > 0)
+    return chkCostDmntnForShft(node, LCE);
+
   // if the hist node dominates the current node, and the hist node
   // had at least one feasible sched below it, domination will be
   // determined by the cost domination condition
-  auto *LCE = static_cast<LengthCostEnumerator *>(enumrtr);
   return ChkCostDmntn_(node, LCE, shft);
 }
 
@@ -609,6 +630,25 @@ bool CostHistEnumTreeNode::chkCostDmntnForSinglePass(EnumTreeNode *Node,
   return ShouldPrune;
 }
 
+// Should we prune the other node, which is at a longer target length, based on
+// RP cost. Each of its schedules maps to a schedule of this node that is
+// shorter and has the same suffix. None of those improved on the best cost.
+// For the peak cost functions, a prefix with at least this node's spill cost
+// cannot improve on them either, whatever the length.
+bool CostHistEnumTreeNode::chkCostDmntnForShft(EnumTreeNode *Node,
+                                               LengthCostEnumerator *LCE) {
+#ifdef IS_DEBUG
+  assert(costInfoSet_);
+#endif
+
+  SPILL_COST_FUNCTION SpillCostFunc = LCE->GetSpillCostFunc();
+  if (SpillCostFunc != SCF_TARGET && SpillCostFunc != SCF_PRP &&
+      SpillCostFunc != SCF_PERP)
+    return false;
+
+  return Node->getSpillCost() >= PartialSpillCost_;
+}
+
 void CostHistEnumTreeNode::SetCostInfo(EnumTreeNode *node, bool, Enumerator *) {
   cost_ = node->GetCost();
   peakSpillCost_ = node->GetPeakSpillCost();
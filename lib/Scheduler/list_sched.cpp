@@ -4,10 +4,13 @@
 #include "opt-sched/Scheduler/ready_list.h"
 #include "opt-sched/Scheduler/sched_region.h"
 #include "opt-sched/Scheduler/stats.h"
+#include <algorithm>
+#include <utility>
 
 using namespace llvm::opt_sched;
 
-ListScheduler::ListScheduler(DataDepGraph *dataDepGraph, MachineModel *machMdl,
+ListScheduler::ListScheduler(DataDepGraph *dataDepGraph,
+                             const MachineModel *machMdl,
                              InstCount schedUprBound, SchedPriorities prirts)
     : ConstrainedScheduler(dataDepGraph, machMdl, schedUprBound) {
   crntSched_ = NULL;
@@ -84,7 +87,7 @@ FUNC_RESULT ListScheduler::FindSchedule(InstSchedule *sched, SchedRegion *rgn) {
 }
 
 SequentialListScheduler::SequentialListScheduler(DataDepGraph *dataDepGraph,
-                                                 MachineModel *machMdl,
+                                                 const MachineModel *machMdl,
                                                  InstCount schedUprBound,
                                                  SchedPriorities prirts)
     : ListScheduler(dataDepGraph, machMdl, schedUprBound, prirts) {}
@@ -159,8 +162,8 @@ void ListScheduler::UpdtRdyLst_(InstCount cycleNum, int slotNum) {
 }
 
 StallSchedulingListScheduler::StallSchedulingListScheduler(
-    DataDepGraph *dataDepGraph, MachineModel *machMdl, InstCount schedUprBound,
-    SchedPriorities prirts)
+    DataDepGraph *dataDepGraph, const MachineModel *machMdl,
+    InstCount schedUprBound, SchedPriorities prirts)
     : ListScheduler(dataDepGraph, machMdl, schedUprBound, prirts) {}
 
 SchedInstruction *StallSchedulingListScheduler::PickInst() const {
@@ -190,3 +193,61 @@ SchedInstruction *StallSchedulingListScheduler::PickInst() const {
 
   return ChkInstLglty_(inst) ? inst : nullptr;
 }
+
+InterleavingListScheduler::InterleavingListScheduler(
+    DataDepGraph *dataDepGraph, const MachineModel *machMdl,
+    InstCount schedUprBound, SchedPriorities prirts,
+    const std::vector<std::vector<InstCount>> &parts,
+    std::vector<InstCount> prefCycles)
+    : ListScheduler(dataDepGraph, machMdl, schedUprBound, prirts),
+      prefCycles_(std::move(prefCycles)),
+      prevInPart_(dataDepGraph->GetInstCnt()) {
+  for (const std::vector<InstCount> &part : parts) {
+    std::vector<InstCount> order(part);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](InstCount a, InstCount b) {
+                       return prefCycles_[a] < prefCycles_[b];
+                     });
+
+    // order[prevCycleStart, crntCycleStart) are the instructions of the cycle
+    // before the one of order[i].
+    size_t prevCycleStart = 0, crntCycleStart = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+      if (i > 0 && prefCycles_[order[i]] != prefCycles_[order[i - 1]]) {
+        prevCycleStart = crntCycleStart;
+        crntCycleStart = i;
+      }
+      prevInPart_[order[i]].assign(order.begin() + prevCycleStart,
+                                   order.begin() + crntCycleStart);
+    }
+  }
+}
+
+bool InterleavingListScheduler::ChkInstLglty_(SchedInstruction *inst) const {
+  for (InstCount prev : prevInPart_[inst->GetNum()])
+    if (crntSched_->GetSchedCycle(prev) == SCHD_UNSCHDULD)
+      return false;
+
+  return ListScheduler::ChkInstLglty_(inst);
+}
+
+SchedInstruction *InterleavingListScheduler::PickInst() const {
+  SchedInstruction *bestInst = NULL;
+  for (SchedInstruction *inst = rdyLst_->GetNextPriorityInst(); inst != NULL;
+       inst = rdyLst_->GetNextPriorityInst()) {
+    if (ChkInstLglty_(inst) &&
+        (bestInst == NULL ||
+         prefCycles_[inst->GetNum()] < prefCycles_[bestInst->GetNum()]))
+      bestInst = inst;
+  }
+
+  // Leave the iterator at the picked instruction, which is the one the caller
+  // removes from the ready list.
+  rdyLst_->ResetIterator();
+  if (bestInst != NULL) {
+    SchedInstruction *inst = rdyLst_->GetNextPriorityInst();
+    while (inst != bestInst)
+      inst = rdyLst_->GetNextPriorityInst();
+  }
+  return bestInst;
+}
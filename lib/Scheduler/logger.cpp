@@ -24,6 +24,9 @@ static const int MAX_MSGSIZE = 8000;
 // The current output stream.
 static std::ostream *logStream = &std::cerr;
 
+// The number of live Logger::Silence instances.
+static int silenceDepth = 0;
+
 // The periodic logging callback.
 static void (*periodLogCallback)() = NULL;
 // The minimum length of (CPU) time between two calls to the periodic logging
@@ -38,6 +41,10 @@ static Milliseconds periodLogLastTime = 0;
 static void Output(Logger::LOG_LEVEL level, bool timed, const char *message) {
   const char *title = 0;
 
+  if (silenceDepth > 0 &&
+      (level == Logger::INFO || level == Logger::SUMMARY))
+    return;
+
   switch (level) {
   case Logger::FATAL:
     title = "FATAL";
@@ -65,6 +72,10 @@ static void Output(Logger::LOG_LEVEL level, bool timed, const char *message) {
 
 void Logger::SetLogStream(std::ostream &out) { logStream = &out; }
 
+Logger::Silence::Silence() { silenceDepth++; }
+
+Logger::Silence::~Silence() { silenceDepth--; }
+
 std::ostream &Logger::GetLogStream() { return *logStream; }
 
 void Logger::RegisterPeriodicLogger(Milliseconds period, void (*callback)()) {
@@ -124,6 +135,9 @@ using Logger::detail::EventAttrValue;
 
 void Logger::detail::Event(
     const std::pair<EventAttrType, EventAttrValue> *attrs, size_t numAttrs) {
+  if (silenceDepth > 0)
+    return;
+
   std::ostream &out = *logStream;
 
   // We alternate using ": " and ", " as the separators.
@@ -3,15 +3,23 @@
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/utilities.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace llvm::opt_sched;
 
-ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
+ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts,
+                     bool useRdyBits) {
   prirts_ = prirts;
+  dataDepGraph_ = dataDepGraph;
   int i;
   uint16_t totKeyBits = 0;
 
+  useRdyBits_ = useRdyBits && !prirts_.isDynmc;
+  itrtrRank_ = INVALID_VALUE;
+  if (useRdyBits_)
+    rdyBits_.Construct(dataDepGraph->GetInstCnt());
+
   // Initialize an array of KeyedEntry if a dynamic heuristic is used. This
   // enable fast updating for dynamic heuristics.
   if (prirts_.isDynmc) {
@@ -121,13 +129,23 @@ ReadyList::~ReadyList() { Reset(); }
 void ReadyList::Reset() {
   prirtyLst_.Reset();
   latestSubLst_.Reset();
+  rdyBits_.Reset();
+  itrtrRank_ = INVALID_VALUE;
 }
 
 void ReadyList::CopyList(ReadyList *otherList) {
-  assert(prirtyLst_.GetElmntCnt() == 0);
+  assert(GetInstCnt() == 0);
   assert(latestSubLst_.GetElmntCnt() == 0);
   assert(otherList != NULL);
 
+  if (useRdyBits_) {
+    assert(otherList->useRdyBits_);
+    prirtyOrdr_ = otherList->prirtyOrdr_;
+    rdyBits_ = otherList->rdyBits_;
+    itrtrRank_ = otherList->itrtrRank_;
+    return;
+  }
+
   // Copy the ready list and create the array of keyed entries. If a dynamic
   // heuristic is not used then the second parameter should be an empty array.
   prirtyLst_.CopyList(&otherList->prirtyLst_, keyedEntries_);
@@ -167,7 +185,10 @@ unsigned long ReadyList::CmputKey_(SchedInstruction *inst, bool isUpdate,
     case LSH_NID:
     case LSH_LLVM:
       AddPrirtyToKey_(key, keySize, nodeID_Bits_,
-                      maxNodeID_ - inst->GetNodeID(), maxNodeID_);
+                      maxNodeID_ - (tieBreakOrder_ == nullptr
+                                        ? inst->GetNodeID()
+                                        : tieBreakOrder_[inst->GetNum()]),
+                      maxNodeID_);
       break;
 
     case LSH_ISO:
@@ -197,18 +218,16 @@ void ReadyList::AddLatestSubLists(LinkedList<SchedInstruction> *lst1,
     AddLatestSubList_(lst1);
   if (lst2 != NULL)
     AddLatestSubList_(lst2);
-  prirtyLst_.ResetIterator();
+  ResetIterator();
 }
 
 void ReadyList::Print(std::ostream &out) {
   out << "Ready List: ";
-  for (const auto *crntInst = prirtyLst_.GetFrstElmnt(); crntInst != NULL;
-       crntInst = prirtyLst_.GetNxtElmnt()) {
-    out << " " << crntInst->GetNum();
-  }
+  ForEachReadyInstruction(
+      [&out](const SchedInstruction &inst) { out << " " << inst.GetNum(); });
   out << '\n';
 
-  prirtyLst_.ResetIterator();
+  ResetIterator();
 }
 
 void ReadyList::AddLatestSubList_(LinkedList<SchedInstruction> *lst) {
@@ -259,9 +278,21 @@ void ReadyList::RemoveLatestSubList() {
 #endif
 }
 
-void ReadyList::ResetIterator() { prirtyLst_.ResetIterator(); }
+void ReadyList::ResetIterator() {
+  prirtyLst_.ResetIterator();
+  itrtrRank_ = INVALID_VALUE;
+}
 
 void ReadyList::AddInst(SchedInstruction *inst) {
+  if (useRdyBits_) {
+    if (!prirtyOrdr_)
+      BuildPrirtyOrdr_();
+    rdyBits_.SetBit(prirtyOrdr_->ranks[inst->GetNum()]);
+    // Like an insertion into the priority list, this resets the iterator.
+    itrtrRank_ = INVALID_VALUE;
+    return;
+  }
+
   bool changed;
   unsigned long key = CmputKey_(inst, false, changed);
   assert(changed == true);
@@ -281,17 +312,33 @@ void ReadyList::AddList(LinkedList<SchedInstruction> *lst) {
       AddInst(crntInst);
     }
 
-  prirtyLst_.ResetIterator();
+  ResetIterator();
 }
 
-InstCount ReadyList::GetInstCnt() const { return prirtyLst_.GetElmntCnt(); }
+InstCount ReadyList::GetInstCnt() const {
+  return useRdyBits_ ? rdyBits_.GetOneCnt() : prirtyLst_.GetElmntCnt();
+}
 
 SchedInstruction *ReadyList::GetNextPriorityInst() {
-  return prirtyLst_.GetNxtPriorityElmnt();
+  unsigned long key;
+  return GetNextPriorityInst(key);
 }
 
 SchedInstruction *ReadyList::GetNextPriorityInst(unsigned long &key) {
-  return prirtyLst_.GetNxtPriorityElmnt(key);
+  if (!useRdyBits_)
+    return prirtyLst_.GetNxtPriorityElmnt(key);
+
+  // Past the end, the iterator stays put until it is reset.
+  if (itrtrRank_ == rdyBits_.GetSize())
+    return NULL;
+  InstCount rank = rdyBits_.FindNxtOne(itrtrRank_);
+  if (rank == -1) {
+    itrtrRank_ = rdyBits_.GetSize();
+    return NULL;
+  }
+  itrtrRank_ = rank;
+  key = prirtyOrdr_->keys[rank];
+  return prirtyOrdr_->insts[rank];
 }
 
 void ReadyList::UpdatePriorities() {
@@ -308,10 +355,66 @@ void ReadyList::UpdatePriorities() {
   }
 }
 
-void ReadyList::RemoveNextPriorityInst() { prirtyLst_.RmvCrntElmnt(); }
+void ReadyList::RecomputeKeys() {
+  llvm::SmallVector<SchedInstruction *, 16> insts;
+  ForEachReadyInstruction([&insts](const SchedInstruction &inst) {
+    insts.push_back(const_cast<SchedInstruction *>(&inst));
+  });
+
+  prirtyLst_.Reset();
+  rdyBits_.Reset();
+  // Copies made before keep the old order.
+  prirtyOrdr_.reset();
+  for (SchedInstruction *inst : insts)
+    AddInst(inst);
+  ResetIterator();
+}
+
+void ReadyList::RemoveNextPriorityInst() {
+  if (!useRdyBits_) {
+    prirtyLst_.RmvCrntElmnt();
+    return;
+  }
+
+  // The iterator stays at the removed rank, so the next call returns the
+  // instruction that followed it.
+  assert(itrtrRank_ != INVALID_VALUE && rdyBits_.GetBit(itrtrRank_));
+  rdyBits_.SetBit(itrtrRank_, false);
+}
 
 bool ReadyList::FindInst(SchedInstruction *inst, int &hitCnt) {
-  return prirtyLst_.FindElmnt(inst, hitCnt);
+  if (!useRdyBits_)
+    return prirtyLst_.FindElmnt(inst, hitCnt);
+
+  hitCnt = prirtyOrdr_ && rdyBits_.GetBit(prirtyOrdr_->ranks[inst->GetNum()]);
+  return hitCnt > 0;
+}
+
+void ReadyList::BuildPrirtyOrdr_() {
+  auto ordr = std::make_shared<PrirtyOrdr>();
+  const InstCount instCnt = dataDepGraph_->GetInstCnt();
+  std::vector<unsigned long> keys(instCnt);
+  ordr->insts.resize(instCnt);
+
+  for (InstCount i = 0; i < instCnt; i++) {
+    bool changed;
+    ordr->insts[i] = dataDepGraph_->GetInstByIndx(i);
+    keys[i] = CmputKey_(ordr->insts[i], false, changed);
+  }
+  std::stable_sort(ordr->insts.begin(), ordr->insts.end(),
+                   [&keys](SchedInstruction *a, SchedInstruction *b) {
+                     return keys[a->GetNum()] > keys[b->GetNum()];
+                   });
+
+  ordr->keys.resize(instCnt);
+  ordr->ranks.resize(instCnt);
+  for (InstCount rank = 0; rank < instCnt; rank++) {
+    InstCount num = ordr->insts[rank]->GetNum();
+    ordr->keys[rank] = keys[num];
+    ordr->ranks[num] = rank;
+  }
+
+  prirtyOrdr_ = std::move(ordr);
 }
 
 void ReadyList::AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
@@ -102,32 +102,44 @@ int Register::GetConflictCnt() const { return conflicts_.GetOneCnt(); }
 bool Register::IsSpillCandidate() const { return isSpillCnddt_; }
 
 bool Register::AddToInterval(const SchedInstruction *inst) {
-  return liveIntervalSet_.insert(inst).second;
+  if (liveIntervalSet_.GetBit(inst->GetNum()))
+    return false;
+  liveIntervalSet_.SetBit(inst->GetNum());
+  return true;
 }
 
-bool Register::IsInInterval(const SchedInstruction *inst) const {
-  return liveIntervalSet_.count(inst) != 0;
+int Register::AddToInterval(const BitVector &insts) {
+  int oldCnt = liveIntervalSet_.GetOneCnt();
+  liveIntervalSet_.OrWith(insts);
+  return liveIntervalSet_.GetOneCnt() - oldCnt;
 }
 
-const Register::InstSetType &Register::GetLiveInterval() const {
-  return liveIntervalSet_;
+bool Register::IsInInterval(const SchedInstruction *inst) const {
+  return liveIntervalSet_.GetSize() > 0 &&
+         liveIntervalSet_.GetBit(inst->GetNum());
 }
 
+const BitVector &Register::GetLiveInterval() const { return liveIntervalSet_; }
+
 bool Register::AddToPossibleInterval(const SchedInstruction *inst) {
-  return possibleLiveIntervalSet_.insert(inst).second;
+  if (possibleLiveIntervalSet_.GetBit(inst->GetNum()))
+    return false;
+  possibleLiveIntervalSet_.SetBit(inst->GetNum());
+  return true;
 }
 
 bool Register::IsInPossibleInterval(const SchedInstruction *inst) const {
-  return possibleLiveIntervalSet_.count(inst) != 0;
+  return possibleLiveIntervalSet_.GetSize() > 0 &&
+         possibleLiveIntervalSet_.GetBit(inst->GetNum());
 }
 
-const Register::InstSetType &Register::GetPossibleLiveInterval() const {
+const BitVector &Register::GetPossibleLiveInterval() const {
   return possibleLiveIntervalSet_;
 }
 
-void Register::resetLiveInterval() {
-  liveIntervalSet_.clear();
-  possibleLiveIntervalSet_.clear();
+void Register::resetLiveInterval(int instCnt) {
+  liveIntervalSet_.Construct(instCnt);
+  possibleLiveIntervalSet_.Construct(instCnt);
 }
 
 Register::Register(int16_t type, int num, int physicalNumber) {
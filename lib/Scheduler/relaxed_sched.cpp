@@ -2,11 +2,12 @@
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/utilities.h"
 #include <algorithm>
+#include <numeric>
 
 using namespace llvm::opt_sched;
 
 RelaxedScheduler::RelaxedScheduler(DataDepStruct *dataDepGraph,
-                                   MachineModel *machMdl,
+                                   const MachineModel *machMdl,
                                    InstCount schedUprBound, DIRECTION mainDir,
                                    RLXD_SCHED_TYPE schedType,
                                    InstCount maxInstCnt)
@@ -41,11 +42,15 @@ RelaxedScheduler::RelaxedScheduler(DataDepStruct *dataDepGraph,
 
   for (InstCount i = 0; i < issuTypeCnt_; i++) {
     avlblSlots_[i] = new int16_t[schedUprBound_];
-    nxtAvlblCycles_[i] = new InstCount[schedUprBound_];
+    nxtAvlblCycles_[i] = new InstCount[schedUprBound_ + 1];
+    nxtAvlblCycles_[i][schedUprBound_] = schedUprBound_;
   }
 
   isFxd_ = NULL;
 
+  // The slot arrays start out uninitialized.
+  dirtyCycleEnd_ = schedUprBound_;
+
   if (useFxng_) {
     isFxd_ = new bool[maxInstCnt_];
 
@@ -99,11 +104,20 @@ void RelaxedScheduler::Reset_(InstCount startIndx) {
   fxdInstCnt_ = 0;
   schduldInstCnt_ = 0;
 
-  for (int i = 0; i < issuTypeCnt_; i++) {
-    for (InstCount j = startIndx; j < schedUprBound_; j++) {
-      avlblSlots_[i][j] = (int16_t)slotsPerTypePerCycle_[i];
-      nxtAvlblCycles_[i][j] = j;
+  // Only the cycles up to the last one in which a slot was taken need to be
+  // reset. The LC scheduler resets once per instruction, and its subgraphs
+  // often use only a few cycles of the absolute upper bound.
+  InstCount endIndx = std::min(dirtyCycleEnd_, schedUprBound_);
+
+  if (startIndx < endIndx) {
+    for (int i = 0; i < issuTypeCnt_; i++) {
+      std::fill(avlblSlots_[i] + startIndx, avlblSlots_[i] + endIndx,
+                (int16_t)slotsPerTypePerCycle_[i]);
+      std::iota(nxtAvlblCycles_[i] + startIndx, nxtAvlblCycles_[i] + endIndx,
+                startIndx);
     }
+
+    dirtyCycleEnd_ = startIndx;
   }
 
   instLst_->ResetIterator();
@@ -121,17 +135,9 @@ InstCount RelaxedScheduler::SchdulInst_(SchedInstruction *inst,
   IssueType issuType = inst->GetIssueType();
   assert(0 <= issuType && issuType < issuTypeCnt_);
 
-  InstCount schedCycle = nxtAvlblCycles_[issuType][releaseTime];
-  assert(minCycle <= schedCycle && schedCycle < schedUprBound_);
-
-  if (avlblSlots_[issuType][schedCycle] == 0) {
-    schedCycle = FindNxtAvlblCycle_(issuType, schedCycle + 1);
-  }
-
+  InstCount schedCycle = FindNxtAvlblCycle_(issuType, releaseTime);
   assert(minCycle <= schedCycle && schedCycle < schedUprBound_);
-  nxtAvlblCycles_[issuType][releaseTime] = schedCycle;
-  assert(avlblSlots_[issuType][schedCycle] > 0);
-  avlblSlots_[issuType][schedCycle]--;
+  TakeSlot_(issuType, schedCycle);
   assert(schedCycle >= releaseTime);
   return schedCycle;
 }
@@ -188,32 +194,15 @@ void RelaxedScheduler::SetCrntLwrBound_(SchedInstruction *inst, DIRECTION dir,
 InstCount RelaxedScheduler::PropagateLwrBound_(SchedInstruction *inst,
                                                DIRECTION dir) {
   InstCount crntBound = GetCrntLwrBound_(inst, dir);
+  const GraphEdgeSpan &nghbrs = inst->GetNghbrSpan(dir);
 
-  UDT_GLABEL ltncy;
-  DependenceType depType;
-  SchedInstruction *pred;
-  SchedInstruction *scsr;
-
-  if (dir == DIR_FRWRD) {
-    for (pred = inst->GetFrstPrdcsr(NULL, &ltncy, &depType); pred != NULL;
-         pred = inst->GetNxtPrdcsr(NULL, &ltncy, &depType)) {
-      if (dataDepGraph_->IsInGraph(pred)) {
-        InstCount predBound = GetCrntLwrBound_(pred, dir);
-
-        if ((predBound + ltncy) > crntBound) {
-          crntBound = predBound + ltncy;
-        }
-      }
-    }
-  } else {
-    for (scsr = inst->GetFrstScsr(NULL, &ltncy, &depType); scsr != NULL;
-         scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
-      if (dataDepGraph_->IsInGraph(scsr)) {
-        InstCount scsrBound = GetCrntLwrBound_(scsr, dir);
+  for (UDT_GEDGES i = 0; i < nghbrs.cnt; i++) {
+    SchedInstruction *nghbr = (SchedInstruction *)nghbrs.nodes[i];
+    if (dataDepGraph_->IsInGraph(nghbr)) {
+      InstCount nghbrBound = GetCrntLwrBound_(nghbr, dir);
 
-        if ((scsrBound + ltncy) > crntBound) {
-          crntBound = scsrBound + ltncy;
-        }
+      if ((nghbrBound + nghbrs.lbls[i]) > crntBound) {
+        crntBound = nghbrBound + nghbrs.lbls[i];
       }
     }
   }
@@ -248,8 +237,9 @@ void RelaxedScheduler::ClearFxng() {
 /*****************************************************************************/
 
 RJ_RelaxedScheduler::RJ_RelaxedScheduler(
-    DataDepStruct *dataDepGraph, MachineModel *machMdl, InstCount schedUprBound,
-    DIRECTION mainDir, RLXD_SCHED_TYPE type, InstCount maxInstCnt)
+    DataDepStruct *dataDepGraph, const MachineModel *machMdl,
+    InstCount schedUprBound, DIRECTION mainDir, RLXD_SCHED_TYPE type,
+    InstCount maxInstCnt)
     : RelaxedScheduler(dataDepGraph, machMdl, schedUprBound, mainDir, type,
                        maxInstCnt) {
   assert(instLst_->GetElmntCnt() == 0);
@@ -313,6 +303,13 @@ void RJ_RelaxedScheduler::SetupPrirtyLst() {
       instLst_->InsrtElmnt(inst, GetCrntLwrBound_(inst, opstDir), true);
     }
   }
+
+  prirtyOrdr_.clear();
+  for (SchedInstruction *inst = instLst_->GetFrstElmnt(); inst != NULL;
+       inst = instLst_->GetNxtElmnt()) {
+    prirtyOrdr_.push_back(inst);
+  }
+  instLst_->ResetIterator();
 }
 /*****************************************************************************/
 
@@ -354,25 +351,124 @@ InstCount RJ_RelaxedScheduler::FindSchedule() {
 
 bool RJ_RelaxedScheduler::SchdulAndChkFsblty(InstCount crntCycle,
                                              InstCount lastCycle) {
+  assert(schedType_ == RST_DYNMC && useFxng_);
+  InitChkng_(crntCycle);
+  bool fsbl = SchdulAndChkFsblty_(0, crntCycle, lastCycle);
+  EndChkng_(crntCycle);
+  return fsbl;
+}
+/*****************************************************************************/
+
+bool RJ_RelaxedScheduler::SchdulAndChkFsblty(InstCount crntCycle,
+                                             InstCount lastCycle,
+                                             const RlxdBaseline &bsln) {
+  assert(schedType_ == RST_DYNMC && useFxng_);
+  assert(bsln.isValid && bsln.crntCycle == crntCycle &&
+         bsln.lastCycle == lastCycle);
+  InitChkng_(crntCycle);
+
+  // Release times are no earlier and available slots are no more than in the
+  // baseline. Thus, each cycle that the baseline skipped is still full, and a
+  // step is unchanged as long as its instruction is still unfixed, its
+  // release time is the same and its cycle still has a slot.
+  InstCount step;
+  for (step = 0; step < bsln.stepCnt; step++) {
+    SchedInstruction *inst = prirtyOrdr_[step];
+
+    if (GetFix_(inst)) {
+      if (bsln.rlsTimes[step] != INVALID_VALUE) {
+        break;
+      }
+      inst->SetRlxdCycle(inst->GetCrntReleaseTime());
+      continue;
+    }
+
+    assert(bsln.rlsTimes[step] != INVALID_VALUE);
+    IssueType issuType = inst->GetIssueType();
+    InstCount schedCycle = bsln.cycles[step];
+
+    if (CmputReleaseTime_(inst) != bsln.rlsTimes[step] ||
+        avlblSlots_[issuType][schedCycle] == 0) {
+      break;
+    }
+
+    assert(inst->IsSchduld() == false);
+    TakeSlot_(issuType, schedCycle);
+    inst->SetRlxdCycle(schedCycle);
+    schduldInstCnt_++;
+    chkdInstCnt_++;
+  }
+
+  bool fsbl;
+  if (step < bsln.stepCnt) {
+    fsbl = SchdulAndChkFsblty_(step, crntCycle, lastCycle);
+  } else {
+    // The baseline is replayed up to its end or its first delay.
+    fsbl = bsln.fsbl;
+  }
+
+  EndChkng_(crntCycle);
+  return fsbl;
+}
+/*****************************************************************************/
+
+void RJ_RelaxedScheduler::RecordBaseline(InstCount crntCycle,
+                                         InstCount lastCycle,
+                                         RlxdBaseline &bsln) {
+  DIRECTION opstDir = DirAcycGraph::ReverseDirection(schedDir_);
+  InstCount instCnt = prirtyOrdr_.size();
+
+  assert(schedType_ == RST_DYNMC && useFxng_);
+  InitChkng_(crntCycle);
+  bsln.crntCycle = crntCycle;
+  bsln.lastCycle = lastCycle;
+  bsln.fsbl = true;
+  bsln.stepCnt = instCnt;
+  bsln.rlsTimes.resize(instCnt);
+  bsln.cycles.resize(instCnt);
+
+  for (InstCount step = 0; step < instCnt; step++) {
+    SchedInstruction *inst = prirtyOrdr_[step];
+
+    if (GetFix_(inst)) {
+      bsln.rlsTimes[step] = INVALID_VALUE;
+      continue;
+    }
+
+    IssueType issuType = inst->GetIssueType();
+    InstCount releaseTime = std::max(CmputReleaseTime_(inst), crntCycle);
+    InstCount schedCycle = FindNxtAvlblCycle_(issuType, releaseTime);
+    TakeSlot_(issuType, schedCycle);
+    bsln.rlsTimes[step] = releaseTime;
+    bsln.cycles[step] = schedCycle;
+
+    if (CmputDelay_(schedCycle, lastCycle, GetCrntLwrBound_(inst, opstDir)) >
+        0) {
+      bsln.fsbl = false;
+      bsln.stepCnt = step + 1;
+      break;
+    }
+  }
+
+  EndChkng_(crntCycle);
+  bsln.isValid = true;
+}
+/*****************************************************************************/
+
+bool RJ_RelaxedScheduler::SchdulAndChkFsblty_(InstCount strtStep,
+                                              InstCount crntCycle,
+                                              InstCount lastCycle) {
   SchedInstruction *inst;
   InstCount delay;
   bool fsbl = true;
   InstCount schedCycle;
   DIRECTION opstDir = DirAcycGraph::ReverseDirection(schedDir_);
 
-  assert(schedType_ == RST_DYNMC && useFxng_);
-  InitChkng_(crntCycle);
-#ifdef IS_DEBUG
-  InstCount iterNum = 0;
-#endif
-  assert(instLst_->GetElmntCnt() == totInstCnt_);
+  assert(prirtyOrdr_.size() == (size_t)totInstCnt_);
 
-  while (!IsSchedComplete_()) {
-    inst = instLst_->GetNxtPriorityElmnt();
-#ifdef IS_DEBUG
-    assert(iterNum < totInstCnt_);
-    iterNum++;
-#endif
+  for (InstCount step = strtStep; !IsSchedComplete_(); step++) {
+    assert(step < totInstCnt_);
+    inst = prirtyOrdr_[step];
     assert(inst != NULL);
 
     if (GetFix_(inst)) {
@@ -396,17 +492,10 @@ bool RJ_RelaxedScheduler::SchdulAndChkFsblty(InstCount crntCycle,
 
     if (delay > 0) {
       fsbl = false;
-    } else {
-      assert(GetFix_(inst) == false);
-      fsbl = true;
-    }
-
-    if (fsbl == false) {
       break;
     }
   }
 
-  EndChkng_(crntCycle);
   return fsbl;
 }
 /*****************************************************************************/
@@ -520,7 +609,9 @@ void RJ_RelaxedScheduler::InitChkng_(InstCount crntCycle) {
     for (j = crntCycle; j < schedUprBound_; j++) {
       assert(prevAvlblSlots_[i] != NULL);
       prevAvlblSlots_[i][j] = avlblSlots_[i][j];
-      nxtAvlblCycles_[i][j] = j;
+      // Cycles that are full due to fixed instructions. This also undoes
+      // the merges of the previous check and any UnFixInst() since then.
+      nxtAvlblCycles_[i][j] = avlblSlots_[i][j] > 0 ? j : j + 1;
     }
   }
 
@@ -559,6 +650,7 @@ bool RJ_RelaxedScheduler::FixInst(SchedInstruction *inst, InstCount cycle) {
 
   assert(avlblSlots_[issuType][cycle] > 0);
   avlblSlots_[issuType][cycle]--;
+  dirtyCycleEnd_ = std::max(dirtyCycleEnd_, cycle + 1);
   fxdInstCnt_++;
   schduldInstCnt_++;
   SetFix_(inst, true);
@@ -586,7 +678,7 @@ void RJ_RelaxedScheduler::UnFixInst(SchedInstruction *inst, InstCount cycle) {
 /*****************************************************************************/
 
 LC_RelaxedScheduler::LC_RelaxedScheduler(DataDepStruct *dataDepGraph,
-                                         MachineModel *machMdl,
+                                         const MachineModel *machMdl,
                                          InstCount schedUprBound,
                                          DIRECTION mainDir)
     : RelaxedScheduler(dataDepGraph, machMdl, schedUprBound, mainDir, RST_STTC,
@@ -594,7 +686,7 @@ LC_RelaxedScheduler::LC_RelaxedScheduler(DataDepStruct *dataDepGraph,
   // TEMP: Support for dynamic scheduling has not been implemented yet
   assert(schedType_ == RST_STTC);
 
-  subGraphInstLst_ = new PriorityList<SchedInstruction>;
+  subGraphInstLst_ = new IndexedPriorityList<SchedInstruction>;
 
   schedDir_ = mainDir_;
 }
@@ -755,7 +847,7 @@ InstCount LC_RelaxedScheduler::CmputReleaseTime_(SchedInstruction *inst) {
 /*****************************************************************************/
 
 LPP_RelaxedScheduler::LPP_RelaxedScheduler(DataDepStruct *dataDepGraph,
-                                           MachineModel *machMdl,
+                                           const MachineModel *machMdl,
                                            InstCount schedUprBound,
                                            DIRECTION mainDir)
     : RelaxedScheduler(dataDepGraph, machMdl, schedUprBound, mainDir, RST_STTC,
@@ -34,7 +34,7 @@ SchedInstruction::SchedInstruction(InstCount num, const string &name,
                                    InstCount maxInstCnt, int nodeID,
                                    InstCount fileSchedOrder,
                                    InstCount fileSchedCycle, InstCount fileLB,
-                                   InstCount fileUB, MachineModel *model)
+                                   InstCount fileUB, const MachineModel *model)
     : GraphNode(num, maxInstCnt) {
   // Static data that is computed only once.
   name_ = name;
@@ -48,26 +48,19 @@ SchedInstruction::SchedInstruction(InstCount num, const string &name,
   crtclPathFrmRoot_ = INVALID_VALUE;
   crtclPathFrmLeaf_ = INVALID_VALUE;
 
-  ltncyPerPrdcsr_ = NULL;
   memAllocd_ = false;
   sortedPrdcsrLst_ = NULL;
   sortedScsrLst_ = NULL;
 
-  crtclPathFrmRcrsvScsr_ = NULL;
-  crtclPathFrmRcrsvPrdcsr_ = NULL;
 
-  // Dynamic data that changes during scheduling.
-  ready_ = false;
+  // Dynamic data that changes during scheduling. The storage is owned by the
+  // graph, which sets it through SetSchedState() and SetPrdcsrRdyCycles().
+  schedState_ = NULL;
   rdyCyclePerPrdcsr_ = NULL;
-  minRdyCycle_ = INVALID_VALUE;
   prevMinRdyCyclePerPrdcsr_ = NULL;
-  unschduldPrdcsrCnt_ = 0;
-  unschduldScsrCnt_ = 0;
 
   crntRange_ = new SchedRange(this);
 
-  crntSchedCycle_ = SCHD_UNSCHDULD;
-  crntRlxdCycle_ = SCHD_UNSCHDULD;
   sig_ = 0;
   preFxdCycle_ = INVALID_VALUE;
 
@@ -85,6 +78,8 @@ SchedInstruction::SchedInstruction(InstCount num, const string &name,
 
   mustBeInBBEntry_ = false;
   mustBeInBBExit_ = false;
+
+  prevEquvlnt_ = NULL;
 }
 
 SchedInstruction::~SchedInstruction() {
@@ -93,17 +88,35 @@ SchedInstruction::~SchedInstruction() {
   delete crntRange_;
 }
 
-void SchedInstruction::SetupForSchdulng(InstCount instCnt, bool isCP_FromScsr,
-                                        bool isCP_FromPrdcsr) {
+void SchedInstruction::SetupForSchdulng() {
   if (memAllocd_)
     DeAllocMem_();
-  AllocMem_(instCnt, isCP_FromScsr, isCP_FromPrdcsr);
+  AllocMem_();
 
   SetPrdcsrNums_();
   SetScsrNums_();
   ComputeAdjustedUseCnt_();
 }
 
+void SchedInstruction::UpdtNghbrInfo() {
+  assert(memAllocd_);
+  delete sortedPrdcsrLst_;
+  SetupNghbrInfo_();
+
+  SetPrdcsrNums_();
+  SetScsrNums_();
+}
+
+void SchedInstruction::SetSchedState(InstSchedState *state) {
+  schedState_ = state;
+}
+
+void SchedInstruction::SetPrdcsrRdyCycles(InstCount *rdyCycles,
+                                          InstCount *prevMinRdyCycles) {
+  rdyCyclePerPrdcsr_ = rdyCycles;
+  prevMinRdyCyclePerPrdcsr_ = prevMinRdyCycles;
+}
+
 bool SchedInstruction::UseFileBounds() {
   bool match = true;
 #ifdef IS_DEBUG_BOUNDS
@@ -155,19 +168,20 @@ bool SchedInstruction::UseFileBounds() {
 
 bool SchedInstruction::InitForSchdulng(InstCount schedLngth,
                                        LinkedList<SchedInstruction> *fxdLst) {
-  crntSchedCycle_ = SCHD_UNSCHDULD;
-  crntRlxdCycle_ = SCHD_UNSCHDULD;
+  InstSchedState &state = *schedState_;
+  state.crntSchedCycle = SCHD_UNSCHDULD;
+  state.crntRlxdCycle = SCHD_UNSCHDULD;
 
   for (InstCount i = 0; i < prdcsrCnt_; i++) {
     rdyCyclePerPrdcsr_[i] = INVALID_VALUE;
     prevMinRdyCyclePerPrdcsr_[i] = INVALID_VALUE;
   }
 
-  ready_ = false;
-  minRdyCycle_ = INVALID_VALUE;
-  unschduldPrdcsrCnt_ = prdcsrCnt_;
-  unschduldScsrCnt_ = scsrCnt_;
-  lastUseCnt_ = 0;
+  state.ready = false;
+  state.minRdyCycle = INVALID_VALUE;
+  state.unschduldPrdcsrCnt = prdcsrCnt_;
+  state.unschduldScsrCnt = scsrCnt_;
+  state.lastUseCnt = 0;
 
   if (schedLngth != INVALID_VALUE) {
     bool fsbl = crntRange_->SetBounds(frwrdLwrBound_, bkwrdLwrBound_,
@@ -179,91 +193,47 @@ bool SchedInstruction::InitForSchdulng(InstCount schedLngth,
   return true;
 }
 
-void SchedInstruction::AllocMem_(InstCount instCnt, bool isCP_FromScsr,
-                                 bool isCP_FromPrdcsr) {
+void SchedInstruction::SetupNghbrInfo_() {
   scsrCnt_ = GetScsrCnt();
   prdcsrCnt_ = GetPrdcsrCnt();
-  rdyCyclePerPrdcsr_ = new InstCount[prdcsrCnt_];
-  ltncyPerPrdcsr_ = new InstCount[prdcsrCnt_];
-  prevMinRdyCyclePerPrdcsr_ = new InstCount[prdcsrCnt_];
   sortedPrdcsrLst_ = new PriorityList<SchedInstruction>;
 
-  InstCount predecessorIndex = 0;
   for (GraphEdge *edge = GetFrstPrdcsrEdge(); edge != NULL;
        edge = GetNxtPrdcsrEdge()) {
-    ltncyPerPrdcsr_[predecessorIndex++] = edge->label;
     sortedPrdcsrLst_->InsrtElmnt((SchedInstruction *)edge->GetOtherNode(this),
                                  edge->label, true);
   }
+}
 
-  if (isCP_FromScsr) {
-    crtclPathFrmRcrsvScsr_ = new InstCount[instCnt];
-
-    for (InstCount i = 0; i < instCnt; i++) {
-      crtclPathFrmRcrsvScsr_[i] = INVALID_VALUE;
-    }
-
-    crtclPathFrmRcrsvScsr_[GetNum()] = 0;
-  }
-
-  if (isCP_FromPrdcsr) {
-    crtclPathFrmRcrsvPrdcsr_ = new InstCount[instCnt];
-
-    for (InstCount i = 0; i < instCnt; i++) {
-      crtclPathFrmRcrsvPrdcsr_[i] = INVALID_VALUE;
-    }
-
-    crtclPathFrmRcrsvPrdcsr_[GetNum()] = 0;
-  }
-
+void SchedInstruction::AllocMem_() {
+  SetupNghbrInfo_();
   memAllocd_ = true;
 }
 
 void SchedInstruction::DeAllocMem_() {
   assert(memAllocd_);
 
-  if (rdyCyclePerPrdcsr_ != NULL)
-    delete[] rdyCyclePerPrdcsr_;
-  if (prevMinRdyCyclePerPrdcsr_ != NULL)
-    delete[] prevMinRdyCyclePerPrdcsr_;
-  if (ltncyPerPrdcsr_ != NULL)
-    delete[] ltncyPerPrdcsr_;
-  if (sortedPrdcsrLst_ != NULL)
-    delete sortedPrdcsrLst_;
-  if (sortedScsrLst_ != NULL)
-    delete sortedScsrLst_;
-  if (crtclPathFrmRcrsvScsr_ != NULL)
-    delete[] crtclPathFrmRcrsvScsr_;
-  if (crtclPathFrmRcrsvPrdcsr_ != NULL)
-    delete[] crtclPathFrmRcrsvPrdcsr_;
+  delete sortedPrdcsrLst_;
+  sortedPrdcsrLst_ = NULL;
+  delete sortedScsrLst_;
+  sortedScsrLst_ = NULL;
 
   memAllocd_ = false;
 }
 
-InstCount SchedInstruction::CmputCrtclPath_(DIRECTION dir,
-                                            SchedInstruction *ref) {
+InstCount SchedInstruction::CmputCrtclPath_(DIRECTION dir) {
   // The idea of this function is considering each predecessor (successor) and
   // calculating the length of the path from the root (leaf) through that
   // predecessor (successor) and then taking the maximum value among all these
   // paths.
   InstCount crtclPath = 0;
-  LinkedList<GraphEdge> *nghbrLst = GetNghbrLst(dir);
-
-  for (GraphEdge *edg = nghbrLst->GetFrstElmnt(); edg != NULL;
-       edg = nghbrLst->GetNxtElmnt()) {
-    UDT_GLABEL edgLbl = edg->label;
-    SchedInstruction *nghbr = (SchedInstruction *)(edg->GetOtherNode(this));
-
-    InstCount nghbrCrtclPath;
-    if (ref == NULL) {
-      nghbrCrtclPath = nghbr->GetCrtclPath(dir);
-    } else {
-      // When computing relative critical paths, we only need to consider
-      // neighbors that belong to the sub-tree rooted at the reference.
-      if (!ref->IsRcrsvNghbr(dir, nghbr))
-        continue;
-      nghbrCrtclPath = nghbr->GetRltvCrtclPath(dir, ref);
-    }
+  const GraphEdgeSpan &nghbrs = GetNghbrSpan(dir);
+
+  for (UDT_GEDGES i = 0; i < nghbrs.cnt; i++) {
+    UDT_GLABEL edgLbl = nghbrs.lbls[i];
+    SchedInstruction *nghbr = (SchedInstruction *)nghbrs.nodes[i];
+
+    InstCount nghbrCrtclPath = nghbr->GetCrtclPath(dir);
     assert(nghbrCrtclPath != INVALID_VALUE);
 
     if ((nghbrCrtclPath + edgLbl) > crtclPath) {
@@ -458,37 +428,10 @@ InstCount SchedInstruction::CmputCrtclPathFrmLeaf() {
   return crtclPathFrmLeaf_;
 }
 
-InstCount
-SchedInstruction::CmputCrtclPathFrmRcrsvPrdcsr(SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-  crtclPathFrmRcrsvPrdcsr_[refInstNum] = CmputCrtclPath_(DIR_FRWRD, ref);
-  return crtclPathFrmRcrsvPrdcsr_[refInstNum];
-}
-
-InstCount SchedInstruction::CmputCrtclPathFrmRcrsvScsr(SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-  crtclPathFrmRcrsvScsr_[refInstNum] = CmputCrtclPath_(DIR_BKWRD, ref);
-  return crtclPathFrmRcrsvScsr_[refInstNum];
-}
-
 InstCount SchedInstruction::GetCrtclPath(DIRECTION dir) const {
   return dir == DIR_FRWRD ? crtclPathFrmRoot_ : crtclPathFrmLeaf_;
 }
 
-InstCount SchedInstruction::GetRltvCrtclPath(DIRECTION dir,
-                                             SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-
-  if (dir == DIR_FRWRD) {
-    assert(crtclPathFrmRcrsvPrdcsr_[refInstNum] != INVALID_VALUE);
-    return crtclPathFrmRcrsvPrdcsr_[refInstNum];
-  } else {
-    assert(dir == DIR_BKWRD);
-    assert(crtclPathFrmRcrsvScsr_[refInstNum] != INVALID_VALUE);
-    return crtclPathFrmRcrsvScsr_[refInstNum];
-  }
-}
-
 InstCount SchedInstruction::GetLwrBound(DIRECTION dir) const {
   return dir == DIR_FRWRD ? frwrdLwrBound_ : bkwrdLwrBound_;
 }
@@ -531,33 +474,36 @@ void SchedInstruction::SetBounds(InstCount flb, InstCount blb) {
 bool SchedInstruction::PrdcsrSchduld(InstCount prdcsrNum, InstCount cycle,
                                      InstCount &rdyCycle) {
   assert(prdcsrNum < prdcsrCnt_);
-  rdyCyclePerPrdcsr_[prdcsrNum] = cycle + ltncyPerPrdcsr_[prdcsrNum];
-  prevMinRdyCyclePerPrdcsr_[prdcsrNum] = minRdyCycle_;
+  InstSchedState &state = *schedState_;
+  rdyCyclePerPrdcsr_[prdcsrNum] = cycle + GetPrdcsrSpan().lbls[prdcsrNum];
+  prevMinRdyCyclePerPrdcsr_[prdcsrNum] = state.minRdyCycle;
 
-  if (rdyCyclePerPrdcsr_[prdcsrNum] > minRdyCycle_) {
-    minRdyCycle_ = rdyCyclePerPrdcsr_[prdcsrNum];
+  if (rdyCyclePerPrdcsr_[prdcsrNum] > state.minRdyCycle) {
+    state.minRdyCycle = rdyCyclePerPrdcsr_[prdcsrNum];
   }
 
-  rdyCycle = minRdyCycle_;
-  unschduldPrdcsrCnt_--;
-  return (unschduldPrdcsrCnt_ == 0);
+  rdyCycle = state.minRdyCycle;
+  state.unschduldPrdcsrCnt--;
+  return (state.unschduldPrdcsrCnt == 0);
 }
 
 bool SchedInstruction::PrdcsrUnSchduld(InstCount prdcsrNum,
                                        InstCount &rdyCycle) {
   assert(prdcsrNum < prdcsrCnt_);
   assert(rdyCyclePerPrdcsr_[prdcsrNum] != INVALID_VALUE);
-  rdyCycle = minRdyCycle_;
-  minRdyCycle_ = prevMinRdyCyclePerPrdcsr_[prdcsrNum];
+  InstSchedState &state = *schedState_;
+  rdyCycle = state.minRdyCycle;
+  state.minRdyCycle = prevMinRdyCyclePerPrdcsr_[prdcsrNum];
   rdyCyclePerPrdcsr_[prdcsrNum] = INVALID_VALUE;
-  unschduldPrdcsrCnt_++;
-  assert(unschduldPrdcsrCnt_ != prdcsrCnt_ || minRdyCycle_ == INVALID_VALUE);
-  return (unschduldPrdcsrCnt_ == 1);
+  state.unschduldPrdcsrCnt++;
+  assert(state.unschduldPrdcsrCnt != prdcsrCnt_ ||
+         state.minRdyCycle == INVALID_VALUE);
+  return (state.unschduldPrdcsrCnt == 1);
 }
 
 bool SchedInstruction::ScsrSchduld() {
-  unschduldScsrCnt_--;
-  return unschduldScsrCnt_ == 0;
+  schedState_->unschduldScsrCnt--;
+  return schedState_->unschduldScsrCnt == 0;
 }
 
 void SchedInstruction::SetInstType(InstType type) { instType_ = type; }
@@ -570,39 +516,47 @@ IssueType SchedInstruction::GetIssueType() const { return issuType_; }
 
 bool SchedInstruction::IsSchduld(InstCount *cycle) const {
   if (cycle)
-    *cycle = crntSchedCycle_;
-  return crntSchedCycle_ != SCHD_UNSCHDULD;
+    *cycle = schedState_->crntSchedCycle;
+  return schedState_->crntSchedCycle != SCHD_UNSCHDULD;
 }
 
-InstCount SchedInstruction::GetSchedCycle() const { return crntSchedCycle_; }
+InstCount SchedInstruction::GetSchedCycle() const {
+  return schedState_->crntSchedCycle;
+}
 
-InstCount SchedInstruction::GetSchedSlot() const { return crntSchedSlot_; }
+InstCount SchedInstruction::GetSchedSlot() const {
+  return schedState_->crntSchedSlot;
+}
 
 InstCount SchedInstruction::GetCrntDeadline() const {
-  return IsSchduld() ? crntSchedCycle_ : crntRange_->GetDeadline();
+  return IsSchduld() ? schedState_->crntSchedCycle : crntRange_->GetDeadline();
 }
 
 InstCount SchedInstruction::GetCrntReleaseTime() const {
-  return IsSchduld() ? crntSchedCycle_ : GetCrntLwrBound(DIR_FRWRD);
+  return IsSchduld() ? schedState_->crntSchedCycle
+                     : GetCrntLwrBound(DIR_FRWRD);
 }
 
 InstCount SchedInstruction::GetRlxdCycle() const {
-  return IsSchduld() ? crntSchedCycle_ : crntRlxdCycle_;
+  return IsSchduld() ? schedState_->crntSchedCycle
+                     : schedState_->crntRlxdCycle;
 }
 
-void SchedInstruction::SetRlxdCycle(InstCount cycle) { crntRlxdCycle_ = cycle; }
+void SchedInstruction::SetRlxdCycle(InstCount cycle) {
+  schedState_->crntRlxdCycle = cycle;
+}
 
 void SchedInstruction::Schedule(InstCount cycleNum, InstCount slotNum) {
-  assert(crntSchedCycle_ == SCHD_UNSCHDULD);
-  crntSchedCycle_ = cycleNum;
-  crntSchedSlot_ = slotNum;
+  assert(schedState_->crntSchedCycle == SCHD_UNSCHDULD);
+  schedState_->crntSchedCycle = cycleNum;
+  schedState_->crntSchedSlot = slotNum;
 }
 
-bool SchedInstruction::IsInReadyList() const { return ready_; }
+bool SchedInstruction::IsInReadyList() const { return schedState_->ready; }
 
-void SchedInstruction::PutInReadyList() { ready_ = true; }
+void SchedInstruction::PutInReadyList() { schedState_->ready = true; }
 
-void SchedInstruction::RemoveFromReadyList() { ready_ = false; }
+void SchedInstruction::RemoveFromReadyList() { schedState_->ready = false; }
 
 InstCount SchedInstruction::GetCrntLwrBound(DIRECTION dir) const {
   return crntRange_->GetLwrBound(dir);
@@ -613,9 +567,9 @@ void SchedInstruction::SetCrntLwrBound(DIRECTION dir, InstCount bound) {
 }
 
 void SchedInstruction::UnSchedule() {
-  assert(crntSchedCycle_ != SCHD_UNSCHDULD);
-  crntSchedCycle_ = SCHD_UNSCHDULD;
-  crntSchedSlot_ = SCHD_UNSCHDULD;
+  assert(schedState_->crntSchedCycle != SCHD_UNSCHDULD);
+  schedState_->crntSchedCycle = SCHD_UNSCHDULD;
+  schedState_->crntSchedSlot = SCHD_UNSCHDULD;
 }
 
 void SchedInstruction::UnTightnLwrBounds() { crntRange_->UnTightnLwrBounds(); }
@@ -657,11 +611,10 @@ bool SchedInstruction::ProbeScsrsCrntLwrBounds(InstCount cycle) {
   if (cycle <= crntRange_->GetLwrBound(DIR_FRWRD))
     return false;
 
-  for (GraphEdge *edg = GetFrstScsrEdge(); edg != NULL;
-       edg = GetNxtScsrEdge()) {
-    UDT_GLABEL edgLbl = edg->label;
-    SchedInstruction *nghbr = (SchedInstruction *)(edg->GetOtherNode(this));
-    InstCount nghbrNewLwrBound = cycle + edgLbl;
+  const GraphEdgeSpan &scsrs = GetScsrSpan();
+  for (UDT_GEDGES i = 0; i < scsrs.cnt; i++) {
+    SchedInstruction *nghbr = (SchedInstruction *)scsrs.nodes[i];
+    InstCount nghbrNewLwrBound = cycle + scsrs.lbls[i];
 
     // If this neighbor will get delayed by scheduling this instruction in the
     // given cycle.
@@ -710,16 +663,17 @@ void SchedInstruction::SetPrdcsrNums_() {
 }
 
 int16_t SchedInstruction::CmputLastUseCnt() {
-  lastUseCnt_ = 0;
+  int16_t lastUseCnt = 0;
 
   for (int i = 0; i < useCnt_; i++) {
     Register *reg = uses_[i];
     assert(reg->GetCrntUseCnt() < reg->GetUseCnt());
     if (reg->GetCrntUseCnt() + 1 == reg->GetUseCnt())
-      lastUseCnt_++;
+      lastUseCnt++;
   }
 
-  return lastUseCnt_;
+  schedState_->lastUseCnt = lastUseCnt;
+  return lastUseCnt;
 }
 
 /******************************************************************************
@@ -1,7 +1,9 @@
 #include <algorithm>
 #include <cstdio>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "Wrapper/OptSchedDDGWrapperBasic.h"
 #include "opt-sched/Scheduler/aco.h"
@@ -26,6 +28,10 @@ using namespace llvm::opt_sched;
 
 namespace fs = llvm::sys::fs;
 
+// Independent components with fewer instructions than this are pooled into
+// one part instead of being scheduled as parts of their own.
+static const InstCount MIN_INDEPENDENT_PART_SIZE = 4;
+
 static bool GetDumpDDGs() {
   // Cache the result so that we don't have to keep looking it up.
   // This is in a function so that the initialization is definitely delayed
@@ -74,8 +80,9 @@ static std::string GetDDGDumpPath() {
   return DDGDumpPath;
 }
 
-SchedRegion::SchedRegion(MachineModel *machMdl, DataDepGraph *dataDepGraph,
-                         long rgnNum, int16_t sigHashSize, LB_ALG lbAlg,
+SchedRegion::SchedRegion(const MachineModel *machMdl,
+                         DataDepGraph *dataDepGraph, long rgnNum,
+                         int16_t sigHashSize, LB_ALG lbAlg,
                          SchedPriorities hurstcPrirts,
                          SchedPriorities enumPrirts, bool vrfySched,
                          Pruning PruningStrategy, SchedulerType HeurSchedType,
@@ -188,6 +195,10 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   InstSchedule *InitialSchedule = nullptr;
   InstSchedule *lstSched = NULL;
   InstSchedule *AcoSchedule = nullptr;
+  InstSchedule *PartsSched = nullptr;
+  // The time spent scheduling the independent parts, which counts against
+  // the region's time limit.
+  Milliseconds PartsTime = 0;
   InstCount InitialScheduleLength = 0;
   InstCount InitialScheduleCost = 0;
   FUNC_RESULT rslt = RES_SUCCESS;
@@ -252,9 +263,28 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
 
   stats::problemSize.Record(dataDepGraph_->GetInstCnt());
 
+  const bool IsSeqListSched = GetHeuristicSchedulerType() == SCHED_SEQ;
+
+  // Most regions are easy: the heuristic schedule already meets the bounds
+  // that can be computed without the transitive closure. Unless something
+  // before the heuristic needs it, only compute the closure once the
+  // heuristic schedule has been compared with those bounds.
+  const bool DelayTransitiveClosure =
+      schedIni.GetBool("DELAY_TRANSITIVE_CLOSURE", true) &&
+      NeedTransitiveClosure && HeuristicSchedulerEnabled && !IsSeqListSched &&
+      !isTwoPassEnabled() && !needsSLIL() &&
+      (dataDepGraph_->GetGraphTrans()->empty() ||
+       (GraphTransPosition_ & GT_POSITION::BEFORE_HEURISTIC) ==
+           GT_POSITION::NONE);
+  // Whether the heuristic schedule meets the bounds computed without the
+  // transitive closure, which makes the closure unnecessary.
+  bool MeetsCheapBounds = false;
+
   Logger::Event("RunningSetupForScheduling", //
-                "need_transitive_closure", NeedTransitiveClosure);
-  rslt = dataDepGraph_->SetupForSchdulng(NeedTransitiveClosure);
+                "need_transitive_closure",
+                NeedTransitiveClosure && !DelayTransitiveClosure);
+  rslt = dataDepGraph_->SetupForSchdulng(NeedTransitiveClosure &&
+                                         !DelayTransitiveClosure);
   Logger::Event("RunningSetupForSchedulingFinished");
   if (rslt != RES_SUCCESS) {
     Logger::Info("Invalid input DAG");
@@ -265,8 +295,6 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     dumpDDG(dataDepGraph_, DDGDumpPath_);
   }
 
-  const bool IsSeqListSched = GetHeuristicSchedulerType() == SCHED_SEQ;
-
   if ((GraphTransPosition_ & GT_POSITION::BEFORE_HEURISTIC) != GT_POSITION::NONE
       // The sequential list scheduler can "find" schedules invalidated by graph
       // transformations. Delay until _after_ it.
@@ -307,6 +335,26 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
       Logger::Info("Heuristic_Time %d", hurstcTime);
   }
 
+  if (DelayTransitiveClosure) {
+    // The critical path and resource bounds and the cost lower bound derived
+    // from them. A cost of zero above these is zero above any tighter bound.
+    CalculateLowerBounds(false);
+    InstCount hurstcExecCost;
+    CmputNormCost_(lstSched, CCM_DYNMC, hurstcExecCost, true);
+    MeetsCheapBounds = lstSched->GetCost() == 0;
+
+    if (!MeetsCheapBounds) {
+      Logger::Event("RunningTransitiveClosure");
+      rslt = dataDepGraph_->CmputTrnstvClsr();
+      if (rslt != RES_SUCCESS) {
+        Logger::Info("Invalid input DAG");
+        delete lstSchdulr;
+        delete lstSched;
+        return rslt;
+      }
+    }
+  }
+
   // After the sequential scheduler in the second pass, add the artificial edges
   // to the DDG. Some mutations were adding artificial edges which caused a
   // conflict with the sequential scheduler. Therefore, wait until the
@@ -332,8 +380,15 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
 
   // This must be done after SetupForSchdulng() or UpdateSetupForSchdulng() to
   // avoid resetting lower bound values.
-  const Milliseconds LbElapsedTime = Utilities::countMillisToExecute(
-      [&] { CalculateLowerBounds(BbSchedulerEnabled); });
+  const Milliseconds LbElapsedTime = Utilities::countMillisToExecute([&] {
+    if (!DelayTransitiveClosure)
+      CalculateLowerBounds(BbSchedulerEnabled);
+    else if (BbSchedulerEnabled && !MeetsCheapBounds)
+      // Tighten the bounds computed before the closure with the relaxed
+      // schedules. Otherwise, those bounds are final.
+      CmputLwrBounds_(false);
+  });
+  stats::lowerBoundComputationTime.Record(LbElapsedTime);
 
   // Log the lower bound on the cost, allowing tools reading the log to compare
   // absolute rather than relative costs.
@@ -436,6 +491,34 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
       return rslt;
   }
 
+  // If the region falls apart into independent parts, schedule each part as
+  // a region of its own and interleave the results. The parts' lengths may
+  // also raise the lower bound.
+  if (!isLstOptml && lstSched && BbSchedulerEnabled && !isTwoPassEnabled() &&
+      !IsIndependentPart_ && schedIni.GetBool("DECOMPOSE_REGIONS", false)) {
+    Milliseconds PartsStart = Utilities::GetProcessorTime();
+    PartsSched = scheduleIndependentParts(rgnTimeout, lngthTimeout, lstSched,
+                                          isLstOptml, bestSched);
+    PartsTime = Utilities::GetProcessorTime() - PartsStart;
+
+    if (PartsSched && !isLstOptml && PartsSched->GetCost() == 0) {
+      isLstOptml = true;
+      bestSched = bestSched_ = PartsSched;
+      bestSchedLngth_ = PartsSched->GetCrntLngth();
+      bestCost_ = PartsSched->GetCost();
+      BestSpillCost_ = PartsSched->GetSpillCost();
+    }
+  }
+
+  // Let ACO and the enumerator try interchangeable instructions in one order
+  // only.
+  if (!isLstOptml && schedIni.GetBool("BREAK_INST_SYMMETRY", false)) {
+    InstCount equvlntCnt = dataDepGraph_->FindEquvlntClasses();
+    if (equvlntCnt > 0)
+      Logger::Info("Found %d instructions interchangeable with an earlier one.",
+                   equvlntCnt);
+  }
+
   // Step #2: Use ACO to find a schedule if enabled and no optimal schedule is
   // yet to be found.
   if (AcoBeforeEnum && !isLstOptml) {
@@ -450,6 +533,7 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
       if (lstSched)
         delete lstSched;
       delete AcoSchedule;
+      delete PartsSched;
       return rslt;
     }
 
@@ -508,6 +592,14 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
       bestCost_ = bestSched_->GetCost();
       BestSpillCost_ = bestSched_->GetSpillCost();
     }
+
+    // D) The interleaved schedule of the independent parts beats both.
+    if (PartsSched && PartsSched->GetCost() < bestCost_) {
+      bestSched = bestSched_ = PartsSched;
+      bestSchedLngth_ = PartsSched->GetCrntLngth();
+      bestCost_ = PartsSched->GetCost();
+      BestSpillCost_ = PartsSched->GetSpillCost();
+    }
   }
 
   // Step #3: Compute the cost upper bound.
@@ -530,6 +622,8 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
 
   if (EnableEnum_() == false) {
     delete lstSchdulr;
+    if (PartsSched != bestSched)
+      delete PartsSched;
     return RES_FAIL;
   }
 
@@ -551,7 +645,9 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
         Logger::Info("Problem size not increased after introducing latencies, "
                      "skipping second pass enumeration");
       else
-        rslt = Optimize_(enumStart, rgnTimeout, lngthTimeout);
+        // The deadlines are as if the enumerator had started before the
+        // independent parts were scheduled.
+        rslt = Optimize_(enumStart - PartsTime, rgnTimeout, lngthTimeout);
 
       Milliseconds enumTime = Utilities::GetProcessorTime() - enumStart;
 
@@ -604,8 +700,8 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     Logger::Info("Cost Sum: %lu", costSum);
 #endif
 
-    if (SchedulerOptions::getInstance().GetString(
-            "SIMULATE_REGISTER_ALLOCATION") != "NO") {
+    if (!IsIndependentPart_ && SchedulerOptions::getInstance().GetString(
+                                   "SIMULATE_REGISTER_ALLOCATION") != "NO") {
       //#ifdef IS_DEBUG
       RegAlloc_(bestSched, InitialSchedule);
       //#endif
@@ -681,6 +777,9 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   if (NULL != AcoSchedule && bestSched != AcoSchedule) {
     delete AcoSchedule;
   }
+  if (NULL != PartsSched && bestSched != PartsSched) {
+    delete PartsSched;
+  }
   if (enumBestSched_ != NULL && bestSched != enumBestSched_)
     delete enumBestSched_;
   if (enumCrntSched_ != NULL)
@@ -803,6 +902,7 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
   enumBestSched_ = AllocNewSched_();
 
   InstCount initCost = bestCost_;
+  EnumStartTime_ = startTime;
   enumrtr = AllocEnumrtr_(lngthTimeout);
   rslt = Enumerate_(startTime, rgnTimeout, lngthTimeout);
 
@@ -828,7 +928,12 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
     stats::solvedProblemSize.Record(dataDepGraph_->GetInstCnt());
     stats::solutionTimeForSolvedProblems.Record(solutionTime);
   } else {
-    if (rslt == RES_TIMEOUT) {
+    if (rslt == RES_TIMEOUT && isOptimalityGapClosed()) {
+      Logger::Event("DagOptimalityGapClosed", "solution_time", solutionTime, //
+                    "length", bestSchedLngth_,                               //
+                    "spill_cost", bestSched_->GetSpillCost(),                //
+                    "total_cost", bestCost_, "cost_improvement", improvement);
+    } else if (rslt == RES_TIMEOUT) {
       Logger::Event("DagTimedOut", "length", bestSchedLngth_, //
                     "spill_cost", bestSched_->GetSpillCost(), //
                     "total_cost", bestCost_, "cost_improvement", improvement);
@@ -867,8 +972,28 @@ void SchedRegion::CmputLwrBounds_(bool useFileBounds) {
 
     InstCount frwrdLwrBound = 0;
     InstCount bkwrdLwrBound = 0;
-    frwrdLwrBound = rlxdSchdulr->FindSchedule();
-    bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule();
+    Milliseconds rlxdStart = Utilities::GetProcessorTime();
+
+    // Each direction only reads the graph and writes the lower bounds of its
+    // own direction, so the two can run at the same time.
+    if (SchedulerOptions::getInstance().GetBool("PARALLEL_LOWER_BOUNDS",
+                                                false)) {
+      // The relative critical paths are built on first use; build them
+      // before both threads read them.
+      if (lbAlg_ == LBA_LC)
+        dataDepGraph_->GetRltvCrtclPath(0, 0);
+
+      std::thread bkwrdThread(
+          [&] { bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule(); });
+      frwrdLwrBound = rlxdSchdulr->FindSchedule();
+      bkwrdThread.join();
+    } else {
+      frwrdLwrBound = rlxdSchdulr->FindSchedule();
+      bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule();
+    }
+
+    stats::relaxedLowerBoundTime.Record(Utilities::GetProcessorTime() -
+                                        rlxdStart);
     InstCount rlxdLwrBound = std::max(frwrdLwrBound, bkwrdLwrBound);
 
     assert(rlxdLwrBound >= schedLwrBound_);
@@ -1028,6 +1153,46 @@ void SchedRegion::InitSecondPass(bool EnableMutations) {
 
 void SchedRegion::initTwoPassAlg() { TwoPassEnabled_ = true; }
 
+bool SchedRegion::isOptimalityGapClosed() const {
+  if (OptimalityGap_ <= 0 && OptimalityGapPercent_ <= 0)
+    return false;
+
+  InstCount Gap, LwrBound;
+  if (!TwoPassEnabled_) {
+    // The best cost is already normalized to the lower bound.
+    Gap = bestCost_;
+    LwrBound = costLwrBound_;
+  } else if (!isSecondPass_) {
+    Gap = BestSpillCost_ - SpillCostLwrBound_;
+    LwrBound = SpillCostLwrBound_;
+  } else {
+    // The second pass only looks for the shortest schedule meeting the spill
+    // cost constraint, and stops at the first one it finds anyway.
+    return false;
+  }
+
+  // A schedule at the lower bound is optimal, which the enumerator already
+  // checks for.
+  if (Gap <= 0)
+    return false;
+  return Gap <= OptimalityGap_ ||
+         Gap * 100.0 <= OptimalityGapPercent_ * LwrBound;
+}
+
+void SchedRegion::reportImprovement(InstSchedule *sched) {
+  if (!ImprovementCallback_)
+    return;
+
+  EnumImprovement Improvement;
+  Improvement.elapsed = Utilities::GetProcessorTime() - EnumStartTime_;
+  Improvement.length = sched->GetCrntLngth();
+  Improvement.cost = sched->GetCost();
+  Improvement.costLwrBound = costLwrBound_;
+  Improvement.spillCost = sched->GetSpillCost();
+  Improvement.spillCostLwrBound = SpillCostLwrBound_;
+  ImprovementCallback_(Improvement);
+}
+
 FUNC_RESULT SchedRegion::runACO(InstSchedule *ReturnSched,
                                 InstSchedule *InitSched, bool IsPostBB) {
   InitForSchdulng();
@@ -1053,6 +1218,7 @@ void SchedRegion::updateBoundsAfterGraphTransformations(
   if (IsLowerBoundSet_) {
     const Milliseconds LbElapsedTime = Utilities::countMillisToExecute(
         [&] { CalculateLowerBounds(BbSchedulerEnabled); });
+    stats::lowerBoundComputationTime.Record(LbElapsedTime);
 
     // Log the new lower bound on the cost, allowing tools reading the log to
     // compare absolute rather than relative costs.
@@ -1136,35 +1302,154 @@ SchedRegion::applyGraphTransformations(bool BbSchedulerEnabled,
   //  - The only part of cost calculation that _does_ depend on the graph
   //    structure is the lower bounds, which are abstracted into a number, so it
   //    is okay.
-  if (heuristicSched) {
-    const InstCount heuristicScheduleLength = heuristicSched->GetCrntLngth();
-    InstCount hurstcExecCost;
-    // Compute cost for Heuristic list scheduler, this must be called before
-    // calling GetCost() on the InstSchedule instance.
-    CmputNormCost_(heuristicSched, CCM_DYNMC, hurstcExecCost, true);
-    hurstcCost_ = heuristicSched->GetCost();
+  if (heuristicSched)
+    updateHeuristicCost(heuristicSched, isLstOptml, bestSched);
 
-    // Get unweighted spill cost for Heurstic list scheduler
-    HurstcSpillCost_ = heuristicSched->GetSpillCost();
+  Logger::Event("GraphTransformationsFinished");
 
-    // This schedule is optimal so ACO will not be run
-    // so set bestSched here.
-    if (hurstcCost_ == 0) {
-      isLstOptml = true;
-      bestSched = bestSched_ = heuristicSched;
-      bestSchedLngth_ = heuristicScheduleLength;
-      bestCost_ = hurstcCost_;
-      BestSpillCost_ = HurstcSpillCost_;
+  return result;
+}
+
+void SchedRegion::updateHeuristicCost(InstSchedule *heuristicSched,
+                                      bool &isLstOptml,
+                                      InstSchedule *&bestSched) {
+  const InstCount heuristicScheduleLength = heuristicSched->GetCrntLngth();
+  InstCount hurstcExecCost;
+  // Compute cost for Heuristic list scheduler, this must be called before
+  // calling GetCost() on the InstSchedule instance.
+  CmputNormCost_(heuristicSched, CCM_DYNMC, hurstcExecCost, true);
+  hurstcCost_ = heuristicSched->GetCost();
+
+  // Get unweighted spill cost for Heurstic list scheduler
+  HurstcSpillCost_ = heuristicSched->GetSpillCost();
+
+  // This schedule is optimal so ACO will not be run
+  // so set bestSched here.
+  if (hurstcCost_ == 0) {
+    isLstOptml = true;
+    bestSched = bestSched_ = heuristicSched;
+    bestSchedLngth_ = heuristicScheduleLength;
+    bestCost_ = hurstcCost_;
+    BestSpillCost_ = HurstcSpillCost_;
+  }
+
+  Logger::Event("HeuristicResult", "length", heuristicScheduleLength, //
+                "spill_cost", heuristicSched->GetSpillCost(), "cost",
+                hurstcCost_);
+}
+
+InstSchedule *SchedRegion::scheduleIndependentParts(
+    Milliseconds rgnTimeout, Milliseconds lngthTimeout,
+    InstSchedule *heuristicSched, bool &isLstOptml, InstSchedule *&bestSched) {
+  std::vector<InstCount> cmpnnts;
+  const InstCount cmpnntCnt = dataDepGraph_->FindIndpndntCmpnnts(cmpnnts);
+  if (cmpnntCnt < 2)
+    return nullptr;
+
+  // Every component that is large enough is a part of its own. The small
+  // ones are not worth a region each and share one part.
+  std::vector<InstCount> cmpnntSizes(cmpnntCnt, 0);
+  for (InstCount Cmpnnt : cmpnnts)
+    if (Cmpnnt != INVALID_VALUE)
+      cmpnntSizes[Cmpnnt]++;
+
+  std::vector<std::vector<InstCount>> Parts;
+  std::vector<size_t> PartOfCmpnnt(cmpnntCnt);
+  size_t SmallPart = Parts.max_size();
+  for (InstCount i = 0; i < cmpnntCnt; i++) {
+    if (cmpnntSizes[i] < MIN_INDEPENDENT_PART_SIZE) {
+      if (SmallPart == Parts.max_size()) {
+        SmallPart = Parts.size();
+        Parts.emplace_back();
+      }
+      PartOfCmpnnt[i] = SmallPart;
+    } else {
+      PartOfCmpnnt[i] = Parts.size();
+      Parts.emplace_back();
     }
+  }
 
-    Logger::Event("HeuristicResult", "length", heuristicScheduleLength, //
-                  "spill_cost", heuristicSched->GetSpillCost(), "cost",
-                  hurstcCost_);
+  // Each part gets an equal share of the region's time limit.
+  Milliseconds PartTimeout = rgnTimeout;
+  Milliseconds PartLngthTimeout = lngthTimeout;
+  if (rgnTimeout != INVALID_VALUE) {
+    PartTimeout = rgnTimeout / (Milliseconds)Parts.size();
+    PartLngthTimeout = std::min(lngthTimeout, PartTimeout);
   }
 
-  Logger::Event("GraphTransformationsFinished");
+  if (Parts.size() < 2 || PartTimeout == 0)
+    return nullptr;
 
-  return result;
+  for (InstCount i = 0; i < dataDepGraph_->GetInstCnt(); i++)
+    if (cmpnnts[i] != INVALID_VALUE)
+      Parts[PartOfCmpnnt[cmpnnts[i]]].push_back(i);
+
+  Logger::Event("IndependentPartsStart", "num_parts", (int)Parts.size());
+
+  // The cycle of each instruction in its part's schedule.
+  std::vector<InstCount> PartCycles(dataDepGraph_->GetInstCnt(), 0);
+  InstCount PartsLwrBound = 0;
+
+  {
+    // Only the region reports its results. The parts' events, messages and
+    // per-region stats would count it several times over.
+    Logger::Silence Quiet;
+    stats::PauseSampling NoSamples;
+
+    for (size_t i = 0; i < Parts.size(); i++) {
+      DataDepCmpnntGraph PartGraph(dataDepGraph_, machMdl_, Parts[i], (int)i);
+      std::unique_ptr<SchedRegion> PartRgn(AllocPartRgn_(&PartGraph));
+      PartRgn->IsIndependentPart_ = true;
+
+      bool IsPartOptml = false;
+      InstCount Cost, Lngth, HurstcCost, HurstcLngth;
+      InstSchedule *PartSched = nullptr;
+      FUNC_RESULT Rslt = PartRgn->FindOptimalSchedule(
+          PartTimeout, PartLngthTimeout, IsPartOptml, Cost, Lngth, HurstcCost,
+          HurstcLngth, PartSched, false, BLOCKS_TO_KEEP::ALL);
+      if (Rslt == RES_ERROR || PartSched == nullptr) {
+        delete PartSched;
+        return nullptr;
+      }
+
+      // A schedule of the region is also one of each part, with the part's
+      // instructions in the same cycles and its root and leaf in the region's
+      // first and last cycle. So no schedule of the region is shorter than
+      // the shortest schedule of any part.
+      if (IsPartOptml || Rslt == RES_SUCCESS)
+        PartsLwrBound = std::max(PartsLwrBound, Lngth);
+
+      for (size_t j = 0; j < Parts[i].size(); j++)
+        PartCycles[Parts[i][j]] = PartSched->GetSchedCycle((InstCount)j);
+      delete PartSched;
+    }
+  }
+
+  // The heuristic schedule is still the one the region's cost state is for.
+  if (PartsLwrBound > schedLwrBound_) {
+    schedLwrBound_ = PartsLwrBound;
+    CmputAndSetCostLwrBound();
+    Logger::Event("CostLowerBound", "cost", costLwrBound_);
+    updateHeuristicCost(heuristicSched, isLstOptml, bestSched);
+  }
+
+  InitForSchdulng();
+  InstSchedule *Sched = new InstSchedule(machMdl_, dataDepGraph_, vrfySched_);
+  InterleavingListScheduler Schdulr(dataDepGraph_, machMdl_,
+                                    abslutSchedUprBound_, hurstcPrirts_,
+                                    Parts, std::move(PartCycles));
+  if (Schdulr.FindSchedule(Sched, this) != RES_SUCCESS) {
+    delete Sched;
+    return nullptr;
+  }
+
+  InstCount ExecCost;
+  CmputNormCost_(Sched, CCM_DYNMC, ExecCost, true);
+
+  Logger::Event("IndependentPartsResult", "length", Sched->GetCrntLngth(), //
+                "spill_cost", Sched->GetSpillCost(), "cost", Sched->GetCost(),
+                "length_lower_bound", schedLwrBound_);
+  return Sched;
 }
 
 void SchedRegion::CalculateUpperBounds(bool BbSchedulerEnabled) {
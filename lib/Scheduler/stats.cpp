@@ -4,6 +4,13 @@
 
 using namespace llvm::opt_sched::stats;
 
+// The number of live PauseSampling instances.
+static int samplingPauseDepth = 0;
+
+PauseSampling::PauseSampling() { samplingPauseDepth++; }
+
+PauseSampling::~PauseSampling() { samplingPauseDepth--; }
+
 template <class T>
 DistributionStat<T>::DistributionStat(const string name) : Stat(name) {
   sum_ = 0;
@@ -13,6 +20,8 @@ DistributionStat<T>::DistributionStat(const string name) : Stat(name) {
 }
 
 template <class T> void DistributionStat<T>::Record(T value) {
+  if (samplingPauseDepth > 0)
+    return;
   count_++;
   sum_ += value;
   if (value < min_)
@@ -79,6 +88,8 @@ template <class T> void IndexedSetStat<T>::Print(std::ostream &out) const {
 
 void TimeoutStat::Record(int regionNumber, InstCount instCount, int lowerBound,
                          int upperBound) {
+  if (samplingPauseDepth > 0)
+    return;
   entries_.push_back(Entry(regionNumber, instCount, lowerBound, upperBound));
 }
 
@@ -166,6 +177,9 @@ IntDistributionStat regionBuildTime("Region build time");
 IntDistributionStat heuristicTime("Heuristic time");
 IntDistributionStat AcoTime("ACO time");
 IntDistributionStat boundComputationTime("Bound computation time");
+IntDistributionStat
+    lowerBoundComputationTime("Lower bound computation time");
+IntDistributionStat relaxedLowerBoundTime("Relaxed lower bound time");
 IntDistributionStat enumerationTime("Enumeration time");
 IntDistributionStat
     enumerationToHeuristicTimeRatio("Enumeration to heuristic time ratio");
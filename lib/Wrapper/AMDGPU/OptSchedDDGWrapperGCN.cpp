@@ -19,7 +19,7 @@ using namespace llvm::opt_sched;
 
 OptSchedDDGWrapperGCN::OptSchedDDGWrapperGCN(MachineSchedContext *Context,
                                              ScheduleDAGOptSched *DAG,
-                                             OptSchedMachineModel *MM,
+                                             const OptSchedMachineModel *MM,
                                              LATENCY_PRECISION LatencyPrecision,
                                              const std::string &RegionID)
     : OptSchedDDGWrapperBasic(Context, DAG, MM, LatencyPrecision, RegionID),
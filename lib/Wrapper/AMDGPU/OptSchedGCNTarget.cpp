@@ -71,13 +71,15 @@ public:
 
   std::unique_ptr<OptSchedDDGWrapperBase>
   createDDGWrapper(llvm::MachineSchedContext *Context, ScheduleDAGOptSched *DAG,
-                   OptSchedMachineModel *MM, LATENCY_PRECISION LatencyPrecision,
+                   const OptSchedMachineModel *MM,
+                   LATENCY_PRECISION LatencyPrecision,
                    const std::string &RegionID) override {
     return llvm::make_unique<OptSchedDDGWrapperGCN>(Context, DAG, MM,
                                                     LatencyPrecision, RegionID);
   }
 
-  void initRegion(llvm::ScheduleDAGInstrs *DAG, MachineModel *MM_) override;
+  void initRegion(llvm::ScheduleDAGInstrs *DAG,
+                  const MachineModel *MM_) override;
 
   void finalizeRegion(const InstSchedule *Schedule) override;
 
@@ -144,7 +146,7 @@ void OptSchedGCNTarget::dumpOccupancyInfo(const InstSchedule *Schedule) const {
 #endif
 
 void OptSchedGCNTarget::initRegion(llvm::ScheduleDAGInstrs *DAG_,
-                                   MachineModel *MM_) {
+                                   const MachineModel *MM_) {
   DAG = static_cast<ScheduleDAGOptSched *>(DAG_);
   MF = &DAG->MF;
   MFI =
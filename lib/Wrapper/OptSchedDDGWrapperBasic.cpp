@@ -50,7 +50,7 @@ static std::unique_ptr<LLVMRegTypeFilter> createLLVMRegTypeFilter(
 
 OptSchedDDGWrapperBasic::OptSchedDDGWrapperBasic(
     MachineSchedContext *Context, ScheduleDAGOptSched *DAG,
-    OptSchedMachineModel *MM, LATENCY_PRECISION LatencyPrecision,
+    const OptSchedMachineModel *MM, LATENCY_PRECISION LatencyPrecision,
     const std::string &RegionID)
     : DataDepGraph(MM, LatencyPrecision), MM(MM), Contex(Context), DAG(DAG),
       RTFilter(nullptr) {
@@ -30,7 +30,8 @@ class OptSchedMachineModel;
 class OptSchedDDGWrapperBasic : public DataDepGraph {
 public:
   OptSchedDDGWrapperBasic(llvm::MachineSchedContext *Context,
-                          ScheduleDAGOptSched *DAG, OptSchedMachineModel *MM,
+                          ScheduleDAGOptSched *DAG,
+                          const OptSchedMachineModel *MM,
                           LATENCY_PRECISION LatencyPrecision,
                           const std::string &RegionID);
 
@@ -53,7 +54,7 @@ public:
 
 protected:
   // A convenience machMdl_ pointer casted to OptSchedMachineModel*.
-  OptSchedMachineModel *MM;
+  const OptSchedMachineModel *MM;
 
   // The LLVM scheduler root class, used to access environment
   // and target info.
@@ -29,13 +29,15 @@ public:
 
   std::unique_ptr<OptSchedDDGWrapperBase>
   createDDGWrapper(llvm::MachineSchedContext *Context, ScheduleDAGOptSched *DAG,
-                   OptSchedMachineModel *MM, LATENCY_PRECISION LatencyPrecision,
+                   const OptSchedMachineModel *MM,
+                   LATENCY_PRECISION LatencyPrecision,
                    const std::string &RegionID) override {
     return llvm::make_unique<OptSchedDDGWrapperBasic>(
         Context, DAG, MM, LatencyPrecision, RegionID);
   }
 
-  void initRegion(llvm::ScheduleDAGInstrs *DAG, MachineModel *MM_) override {
+  void initRegion(llvm::ScheduleDAGInstrs *DAG,
+                  const MachineModel *MM_) override {
     MM = MM_;
   }
   void finalizeRegion(const InstSchedule *Schedule) override {}
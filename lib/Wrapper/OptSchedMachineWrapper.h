@@ -34,7 +34,9 @@ public:
   // optimal scheduler machine model
   void convertMachineModel(const llvm::ScheduleDAGInstrs &dag,
                            const llvm::RegisterClassInfo *regClassInfo);
-  MachineModelGenerator *getMMGen() { return MMGen.get(); }
+  // The generator adds instruction types to this model while scheduling.
+  // Such models are never shared between functions.
+  MachineModelGenerator *getMMGen() const { return MMGen.get(); }
   ~OptSchedMachineModel() = default;
 
 private:
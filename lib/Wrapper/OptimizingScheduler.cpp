@@ -27,6 +27,7 @@
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/CodeGen/ScheduleDAGInstrs.h"
 #include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -35,6 +36,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #define DEBUG_TYPE "optsched"
@@ -207,6 +211,51 @@ void ScheduleDAGOptSched::addGraphTransformations(
   }
 }
 
+// Returns the converted machine model for the DAG's subtarget. Converting
+// one parses the machine model file, so the converted models are shared by
+// every function scheduled for the same subtarget and register pressure
+// limits with the same, unmodified file. Models that generate instruction
+// types on the fly keep a pointer to the DAG they were created for and are
+// never shared. Only their generator modifies them after conversion.
+static std::shared_ptr<const OptSchedMachineModel>
+getMachineModel(OptSchedTarget &OST, const char *Path,
+                const ScheduleDAGInstrs &DAG,
+                const RegisterClassInfo *RegClassInfo) {
+  auto createModel = [&]() -> std::shared_ptr<const OptSchedMachineModel> {
+    std::shared_ptr<OptSchedMachineModel> Model = OST.createMachineModel(Path);
+    Model->convertMachineModel(DAG, RegClassInfo);
+    return Model;
+  };
+
+  sys::fs::file_status Status;
+  if (SchedulerOptions::getInstance().GetBool("GENERATE_MACHINE_MODEL",
+                                              false) ||
+      sys::fs::status(Path, Status))
+    return createModel();
+
+  // Everything the converted model depends on.
+  const TargetSubtargetInfo &ST = DAG.MF.getSubtarget();
+  std::string Key;
+  raw_string_ostream KeyStream(Key);
+  KeyStream << Path << '\0'
+            << Status.getLastModificationTime().time_since_epoch().count()
+            << '\0' << Status.getSize() << '\0'
+            << DAG.TM.getTargetTriple().str() << '\0' << ST.getCPU() << '\0'
+            << ST.getFeatureString();
+  for (unsigned PSet = 0; PSet < DAG.TRI->getNumRegPressureSets(); ++PSet)
+    KeyStream << '\0' << RegClassInfo->getRegPressureSetLimit(PSet);
+  KeyStream.flush();
+
+  static std::mutex CacheMutex;
+  static std::map<std::string, std::shared_ptr<const OptSchedMachineModel>>
+      Cache;
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  std::shared_ptr<const OptSchedMachineModel> &Model = Cache[Key];
+  if (!Model)
+    Model = createModel();
+  return Model;
+}
+
 ScheduleDAGOptSched::ScheduleDAGOptSched(
     MachineSchedContext *C, std::unique_ptr<MachineSchedStrategy> S)
     : ScheduleDAGMILive(C, std::move(S)), C(C) {
@@ -215,13 +264,14 @@ ScheduleDAGOptSched::ScheduleDAGOptSched(
   // Find the native paths to the scheduler configuration files.
   getRealCfgPaths();
 
-  // Setup config object
-  Config &schedIni = SchedulerOptions::getInstance();
+  // Setup config object. The files are only parsed again if they changed
+  // since the last function was scheduled.
+  SchedulerOptions &schedIni = SchedulerOptions::getInstance();
   // load OptSched ini file
-  schedIni.Load(PathCfgS.c_str());
+  schedIni.LoadIfChanged(PathCfgS.c_str());
 
   // load hot functions ini file
-  HotFunctions.Load(PathCfgHF.c_str());
+  HotFunctions = loadCachedConfig(PathCfgHF.c_str());
 
   // Load config files for the OptScheduler
   loadOptSchedConfig();
@@ -235,9 +285,8 @@ ScheduleDAGOptSched::ScheduleDAGOptSched(
         OptSchedTargetRegistry::Registry.getFactoryWithName("generic");
 
   OST = TargetFactory();
-  MM = OST->createMachineModel(PathCfgMM.c_str());
-  MM->convertMachineModel(static_cast<ScheduleDAGInstrs &>(*this),
-                          RegClassInfo);
+  MM = getMachineModel(*OST, PathCfgMM.c_str(),
+                       static_cast<ScheduleDAGInstrs &>(*this), RegClassInfo);
 }
 
 void ScheduleDAGOptSched::SetupLLVMDag() {
@@ -473,6 +522,17 @@ void ScheduleDAGOptSched::schedule() {
       region->InitSecondPass(EnableMutations);
   }
 
+  region->setOptimalityGap(EnumStopGap, EnumStopGapPercent);
+  if (PrintEnumProgress)
+    region->setImprovementCallback([](const EnumImprovement &Improvement) {
+      Logger::Event("EnumImprovement", "elapsed", Improvement.elapsed, //
+                    "length", Improvement.length,                      //
+                    "cost", Improvement.cost,                          //
+                    "cost_lb", Improvement.costLwrBound,               //
+                    "spill_cost", Improvement.spillCost,               //
+                    "spill_cost_lb", Improvement.spillCostLwrBound);
+    });
+
   // Setup time before scheduling
   Utilities::startTime = std::chrono::steady_clock::now();
   // Schedule region.
@@ -657,6 +717,9 @@ void ScheduleDAGOptSched::loadOptSchedConfig() {
     IsTimeoutPerInst = true;
   else
     IsTimeoutPerInst = false;
+  EnumStopGap = schedIni.GetInt("ENUM_STOP_GAP", 0);
+  EnumStopGapPercent = schedIni.GetFloat("ENUM_STOP_GAP_PERCENT", 0);
+  PrintEnumProgress = schedIni.GetBool("PRINT_ENUM_PROGRESS", false);
   int randomSeed = schedIni.GetInt("RANDOM_SEED", 0);
   if (randomSeed == 0)
     randomSeed = time(NULL);
@@ -674,7 +737,7 @@ bool ScheduleDAGOptSched::isOptSchedEnabled() const {
     // get the name of the function this scheduler was created for
     std::string functionName = C->MF->getFunction().getName();
     // check the list of hot functions for the name of the current function
-    return HotFunctions.GetBool(functionName, false);
+    return HotFunctions->GetBool(functionName, false);
   } else if (optSchedOption == "NO") {
     return false;
   }
@@ -809,7 +872,7 @@ bool ScheduleDAGOptSched::shouldPrintSpills() const {
     return false;
   } else if (printSpills == "HOT_ONLY") {
     std::string functionName = C->MF->getFunction().getName();
-    return HotFunctions.GetBool(functionName, false);
+    return HotFunctions->GetBool(functionName, false);
   }
 
   llvm::report_fatal_error(
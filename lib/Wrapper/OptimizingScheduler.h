@@ -73,12 +73,13 @@ protected:
   // The OptSched target machine.
   std::unique_ptr<OptSchedTarget> OST;
 
-  // into the OptSched machine model
-  std::unique_ptr<OptSchedMachineModel> MM;
+  // into the OptSched machine model, which may be shared with other functions
+  // scheduled for the same subtarget.
+  std::shared_ptr<const OptSchedMachineModel> MM;
 
   // A list of functions that are indicated as candidates for the
   // OptScheduler
-  Config HotFunctions;
+  std::shared_ptr<const Config> HotFunctions;
 
   // Struct for setting the pruning strategy
   Pruning PruningStrategy;
@@ -149,6 +150,14 @@ protected:
   // timout per block
   bool IsTimeoutPerInst;
 
+  // Stop enumerating once the best schedule is within this margin, or this
+  // percentage, of the cost lower bound. Zero proves optimality.
+  int EnumStopGap;
+  float EnumStopGapPercent;
+
+  // Whether to log each improvement found by the enumerator.
+  bool PrintEnumProgress;
+
   // The maximum number of instructions to schedule with our scheduler.
   // Beyond that, it uses the heuristic scheduler.
   unsigned MaxRegionInstrs;
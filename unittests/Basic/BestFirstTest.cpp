@@ -0,0 +1,154 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads, followed by the search strategy of
+// the enumerator.
+const char EnumConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS NO
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+const Milliseconds Timeout = 5000;
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> GraphParams;
+
+struct EnumResult {
+  FUNC_RESULT Rslt;
+  InstCount Cost;
+  InstCount Length;
+  // The number of target lengths the enumerator searched.
+  int EnumCnt;
+};
+
+// On a single issue machine, the list scheduler is optimal on most of these
+// graphs and the enumerator never runs, so the tests issue two instructions
+// per cycle.
+class BestFirstTest : public testing::TestWithParam<GraphParams> {
+protected:
+  BestFirstTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    Prirts.cnt = 2;
+    Prirts.isDynmc = false;
+    Prirts.vctr[0] = LSH_CP;
+    Prirts.vctr[1] = LSH_NID;
+    Logger::SetLogStream(Log);
+  }
+
+  ~BestFirstTest() override { Logger::SetLogStream(OldLog); }
+
+  // Schedules a fresh copy of the parameters' graph with the given search
+  // strategy appended to the options.
+  EnumResult schedule(const std::string &Strategy) {
+    std::istringstream Config(EnumConfig + Strategy);
+    SchedulerOptions::getInstance().Load(Config);
+
+    RandomDDG DDG(&Model, std::get<0>(GetParam()), std::get<1>(GetParam()),
+                  std::get<2>(GetParam()));
+    Pruning PruningStrategy = {true, true, true, true, false};
+    BBWithSpill Region(&Target, &DDG, 0, 8, LBA_LC, Prirts, Prirts, true,
+                       PruningStrategy, false, true, 0, SCF_PERP, SCHED_LIST,
+                       GT_POSITION::NONE);
+
+    Log.str("");
+    bool IsLstOptml = false;
+    InstCount HurstcCost, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    EnumResult Result;
+    Result.Rslt = Region.FindOptimalSchedule(
+        Timeout, Timeout, IsLstOptml, Result.Cost, Result.Length, HurstcCost,
+        HurstcLength, Sched, false, BLOCKS_TO_KEEP::ALL);
+    Result.EnumCnt = countEvents("Enumerating");
+    EXPECT_NE(Sched, nullptr);
+    if (Sched != nullptr) {
+      EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+    }
+    delete Sched;
+    return Result;
+  }
+
+  // The number of the given events in the log.
+  int countEvents(const std::string &EventID) const {
+    const std::string Text = Log.str();
+    const std::string Key = "\"event_id\": \"" + EventID + "\"";
+    int Count = 0;
+    for (size_t Pos = Text.find(Key); Pos != std::string::npos;
+         Pos = Text.find(Key, Pos + 1))
+      Count++;
+    return Count;
+  }
+
+  MachineModel Model;
+  FakeTarget Target;
+  SchedPriorities Prirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(BestFirstTest, EnumeratorRuns) {
+  // Otherwise the other tests compare two list schedules.
+  EnumResult DFS = schedule("ENUM_SEARCH_STRATEGY DFS\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_GT(DFS.EnumCnt, 0);
+}
+
+TEST_P(BestFirstTest, FindsTheSameScheduleAsDFS) {
+  EnumResult DFS = schedule("ENUM_SEARCH_STRATEGY DFS\n");
+  EnumResult BestFrst = schedule("ENUM_SEARCH_STRATEGY BEST_FIRST\n"
+                                 "BEST_FIRST_NODE_BUDGET 100000\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_EQ(RES_SUCCESS, BestFrst.Rslt);
+  EXPECT_EQ(DFS.Length, BestFrst.Length);
+  EXPECT_EQ(DFS.Cost, BestFrst.Cost);
+}
+
+TEST_P(BestFirstTest, FallsBackToDFSWhenOutOfBudget) {
+  // A budget of one node leaves the frontier full after the first expansion,
+  // so the search of every length finishes depth first.
+  EnumResult DFS = schedule("ENUM_SEARCH_STRATEGY DFS\n");
+  EnumResult Fallback = schedule("ENUM_SEARCH_STRATEGY BEST_FIRST\n"
+                                 "BEST_FIRST_NODE_BUDGET 1\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Fallback.Rslt);
+  EXPECT_EQ(DFS.Length, Fallback.Length);
+  EXPECT_EQ(DFS.Cost, Fallback.Cost);
+}
+
+// Graphs on which the list schedule is not proven optimal, so that the
+// enumerator searches at least one length.
+INSTANTIATE_TEST_CASE_P(RandomGraphs, BestFirstTest,
+                        testing::Values(std::make_tuple(12, 0.3, 3u),
+                                        std::make_tuple(12, 0.3, 7u),
+                                        std::make_tuple(16, 0.3, 7u),
+                                        std::make_tuple(20, 0.3, 3u),
+                                        std::make_tuple(20, 0.3, 5u),
+                                        std::make_tuple(20, 0.3, 7u),
+                                        std::make_tuple(24, 0.3, 3u),
+                                        std::make_tuple(24, 0.3, 5u)), );
+} // namespace
@@ -0,0 +1,167 @@
+#include "opt-sched/Scheduler/bit_vector.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// Sizes that exercise partial units and both the vector and scalar tails.
+class BitVectorTest : public testing::TestWithParam<int> {};
+
+BitVector makeVector(int Size, int Stride, int Offset) {
+  BitVector BV(Size);
+  for (int I = Offset; I < Size; I += Stride)
+    BV.SetBit(I);
+  return BV;
+}
+
+TEST_P(BitVectorTest, SetAndGetBits) {
+  BitVector BV(GetParam());
+  EXPECT_EQ(GetParam(), BV.GetSize());
+  EXPECT_EQ(0, BV.GetOneCnt());
+
+  BV.SetBit(0);
+  BV.SetBit(GetParam() - 1);
+  BV.SetBit(GetParam() - 1);
+  EXPECT_TRUE(BV.GetBit(0));
+  EXPECT_TRUE(BV.GetBit(GetParam() - 1));
+  EXPECT_EQ(GetParam() == 1 ? 1 : 2, BV.GetOneCnt());
+
+  BV.SetBit(0, false);
+  EXPECT_FALSE(BV.GetBit(0));
+  BV.Reset();
+  EXPECT_EQ(0, BV.GetOneCnt());
+  EXPECT_FALSE(BV.GetBit(GetParam() - 1));
+}
+
+TEST_P(BitVectorTest, InPlaceOperationsMatchBitwiseDefinition) {
+  const int Size = GetParam();
+  BitVector A = makeVector(Size, 2, 0);
+  BitVector B = makeVector(Size, 3, 0);
+
+  BitVector And(Size), Or(Size), AndNot(Size);
+  And = A;
+  And.AndWith(B);
+  Or = A;
+  Or.OrWith(B);
+  AndNot = A;
+  AndNot.AndNotWith(B);
+
+  int AndCnt = 0, OrCnt = 0, AndNotCnt = 0;
+  for (int I = 0; I < Size; ++I) {
+    bool InA = I % 2 == 0, InB = I % 3 == 0;
+    EXPECT_EQ(InA && InB, And.GetBit(I));
+    EXPECT_EQ(InA || InB, Or.GetBit(I));
+    EXPECT_EQ(InA && !InB, AndNot.GetBit(I));
+    AndCnt += InA && InB;
+    OrCnt += InA || InB;
+    AndNotCnt += InA && !InB;
+  }
+  EXPECT_EQ(AndCnt, And.GetOneCnt());
+  EXPECT_EQ(OrCnt, Or.GetOneCnt());
+  EXPECT_EQ(AndNotCnt, AndNot.GetOneCnt());
+  EXPECT_EQ(AndCnt, A.GetAndOneCnt(B));
+}
+
+TEST_P(BitVectorTest, DestinationOperationsMatchInPlaceOperations) {
+  const int Size = GetParam();
+  BitVector A = makeVector(Size, 5, 1);
+  BitVector B = makeVector(Size, 7, 1);
+
+  BitVector Dst(Size), Expected(Size);
+  Dst.SetToAnd(A, B);
+  Expected = A;
+  Expected.AndWith(B);
+  EXPECT_TRUE(Dst == Expected);
+
+  Dst.SetToOr(A, B);
+  Expected = A;
+  Expected.OrWith(B);
+  EXPECT_TRUE(Dst == Expected);
+
+  Dst.SetToAndNot(A, B);
+  Expected = A;
+  Expected.AndNotWith(B);
+  EXPECT_TRUE(Dst == Expected);
+
+  // The destination may alias an operand.
+  A.SetToAnd(A, B);
+  Expected = B;
+  Expected.AndWith(makeVector(Size, 5, 1));
+  EXPECT_TRUE(A == Expected);
+}
+
+TEST_P(BitVectorTest, SubsetAndIntersection) {
+  const int Size = GetParam();
+  BitVector Evens = makeVector(Size, 2, 0);
+  BitVector Fours = makeVector(Size, 4, 0);
+  BitVector Odds = makeVector(Size, 2, 1);
+
+  EXPECT_TRUE(Fours.IsSubVector(Evens));
+  EXPECT_TRUE(Evens.IsSubVector(&Evens));
+  EXPECT_EQ(Size <= 1, Odds.IsSubVector(Evens));
+  EXPECT_TRUE(Evens.Intersects(Fours));
+  EXPECT_FALSE(Evens.Intersects(Odds));
+}
+
+TEST_P(BitVectorTest, IteratesOverSetBits) {
+  const int Size = GetParam();
+  BitVector BV = makeVector(Size, 3, 2);
+  BV.SetBit(Size - 1);
+
+  std::vector<int> Expected;
+  for (int I = 0; I < Size; ++I)
+    if (BV.GetBit(I))
+      Expected.push_back(I);
+
+  std::vector<int> Result;
+  for (int I = BV.FindFrstOne(); I != -1; I = BV.FindNxtOne(I))
+    Result.push_back(I);
+
+  EXPECT_EQ(Expected, Result);
+}
+
+TEST_P(BitVectorTest, EqualityComparesAllBits) {
+  const int Size = GetParam();
+  BitVector A = makeVector(Size, 2, 0);
+  BitVector B = makeVector(Size, 2, 0);
+  EXPECT_TRUE(A == B);
+
+  A.SetBit(Size - 1, !A.GetBit(Size - 1));
+  EXPECT_FALSE(A == B);
+}
+
+INSTANTIATE_TEST_CASE_P(Sizes, BitVectorTest,
+                        testing::Values(1, 63, 64, 65, 255, 256, 300, 1000), );
+
+TEST(BitVector, ReconstructClearsBits) {
+  BitVector BV(100);
+  BV.SetBit(42);
+  BV.Construct(100);
+  EXPECT_EQ(0, BV.GetOneCnt());
+  EXPECT_FALSE(BV.GetBit(42));
+
+  BV.Construct(500);
+  EXPECT_EQ(500, BV.GetSize());
+  EXPECT_EQ(-1, BV.FindFrstOne());
+}
+
+TEST(WeightedBitVector, TracksWeightedCount) {
+  WeightedBitVector BV(130);
+  BV.SetBit(1, true, 2);
+  BV.SetBit(129, true, 3);
+  BV.SetBit(129, true, 3);
+  EXPECT_EQ(2, BV.GetOneCnt());
+  EXPECT_EQ(5, BV.GetWghtedCnt());
+
+  BV.SetBit(1, false, 2);
+  EXPECT_EQ(1, BV.GetOneCnt());
+  EXPECT_EQ(3, BV.GetWghtedCnt());
+
+  BV.Reset();
+  EXPECT_EQ(0, BV.GetOneCnt());
+  EXPECT_EQ(0, BV.GetWghtedCnt());
+}
+} // namespace
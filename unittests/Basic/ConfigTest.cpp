@@ -1,10 +1,14 @@
 #include "opt-sched/Scheduler/config.h"
 
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include <fstream>
 #include <sstream>
 
 #include "gtest/gtest.h"
 
 using llvm::opt_sched::Config;
+using llvm::opt_sched::loadCachedConfig;
 using llvm::opt_sched::SchedulerOptions;
 
 namespace {
@@ -160,4 +164,22 @@ INSTANTIATE_TEST_CASE_P(
         {{832.123f, 43}, "832.123,43"},
     }), );
 
+TEST(Config, CachedConfigIsParsedAgainOnlyWhenChanged) {
+  llvm::SmallString<128> Path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("sched", "ini", Path));
+  std::ofstream(Path.c_str()) << "KEY VALUE\n";
+
+  std::shared_ptr<const Config> First = loadCachedConfig(Path.str().str());
+  EXPECT_EQ("VALUE", First->GetString("KEY"));
+  EXPECT_EQ(First, loadCachedConfig(Path.str().str()));
+
+  std::ofstream(Path.c_str()) << "KEY OTHER_VALUE\n";
+  std::shared_ptr<const Config> Changed = loadCachedConfig(Path.str().str());
+  EXPECT_NE(First, Changed);
+  EXPECT_EQ("OTHER_VALUE", Changed->GetString("KEY"));
+  EXPECT_EQ("VALUE", First->GetString("KEY"));
+
+  llvm::sys::fs::remove(Path);
+}
+
 } // namespace
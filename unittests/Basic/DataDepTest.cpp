@@ -0,0 +1,318 @@
+#include "opt-sched/Scheduler/data_dep.h"
+
+#include "opt-sched/Scheduler/graph_trans.h"
+#include "random_ddg.h"
+#include "simple_machine_model.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+std::vector<int> recursiveNeighbors(SchedInstruction *Inst, DIRECTION Dir) {
+  std::vector<int> Nums;
+  for (GraphNode &Node : *Inst->GetRcrsvNghbrLst(Dir))
+    Nums.push_back(Node.GetNum());
+  return Nums;
+}
+
+// Expects everything UpdateSetupForSchdulng() computes to be the same in
+// both graphs.
+void expectSameSetup(DataDepGraph &Expected, DataDepGraph &Actual) {
+  const int NumInsts = Expected.GetInstCnt();
+  ASSERT_EQ(NumInsts, Actual.GetInstCnt());
+  EXPECT_EQ(Expected.GetSchedLwrBound(), Actual.GetSchedLwrBound());
+
+  for (int I = 0; I < NumInsts; ++I) {
+    SchedInstruction *ExpectedI = Expected.GetInstByIndx(I);
+    SchedInstruction *ActualI = Actual.GetInstByIndx(I);
+    EXPECT_EQ(Expected.GetInstByTplgclOrdr(I)->GetNum(),
+              Actual.GetInstByTplgclOrdr(I)->GetNum());
+
+    for (DIRECTION Dir : {DIR_FRWRD, DIR_BKWRD}) {
+      EXPECT_EQ(ExpectedI->GetCrtclPath(Dir), ActualI->GetCrtclPath(Dir));
+      EXPECT_EQ(ExpectedI->GetLwrBound(Dir), ActualI->GetLwrBound(Dir));
+      EXPECT_EQ(recursiveNeighbors(ExpectedI, Dir),
+                recursiveNeighbors(ActualI, Dir))
+          << "instruction " << I << ", direction " << Dir;
+    }
+
+    for (int J = 0; J < NumInsts; ++J) {
+      SchedInstruction *ExpectedJ = Expected.GetInstByIndx(J);
+      SchedInstruction *ActualJ = Actual.GetInstByIndx(J);
+      EXPECT_EQ(ExpectedI->IsRcrsvScsr(ExpectedJ),
+                ActualI->IsRcrsvScsr(ActualJ))
+          << "from " << I << " to " << J;
+      EXPECT_EQ(Expected.GetRltvCrtclPath(I, J), Actual.GetRltvCrtclPath(I, J))
+          << "from " << I << " to " << J;
+    }
+  }
+}
+
+class DataDepGraphUpdateTest : public RandomDDGTest {
+protected:
+  DataDepGraphUpdateTest() : Incremental(DDG), Full(&Model, GetParam()) {
+    Full.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+  }
+
+  // Updates one graph incrementally and the other one from scratch, which
+  // UpdateSetupForSchdulng() does when the last setup skipped the closure.
+  void updateBoth() {
+    ASSERT_EQ(RES_SUCCESS, Incremental.UpdateSetupForSchdulng(true));
+    ASSERT_EQ(RES_SUCCESS, Full.UpdateSetupForSchdulng(false));
+    ASSERT_EQ(RES_SUCCESS, Full.UpdateSetupForSchdulng(true));
+  }
+
+  RandomDDG &Incremental;
+  RandomDDG Full;
+};
+
+TEST_P(DataDepGraphUpdateTest, NodeSuperiorityMatchesFullUpdate) {
+  for (RandomDDG *Graph : {&Incremental, &Full})
+    StaticNodeSupTrans(Graph, /* IsMultiPass = */ true).ApplyTrans();
+
+  updateBoth();
+  expectSameSetup(Full, Incremental);
+}
+
+TEST_P(DataDepGraphUpdateTest, LatencyIncreaseMatchesFullUpdate) {
+  const int NumInsts = Incremental.GetInstCnt();
+  for (RandomDDG *Graph : {&Incremental, &Full}) {
+    // Lengthen the first edge out of every third instruction.
+    for (int I = 0; I < NumInsts; I += 3) {
+      SchedInstruction *Inst = Graph->GetInstByIndx(I);
+      UDT_GLABEL Latency;
+      SchedInstruction *Scsr = Inst->GetFrstScsr(NULL, &Latency);
+      if (Scsr)
+        Graph->CreateEdge(Inst, Scsr, Latency + 2, DEP_OTHER);
+    }
+  }
+
+  updateBoth();
+  expectSameSetup(Full, Incremental);
+}
+
+TEST_P(DataDepGraphUpdateTest, NoChangesKeepSetup) {
+  ASSERT_EQ(RES_SUCCESS, Incremental.UpdateSetupForSchdulng(true));
+  expectSameSetup(Full, Incremental);
+}
+
+TEST_P(DataDepGraphUpdateTest, DelayedClosureMatchesFullSetup) {
+  RandomDDG Delayed(&Model, GetParam());
+  ASSERT_EQ(RES_SUCCESS,
+            Delayed.SetupForSchdulng(/* cmputTrnstvClsr = */ false));
+  ASSERT_EQ(RES_SUCCESS, Delayed.CmputTrnstvClsr());
+  expectSameSetup(Full, Delayed);
+}
+
+INSTANTIATE_TEST_CASE_P(RandomGraphs, DataDepGraphUpdateTest,
+                        testing::ValuesIn(randomDDGParams()));
+
+// The longest path from each instruction to each other one, found by
+// searching every path from each instruction.
+std::vector<std::vector<int>> referenceLongestPaths(DataDepGraph &DDG) {
+  const int NumInsts = DDG.GetInstCnt();
+  std::vector<std::vector<int>> Paths(
+      NumInsts, std::vector<int>(NumInsts, INVALID_VALUE));
+
+  for (int I = 0; I < NumInsts; ++I) {
+    std::vector<std::pair<int, int>> Stack = {std::make_pair(I, 0)};
+    while (!Stack.empty()) {
+      std::pair<int, int> Top = Stack.back();
+      Stack.pop_back();
+      if (Top.second <= Paths[I][Top.first])
+        continue;
+      Paths[I][Top.first] = Top.second;
+      for (GraphEdge &Edge : DDG.GetInstByIndx(Top.first)->GetSuccessors())
+        Stack.push_back(
+            std::make_pair(Edge.to->GetNum(), Top.second + Edge.label));
+    }
+  }
+  return Paths;
+}
+
+void expectLongestPaths(DataDepGraph &DDG) {
+  std::vector<std::vector<int>> Expected = referenceLongestPaths(DDG);
+  for (int I = 0; I < DDG.GetInstCnt(); ++I) {
+    for (int J = 0; J < DDG.GetInstCnt(); ++J) {
+      EXPECT_EQ(Expected[I][J], DDG.GetRltvCrtclPath(I, J))
+          << "from " << I << " to " << J;
+      SchedInstruction *InstI = DDG.GetInstByIndx(I);
+      SchedInstruction *InstJ = DDG.GetInstByIndx(J);
+      EXPECT_EQ(Expected[I][J], DDG.GetRltvCrtclPath(InstI, InstJ, DIR_FRWRD));
+      EXPECT_EQ(Expected[I][J], DDG.GetRltvCrtclPath(InstJ, InstI, DIR_BKWRD));
+    }
+  }
+}
+
+TEST_P(DataDepGraphUpdateTest, RelativeCriticalPathsAreLongestPaths) {
+  expectLongestPaths(Full);
+}
+
+TEST_P(DataDepGraphUpdateTest, LongRelativeCriticalPaths) {
+  // Paths this long do not fit the 16-bit matrix.
+  const int NumInsts = Full.GetInstCnt();
+  for (int I = 0; I < NumInsts; I += 2) {
+    SchedInstruction *Inst = Full.GetInstByIndx(I);
+    UDT_GLABEL Latency;
+    SchedInstruction *Scsr = Inst->GetFrstScsr(NULL, &Latency);
+    if (Scsr)
+      Full.CreateEdge(Inst, Scsr, Latency + 20000, DEP_OTHER);
+  }
+
+  ASSERT_EQ(RES_SUCCESS, Full.UpdateSetupForSchdulng(true));
+  expectLongestPaths(Full);
+}
+
+void expectSuperiorInsts(DataDepGraph &DDG) {
+  for (int I = 0; I < DDG.GetInstCnt(); ++I) {
+    SchedInstruction *Inst = DDG.GetInstByIndx(I);
+    const BitVector &Superior = DDG.GetSprirInsts(Inst);
+    for (int J = 0; J < DDG.GetInstCnt(); ++J) {
+      SchedInstruction *Other = DDG.GetInstByIndx(J);
+      bool Expected = I != J && Inst->GetScsrCnt() > 0 &&
+                      Inst->GetIssueType() == Other->GetIssueType() &&
+                      Inst->IsScsrDmntd(Other);
+      EXPECT_EQ(Expected, Superior.GetBit(J)) << J << " superior to " << I;
+    }
+  }
+}
+
+TEST_P(DataDepGraphUpdateTest, SuperiorInstsMatchPairwiseCheck) {
+  expectSuperiorInsts(Full);
+
+  // The sets are rebuilt after the edges change.
+  StaticNodeSupTrans(&Full, /* IsMultiPass = */ true).ApplyTrans();
+  ASSERT_EQ(RES_SUCCESS, Full.UpdateSetupForSchdulng(true));
+  expectSuperiorInsts(Full);
+}
+
+// The component of each instruction, numbered in order of each component's
+// first instruction, from a union-find over the edges between instructions.
+std::vector<int> referenceComponents(DataDepGraph &DDG) {
+  const int NumInsts = DDG.GetInstCnt() - 2;
+  std::vector<int> Parent(NumInsts);
+  std::iota(Parent.begin(), Parent.end(), 0);
+  auto Find = [&](int I) {
+    while (Parent[I] != I)
+      I = Parent[I] = Parent[Parent[I]];
+    return I;
+  };
+
+  for (int I = 0; I < NumInsts; ++I)
+    for (GraphEdge &Edge : DDG.GetInstByIndx(I)->GetSuccessors())
+      if (Edge.to->GetNum() < NumInsts)
+        Parent[Find(I)] = Find(Edge.to->GetNum());
+
+  std::vector<int> Number(NumInsts, INVALID_VALUE);
+  std::vector<int> Components(DDG.GetInstCnt(), INVALID_VALUE);
+  int NumComponents = 0;
+  for (int I = 0; I < NumInsts; ++I) {
+    if (Number[Find(I)] == INVALID_VALUE)
+      Number[Find(I)] = NumComponents++;
+    Components[I] = Number[Find(I)];
+  }
+  return Components;
+}
+
+// Renumbers the components in order of each component's first instruction.
+std::vector<int> canonicalComponents(const std::vector<InstCount> &Cmpnnts) {
+  std::vector<int> Number(Cmpnnts.size(), INVALID_VALUE);
+  std::vector<int> Components(Cmpnnts.size(), INVALID_VALUE);
+  int NumComponents = 0;
+  for (size_t I = 0; I < Cmpnnts.size(); ++I) {
+    if (Cmpnnts[I] == INVALID_VALUE)
+      continue;
+    if (Number[Cmpnnts[I]] == INVALID_VALUE)
+      Number[Cmpnnts[I]] = NumComponents++;
+    Components[I] = Number[Cmpnnts[I]];
+  }
+  return Components;
+}
+
+class DataDepCmpnntTest : public RandomDDGTest {};
+
+TEST_P(DataDepCmpnntTest, ComponentsMatchUnionFind) {
+  std::vector<InstCount> Cmpnnts;
+  const InstCount NumCmpnnts = DDG.FindIndpndntCmpnnts(Cmpnnts);
+
+  std::vector<int> Expected = referenceComponents(DDG);
+  EXPECT_EQ(Expected, canonicalComponents(Cmpnnts));
+  EXPECT_EQ(*std::max_element(Expected.begin(), Expected.end()) + 1,
+            NumCmpnnts);
+}
+
+TEST_P(DataDepCmpnntTest, ComponentGraphsCopyEdges) {
+  std::vector<InstCount> Cmpnnts;
+  const InstCount NumCmpnnts = DDG.FindIndpndntCmpnnts(Cmpnnts);
+
+  for (InstCount C = 0; C < NumCmpnnts; ++C) {
+    std::vector<InstCount> InstNums;
+    for (InstCount I = 0; I < DDG.GetInstCnt(); ++I)
+      if (Cmpnnts[I] == C)
+        InstNums.push_back(I);
+
+    DataDepCmpnntGraph Part(&DDG, &Model, InstNums, C);
+    ASSERT_EQ((InstCount)InstNums.size() + 2, Part.GetInstCnt());
+    EXPECT_EQ(DDG.GetRootInst()->GetNum(),
+              Part.GetFullInstNum(Part.GetRootInst()->GetNum()));
+    EXPECT_EQ(DDG.GetLeafInst()->GetNum(),
+              Part.GetFullInstNum(Part.GetLeafInst()->GetNum()));
+
+    for (size_t I = 0; I < InstNums.size(); ++I) {
+      std::vector<std::pair<int, int>> Expected, Actual;
+      for (GraphEdge &Edge : DDG.GetInstByIndx(InstNums[I])->GetSuccessors())
+        Expected.push_back(std::make_pair(Edge.to->GetNum(), Edge.label));
+      for (GraphEdge &Edge : Part.GetInstByIndx(I)->GetSuccessors())
+        Actual.push_back(std::make_pair(
+            (int)Part.GetFullInstNum(Edge.to->GetNum()), Edge.label));
+      EXPECT_EQ(Expected, Actual) << "instruction " << InstNums[I];
+    }
+  }
+}
+
+// The sorted (neighbor, latency) pairs of an instruction's edges.
+std::vector<std::pair<int, int>> sortedEdges(SchedInstruction *Inst,
+                                             DIRECTION Dir) {
+  std::vector<std::pair<int, int>> Edges;
+  for (GraphEdge &Edge : Dir == DIR_FRWRD ? Inst->GetSuccessors()
+                                          : Inst->GetPredecessors())
+    Edges.push_back(std::make_pair(Edge.GetOtherNode(Inst)->GetNum(),
+                                   Edge.label));
+  std::sort(Edges.begin(), Edges.end());
+  return Edges;
+}
+
+TEST_P(DataDepCmpnntTest, EquivalentInstsHaveSameEdges) {
+  const InstCount NumLinked = DDG.FindEquvlntClasses();
+
+  // Without registers, instructions are interchangeable exactly when they
+  // have the same edges.
+  const int NumInsts = DDG.GetInstCnt() - 2;
+  InstCount ExpectedLinked = 0;
+  for (int I = 0; I < NumInsts; ++I) {
+    SchedInstruction *Inst = DDG.GetInstByIndx(I);
+    SchedInstruction *Expected = nullptr;
+    for (int J = I - 1; J >= 0 && !Expected; --J) {
+      SchedInstruction *Other = DDG.GetInstByIndx(J);
+      if (sortedEdges(Inst, DIR_FRWRD) == sortedEdges(Other, DIR_FRWRD) &&
+          sortedEdges(Inst, DIR_BKWRD) == sortedEdges(Other, DIR_BKWRD))
+        Expected = Other;
+    }
+    EXPECT_EQ(Expected, Inst->GetPrevEquvlnt()) << "instruction " << I;
+    if (Expected)
+      ExpectedLinked++;
+  }
+  EXPECT_EQ(ExpectedLinked, NumLinked);
+  EXPECT_EQ(nullptr, DDG.GetRootInst()->GetPrevEquvlnt());
+  EXPECT_EQ(nullptr, DDG.GetLeafInst()->GetPrevEquvlnt());
+}
+
+INSTANTIATE_TEST_CASE_P(RandomGraphs, DataDepCmpnntTest,
+                        testing::ValuesIn(randomDDGParams()));
+} // namespace
@@ -0,0 +1,131 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads, followed by whether the region
+// delays the transitive closure until after the heuristic.
+const char EnumConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS NO
+ENUM_SEARCH_STRATEGY DFS
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+const Milliseconds Timeout = 5000;
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> GraphParams;
+
+struct RegionResult {
+  FUNC_RESULT Rslt;
+  bool IsLstOptml;
+  InstCount Cost;
+  InstCount Length;
+  // Whether the closure was computed after the heuristic.
+  bool RanDelayedClosure;
+};
+
+class DelayedClosureTest : public testing::TestWithParam<GraphParams> {
+protected:
+  DelayedClosureTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    Prirts.cnt = 2;
+    Prirts.isDynmc = false;
+    Prirts.vctr[0] = LSH_CP;
+    Prirts.vctr[1] = LSH_NID;
+    Logger::SetLogStream(Log);
+  }
+
+  ~DelayedClosureTest() override { Logger::SetLogStream(OldLog); }
+
+  // Schedules a fresh copy of the parameters' graph with the closure delayed
+  // or computed up front.
+  RegionResult schedule(bool DelayClosure) {
+    std::istringstream Config(std::string(EnumConfig) +
+                              "DELAY_TRANSITIVE_CLOSURE " +
+                              (DelayClosure ? "YES\n" : "NO\n"));
+    SchedulerOptions::getInstance().Load(Config);
+
+    RandomDDG DDG(&Model, std::get<0>(GetParam()), std::get<1>(GetParam()),
+                  std::get<2>(GetParam()));
+    DDG.addRegisters(std::get<2>(GetParam()));
+    Pruning PruningStrategy = {true, true, true, true, false};
+    // Without a spill cost, the heuristic schedule often meets the bounds.
+    BBWithSpill Region(&Target, &DDG, 0, 8, LBA_LC, Prirts, Prirts, true,
+                       PruningStrategy, false, true, /* SCW = */ 0, SCF_PERP,
+                       SCHED_LIST, GT_POSITION::NONE);
+
+    Log.str("");
+    RegionResult Result;
+    Result.IsLstOptml = false;
+    InstCount HurstcCost, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    Result.Rslt = Region.FindOptimalSchedule(
+        Timeout, Timeout, Result.IsLstOptml, Result.Cost, Result.Length,
+        HurstcCost, HurstcLength, Sched, false, BLOCKS_TO_KEEP::ALL);
+    Result.RanDelayedClosure =
+        Log.str().find("\"event_id\": \"RunningTransitiveClosure\"") !=
+        std::string::npos;
+    EXPECT_NE(Sched, nullptr);
+    if (Sched != nullptr) {
+      EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+    }
+    delete Sched;
+    return Result;
+  }
+
+  MachineModel Model;
+  FakeTarget Target;
+  SchedPriorities Prirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(DelayedClosureTest, FindsTheSameScheduleAsWithUpFrontClosure) {
+  RegionResult UpFront = schedule(false);
+  RegionResult Delayed = schedule(true);
+  ASSERT_EQ(RES_SUCCESS, UpFront.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Delayed.Rslt);
+  EXPECT_FALSE(UpFront.RanDelayedClosure);
+  EXPECT_EQ(UpFront.IsLstOptml, Delayed.IsLstOptml);
+  EXPECT_EQ(UpFront.Length, Delayed.Length);
+  EXPECT_EQ(UpFront.Cost, Delayed.Cost);
+}
+
+// Graphs on which the heuristic schedule meets the critical path and resource
+// bounds, is only shown optimal by the relaxed bounds, or is improved on by
+// the enumerator. All have latencies greater than one.
+INSTANTIATE_TEST_CASE_P(RandomGraphs, DelayedClosureTest,
+                        testing::Values(std::make_tuple(12, 0.2, 1u),
+                                        std::make_tuple(16, 0.2, 2u),
+                                        std::make_tuple(12, 0.3, 8u),
+                                        std::make_tuple(16, 0.2, 1u),
+                                        std::make_tuple(20, 0.3, 4u),
+                                        std::make_tuple(12, 0.3, 3u),
+                                        std::make_tuple(16, 0.3, 7u),
+                                        std::make_tuple(20, 0.3, 5u),
+                                        std::make_tuple(24, 0.3, 3u)), );
+} // namespace
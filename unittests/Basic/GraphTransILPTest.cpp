@@ -0,0 +1,95 @@
+#include "opt-sched/Scheduler/graph_trans_ilp.h"
+
+#include "random_ddg.h"
+#include "simple_machine_model.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The DISTANCE() table computed directly from the relative critical paths.
+llvm::SmallVector<int, 64> referenceDistanceTable(DataDepGraph &DDG) {
+  const int NumNodes = DDG.GetNodeCnt();
+  llvm::SmallVector<int, 64> Table(NumNodes * NumNodes,
+                                   std::numeric_limits<int>::lowest());
+
+  for (int I = 0; I < NumNodes; ++I) {
+    for (int J = 0; J < NumNodes; ++J) {
+      SchedInstruction *NodeI = DDG.GetInstByIndx(I);
+      SchedInstruction *NodeJ = DDG.GetInstByIndx(J);
+      if (NodeI->IsRcrsvScsr(NodeJ))
+        Table[I * NumNodes + J] = std::min(
+            DDG.GetRltvCrtclPath(NodeI, NodeJ, DIR_FRWRD), DDG.GetMaxLtncy());
+    }
+  }
+  return Table;
+}
+
+class GraphTransILPTest : public RandomDDGTest {};
+
+TEST_P(GraphTransILPTest, DistanceTableMatchesRelativeCriticalPaths) {
+  EXPECT_EQ(referenceDistanceTable(DDG),
+            StaticNodeSupILPTrans::createDistanceTable(DDG));
+}
+
+TEST_P(GraphTransILPTest, UpdatedDistanceTableMatchesRecomputation) {
+  auto Data_ = StaticNodeSupILPTrans::createData(DDG);
+  auto &Data = Data_.getData();
+
+  // Same steps as ApplyTrans().
+  while (!Data.SuperiorNodesList.empty()) {
+    auto IJ = Data.SuperiorNodesList.pop_back_val();
+    if (!areNodesIndependent(DDG.GetInstByIndx(IJ.first),
+                             DDG.GetInstByIndx(IJ.second)))
+      continue;
+
+    StaticNodeSupILPTrans::addZeroLatencyEdge(Data, IJ.first, IJ.second);
+    StaticNodeSupILPTrans::updateDistanceTable(Data, IJ.first, IJ.second);
+    StaticNodeSupILPTrans::removeRedundantEdges(Data, IJ.first, IJ.second);
+  }
+
+  ASSERT_EQ(RES_SUCCESS, DDG.UpdateSetupForSchdulng(true));
+  EXPECT_EQ(StaticNodeSupILPTrans::createDistanceTable(DDG),
+            Data_.DistanceTable);
+}
+
+INSTANTIATE_TEST_CASE_P(RandomGraphs, GraphTransILPTest,
+                        testing::ValuesIn(randomDDGParams()));
+
+// Run with --gtest_also_run_disabled_tests to time building the relative
+// critical path matrix and the DISTANCE() table from it on larger graphs.
+TEST(GraphTransILPBenchmark, DISABLED_CreateDistanceTable) {
+  using Clock = std::chrono::steady_clock;
+  auto MillisSince = [](Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start)
+        .count();
+  };
+
+  MachineModel Model = simpleMachineModel();
+  for (int NumInsts : {500, 1000, 2000}) {
+    // About four successors per instruction.
+    RandomDDG DDG(&Model, NumInsts, 8.0 / NumInsts, 1);
+    DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+
+    // The first query builds the matrix.
+    Clock::time_point Start = Clock::now();
+    DDG.GetRltvCrtclPath(0, 0);
+    const double MatrixMillis = MillisSince(Start);
+
+    Start = Clock::now();
+    auto Table = StaticNodeSupILPTrans::createDistanceTable(DDG);
+    const double TableMillis = MillisSince(Start);
+
+    EXPECT_EQ(referenceDistanceTable(DDG), Table);
+    std::printf("%5d nodes: relative critical path matrix %8.2f ms, "
+                "DISTANCE() table %8.2f ms\n",
+                NumInsts, MatrixMillis, TableMillis);
+  }
+}
+} // namespace
@@ -0,0 +1,105 @@
+#include "opt-sched/Scheduler/graph_trans.h"
+
+#include "random_ddg.h"
+#include "simple_machine_model.h"
+
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+GraphEdge *tryAddingSuperiorEdge(DataDepGraph &DDG, SchedInstruction *A,
+                                 SchedInstruction *B) {
+  if (A->GetNodeID() > B->GetNodeID())
+    std::swap(A, B);
+
+  if (StaticNodeSupTrans::isNodeSuperior(DDG, A->GetNum(), B->GetNum()))
+    return addSuperiorEdge(DDG, A, B);
+  if (StaticNodeSupTrans::isNodeSuperior(DDG, B->GetNum(), A->GetNum()))
+    return addSuperiorEdge(DDG, B, A);
+  return nullptr;
+}
+
+// Multi-pass node superiority as repeated sweeps over the remaining
+// independent pairs, which is how the transformation used to do it.
+void sweepNodeSuperiority(DataDepGraph &DDG) {
+  const int NumNodes = DDG.GetInstCnt();
+  std::list<std::pair<SchedInstruction *, SchedInstruction *>> Pairs;
+  StaticNodeSupTrans::Statistics Stats;
+
+  for (int I = 0; I < NumNodes; ++I) {
+    for (int J = I + 1; J < NumNodes; ++J) {
+      SchedInstruction *A = DDG.GetInstByIndx(I);
+      SchedInstruction *B = DDG.GetInstByIndx(J);
+      if (!areNodesIndependent(A, B))
+        continue;
+      if (GraphEdge *Edge = tryAddingSuperiorEdge(DDG, A, B))
+        StaticNodeSupTrans::removeRedundantEdges(DDG, Edge->from->GetNum(),
+                                                 Edge->to->GetNum(), Stats);
+      else
+        Pairs.push_back(std::make_pair(A, B));
+    }
+  }
+
+  bool DidAddEdge = true;
+  while (DidAddEdge && !Pairs.empty()) {
+    DidAddEdge = false;
+    for (auto It = Pairs.begin(); It != Pairs.end();) {
+      if (!areNodesIndependent(It->first, It->second)) {
+        It = Pairs.erase(It);
+      } else if (tryAddingSuperiorEdge(DDG, It->first, It->second)) {
+        It = Pairs.erase(It);
+        DidAddEdge = true;
+      } else {
+        ++It;
+      }
+    }
+  }
+}
+
+// (successor number, latency) for each edge, grouped by node.
+std::vector<std::vector<std::pair<int, int>>> edges(DataDepGraph &DDG) {
+  std::vector<std::vector<std::pair<int, int>>> Edges(DDG.GetInstCnt());
+  for (int I = 0; I < DDG.GetInstCnt(); ++I)
+    for (GraphEdge &Edge : DDG.GetInstByIndx(I)->GetSuccessors())
+      Edges[I].push_back(std::make_pair(Edge.to->GetNum(), Edge.label));
+  return Edges;
+}
+
+class StaticNodeSupTransTest : public RandomDDGTest {
+protected:
+  StaticNodeSupTransTest() : SweptDDG(&Model, GetParam()) {
+    SweptDDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+  }
+
+  RandomDDG SweptDDG;
+};
+
+TEST_P(StaticNodeSupTransTest, MultiPassMatchesRepeatedSweeps) {
+  StaticNodeSupTrans(&DDG, /* IsMultiPass = */ true).ApplyTrans();
+  sweepNodeSuperiority(SweptDDG);
+
+  EXPECT_EQ(edges(SweptDDG), edges(DDG));
+}
+
+TEST_P(StaticNodeSupTransTest, MultiPassLeavesNoSuperiorPairs) {
+  StaticNodeSupTrans(&DDG, /* IsMultiPass = */ true).ApplyTrans();
+
+  const int NumNodes = DDG.GetInstCnt();
+  for (int I = 0; I < NumNodes; ++I) {
+    for (int J = 0; J < NumNodes; ++J) {
+      if (areNodesIndependent(DDG.GetInstByIndx(I), DDG.GetInstByIndx(J))) {
+        EXPECT_FALSE(StaticNodeSupTrans::isNodeSuperior(DDG, I, J))
+            << I << " is superior to " << J;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(RandomGraphs, StaticNodeSupTransTest,
+                        testing::ValuesIn(randomDDGParams()));
+} // namespace
@@ -0,0 +1,143 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads, followed by whether the enumerator
+// keeps its history table across target lengths.
+const char EnumConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS NO
+ENUM_SEARCH_STRATEGY DFS
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+const Milliseconds Timeout = 5000;
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> GraphParams;
+
+struct EnumResult {
+  FUNC_RESULT Rslt;
+  InstCount Cost;
+  InstCount Length;
+  // The number of target lengths the enumerator searched.
+  int EnumCnt;
+};
+
+typedef std::tuple<GraphParams, SPILL_COST_FUNCTION> ReuseParams;
+
+// History reuse only applies to the peak cost functions, so the tests run
+// with each of them on random graphs with registers.
+class HistoryReuseTest : public testing::TestWithParam<ReuseParams> {
+protected:
+  HistoryReuseTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    Prirts.cnt = 2;
+    Prirts.isDynmc = false;
+    Prirts.vctr[0] = LSH_CP;
+    Prirts.vctr[1] = LSH_NID;
+    Logger::SetLogStream(Log);
+  }
+
+  ~HistoryReuseTest() override { Logger::SetLogStream(OldLog); }
+
+  // Schedules a fresh copy of the parameters' graph with history reuse on or
+  // off.
+  EnumResult schedule(bool IsHstryReused) {
+    std::istringstream Config(std::string(EnumConfig) + "ENUM_REUSE_HISTORY " +
+                              (IsHstryReused ? "YES\n" : "NO\n"));
+    SchedulerOptions::getInstance().Load(Config);
+
+    const GraphParams &Graph = std::get<0>(GetParam());
+    RandomDDG DDG(&Model, std::get<0>(Graph), std::get<1>(Graph),
+                  std::get<2>(Graph));
+    DDG.addRegisters(std::get<2>(Graph));
+    Pruning PruningStrategy = {true, true, true, true, false};
+    // Weigh the spill cost heavily enough that longer schedules can be
+    // cheaper, so that the enumerator searches several target lengths.
+    BBWithSpill Region(&Target, &DDG, 0, 8, LBA_LC, Prirts, Prirts, true,
+                       PruningStrategy, false, true, /* SCW = */ 1000,
+                       std::get<1>(GetParam()), SCHED_LIST, GT_POSITION::NONE);
+
+    Log.str("");
+    bool IsLstOptml = false;
+    InstCount HurstcCost, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    EnumResult Result;
+    Result.Rslt = Region.FindOptimalSchedule(
+        Timeout, Timeout, IsLstOptml, Result.Cost, Result.Length, HurstcCost,
+        HurstcLength, Sched, false, BLOCKS_TO_KEEP::ALL);
+    Result.EnumCnt = countEvents("Enumerating");
+    EXPECT_NE(Sched, nullptr);
+    if (Sched != nullptr) {
+      EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+    }
+    delete Sched;
+    return Result;
+  }
+
+  // The number of the given events in the log.
+  int countEvents(const std::string &EventID) const {
+    const std::string Text = Log.str();
+    const std::string Key = "\"event_id\": \"" + EventID + "\"";
+    int Count = 0;
+    for (size_t Pos = Text.find(Key); Pos != std::string::npos;
+         Pos = Text.find(Key, Pos + 1))
+      Count++;
+    return Count;
+  }
+
+  MachineModel Model;
+  FakeTarget Target;
+  SchedPriorities Prirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(HistoryReuseTest, EnumeratorSearchesSeveralLengths) {
+  // Otherwise the history table is never carried over.
+  EnumResult Fresh = schedule(false);
+  ASSERT_EQ(RES_SUCCESS, Fresh.Rslt);
+  EXPECT_GT(Fresh.EnumCnt, 1);
+}
+
+TEST_P(HistoryReuseTest, FindsTheSameScheduleAsWithoutReuse) {
+  EnumResult Fresh = schedule(false);
+  EnumResult Reused = schedule(true);
+  ASSERT_EQ(RES_SUCCESS, Fresh.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Reused.Rslt);
+  EXPECT_EQ(Fresh.Length, Reused.Length);
+  EXPECT_EQ(Fresh.Cost, Reused.Cost);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    RandomGraphs, HistoryReuseTest,
+    testing::Combine(testing::Values(std::make_tuple(16, 0.2, 2u),
+                                     std::make_tuple(16, 0.2, 10u),
+                                     std::make_tuple(16, 0.3, 3u),
+                                     std::make_tuple(16, 0.3, 4u)),
+                     testing::Values(SCF_TARGET, SCF_PRP, SCF_PERP)), );
+} // namespace
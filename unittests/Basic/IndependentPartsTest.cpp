@@ -0,0 +1,243 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/list_sched.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads: the list scheduler, then the
+// enumerator, with regions split into their independent parts in between.
+const char DecomposeConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS YES
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+const Milliseconds Timeout = 2000;
+
+// (number of instructions, edge probability, seed, number of parts)
+typedef std::tuple<int, double, unsigned, int> PartsParams;
+
+// On a single issue machine, the list scheduler fills every stall of one part
+// with the instructions of another and is always optimal on these graphs, so
+// the tests issue two instructions per cycle.
+class IndependentPartsTest : public testing::TestWithParam<PartsParams> {
+protected:
+  IndependentPartsTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        DDG(&Model, std::get<0>(GetParam()), std::get<1>(GetParam()),
+            std::get<2>(GetParam()), std::get<3>(GetParam())),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    Prirts.cnt = 2;
+    Prirts.isDynmc = false;
+    Prirts.vctr[0] = LSH_CP;
+    Prirts.vctr[1] = LSH_NID;
+
+    std::istringstream Config(DecomposeConfig);
+    SchedulerOptions::getInstance().Load(Config);
+    Logger::SetLogStream(Log);
+  }
+
+  ~IndependentPartsTest() override { Logger::SetLogStream(OldLog); }
+
+  std::unique_ptr<BBWithSpill> makeRegion(DataDepGraph *Graph) {
+    Pruning PruningStrategy = {true, true, true, true, false};
+    return std::unique_ptr<BBWithSpill>(new BBWithSpill(
+        &Target, Graph, 0, 8, LBA_LC, Prirts, Prirts, true, PruningStrategy,
+        false, true, 0, SCF_PERP, SCHED_LIST, GT_POSITION::NONE));
+  }
+
+  // Finds the best schedule of the region and whether it is optimal.
+  std::unique_ptr<InstSchedule> schedule(SchedRegion *Region,
+                                         bool &IsOptimal) {
+    bool IsLstOptml = false;
+    InstCount Cost, Length, HurstcCost, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    FUNC_RESULT Rslt = Region->FindOptimalSchedule(
+        Timeout, Timeout, IsLstOptml, Cost, Length, HurstcCost, HurstcLength,
+        Sched, false, BLOCKS_TO_KEEP::ALL);
+    IsOptimal = IsLstOptml || Rslt == RES_SUCCESS;
+    return std::unique_ptr<InstSchedule>(Sched);
+  }
+
+  // The instructions of each independent component of the scheduled graph.
+  std::vector<std::vector<InstCount>> findParts() {
+    std::vector<InstCount> Cmpnnts;
+    std::vector<std::vector<InstCount>> Parts(
+        DDG.FindIndpndntCmpnnts(Cmpnnts));
+    for (InstCount I = 0; I < DDG.GetInstCnt(); I++)
+      if (Cmpnnts[I] != INVALID_VALUE)
+        Parts[Cmpnnts[I]].push_back(I);
+    return Parts;
+  }
+
+  // Schedules a part as a region of its own and records the cycle of each of
+  // its instructions in PartCycles. Returns the length of the part's schedule
+  // if it is optimal, 0 otherwise.
+  InstCount schedulePart(const std::vector<InstCount> &Part, int PartNum,
+                         std::vector<InstCount> &PartCycles) {
+    DataDepCmpnntGraph PartGraph(&DDG, &Model, Part, PartNum);
+    std::unique_ptr<BBWithSpill> PartRgn = makeRegion(&PartGraph);
+    bool IsOptimal;
+    std::unique_ptr<InstSchedule> PartSched =
+        schedule(PartRgn.get(), IsOptimal);
+    EXPECT_NE(PartSched, nullptr);
+    if (PartSched == nullptr)
+      return 0;
+
+    for (size_t I = 0; I < Part.size(); I++)
+      PartCycles[Part[I]] = PartSched->GetSchedCycle((InstCount)I);
+    return IsOptimal ? PartSched->GetCrntLngth() : 0;
+  }
+
+  // The number of the given events in the log.
+  int countEvents(const std::string &EventID) const {
+    const std::string Text = Log.str();
+    const std::string Key = "\"event_id\": \"" + EventID + "\"";
+    int Count = 0;
+    for (size_t Pos = Text.find(Key); Pos != std::string::npos;
+         Pos = Text.find(Key, Pos + 1))
+      Count++;
+    return Count;
+  }
+
+  // The value of a numeric field of the first of the given events in the log.
+  long eventValue(const std::string &EventID, const std::string &Field) const {
+    const std::string Text = Log.str();
+    size_t Pos = Text.find("\"event_id\": \"" + EventID + "\"");
+    if (Pos == std::string::npos)
+      return -1;
+    Pos = Text.find("\"" + Field + "\": ", Pos);
+    if (Pos == std::string::npos)
+      return -1;
+    return std::strtol(Text.c_str() + Pos + Field.size() + 4, nullptr, 10);
+  }
+
+  MachineModel Model;
+  RandomDDG DDG;
+  FakeTarget Target;
+  SchedPriorities Prirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(IndependentPartsTest, RegionReportsItsResultsOnce) {
+  std::unique_ptr<BBWithSpill> Region = makeRegion(&DDG);
+  bool IsOptimal;
+  std::unique_ptr<InstSchedule> Sched = schedule(Region.get(), IsOptimal);
+  ASSERT_NE(Sched, nullptr);
+  EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+
+  // The parts' regions are silent.
+  EXPECT_EQ(1, countEvents("IndependentPartsStart"));
+  EXPECT_EQ(1, countEvents("IndependentPartsResult"));
+  EXPECT_EQ(1, countEvents("HeuristicResult"));
+  EXPECT_EQ(1, countEvents("BestResult"));
+}
+
+TEST_P(IndependentPartsTest, LowerBoundIsLongestPart) {
+  std::unique_ptr<BBWithSpill> Region = makeRegion(&DDG);
+  bool IsOptimal;
+  std::unique_ptr<InstSchedule> Sched = schedule(Region.get(), IsOptimal);
+  ASSERT_NE(Sched, nullptr);
+  const long LwrBound =
+      eventValue("IndependentPartsResult", "length_lower_bound");
+  ASSERT_GE(LwrBound, 0);
+
+  // The parts overlap in the region's schedule, so the bound is the length of
+  // the longest part, not the sum of their lengths.
+  std::vector<std::vector<InstCount>> Parts = findParts();
+  ASSERT_GE(Parts.size(), 2u);
+  std::vector<InstCount> PartCycles(DDG.GetInstCnt(), 0);
+  InstCount LongestPart = 0;
+  for (size_t I = 0; I < Parts.size(); I++)
+    LongestPart =
+        std::max(LongestPart, schedulePart(Parts[I], (int)I, PartCycles));
+
+  EXPECT_GE(LwrBound, LongestPart);
+  EXPECT_GE(Sched->GetCrntLngth(), LwrBound);
+}
+
+class InterleavingTest : public IndependentPartsTest {};
+
+TEST_P(InterleavingTest, KeepsEachPartsOrder) {
+  // Scheduling the region first sets it up for the interleaving scheduler.
+  std::unique_ptr<BBWithSpill> Region = makeRegion(&DDG);
+  bool IsOptimal;
+  ASSERT_NE(schedule(Region.get(), IsOptimal), nullptr);
+
+  std::vector<std::vector<InstCount>> Parts = findParts();
+  ASSERT_GE(Parts.size(), 2u);
+  std::vector<InstCount> PartCycles(DDG.GetInstCnt(), 0);
+  InstCount LongestPart = 0;
+  for (size_t I = 0; I < Parts.size(); I++)
+    LongestPart =
+        std::max(LongestPart, schedulePart(Parts[I], (int)I, PartCycles));
+
+  InstSchedule Sched(&Model, &DDG, true);
+  InterleavingListScheduler Schdulr(&DDG, &Model, DDG.GetAbslutSchedUprBound(),
+                                    Prirts, Parts, PartCycles);
+  ASSERT_EQ(RES_SUCCESS, Schdulr.FindSchedule(&Sched, Region.get()));
+  EXPECT_TRUE(Sched.Verify(&Model, &DDG));
+  EXPECT_GE(Sched.GetCrntLngth(), LongestPart);
+
+  // The instructions of a later cycle of a part's schedule may share a cycle
+  // with those of an earlier one, but must come after them.
+  std::vector<InstCount> IssueOrder(DDG.GetInstCnt());
+  InstCount CycleNum, SlotNum, Pos = 0;
+  for (InstCount I = Sched.GetFrstInst(CycleNum, SlotNum); I != INVALID_VALUE;
+       I = Sched.GetNxtInst(CycleNum, SlotNum))
+    IssueOrder[I] = Pos++;
+
+  for (const std::vector<InstCount> &Part : Parts)
+    for (InstCount I : Part)
+      for (InstCount J : Part)
+        if (PartCycles[I] < PartCycles[J]) {
+          EXPECT_LT(IssueOrder[I], IssueOrder[J])
+              << "Instructions " << I << " and " << J << " swapped";
+        }
+}
+
+// Graphs of two or three parts on which the list schedule is not optimal, so
+// that the region gets split into its parts.
+INSTANTIATE_TEST_CASE_P(RandomParts, IndependentPartsTest,
+                        testing::Values(std::make_tuple(12, 0.5, 3u, 2),
+                                        std::make_tuple(16, 0.9, 1u, 2),
+                                        std::make_tuple(20, 0.7, 4u, 2),
+                                        std::make_tuple(20, 0.9, 3u, 3),
+                                        std::make_tuple(24, 0.7, 4u, 2),
+                                        std::make_tuple(30, 0.9, 4u, 3)), );
+
+// On the first graph, picking the instruction earliest in its part's schedule
+// alone runs an instruction of one part ahead of one of the cycle before it.
+INSTANTIATE_TEST_CASE_P(RandomParts, InterleavingTest,
+                        testing::Values(std::make_tuple(12, 0.5, 5u, 2),
+                                        std::make_tuple(12, 0.5, 3u, 2),
+                                        std::make_tuple(20, 0.9, 3u, 3),
+                                        std::make_tuple(30, 0.9, 4u, 3)), );
+} // namespace
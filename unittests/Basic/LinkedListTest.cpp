@@ -1,6 +1,11 @@
 #include "opt-sched/Scheduler/lnkd_lst.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -218,4 +223,131 @@ TEST(PriorityList, CorruptedByRemovingFirst) {
   ASSERT_EQ(it, list.end());
 }
 
+// An element with a number, like the instructions that CopyList() indexes.
+struct NumberedElement {
+  int num;
+  int GetNum() const { return num; }
+};
+
+// The elements of a priority list with their keys, in iteration order.
+template <class ListT>
+std::vector<std::pair<int, unsigned long>> keyedContents(ListT &list) {
+  std::vector<std::pair<int, unsigned long>> contents;
+  unsigned long key;
+  list.ResetIterator();
+  for (NumberedElement *x = list.GetNxtPriorityElmnt(key); x != NULL;
+       x = list.GetNxtPriorityElmnt(key))
+    contents.push_back(std::make_pair(x->num, key));
+  list.ResetIterator();
+  return contents;
+}
+
+// Removes an element through the iterator, as ReadyList does.
+template <class ListT> void removeElement(ListT &list, NumberedElement *x) {
+  list.ResetIterator();
+  while (list.GetNxtPriorityElmnt() != x)
+    ;
+  list.RmvCrntElmnt();
+  list.ResetIterator();
+}
+
+// (maximum size, number of distinct keys)
+class IndexedPriorityListTest
+    : public testing::TestWithParam<std::tuple<int, int>> {};
+
+TEST_P(IndexedPriorityListTest, MatchesPriorityList) {
+  const int maxSize = std::get<0>(GetParam());
+  const int keyCnt = std::get<1>(GetParam());
+  std::vector<NumberedElement> numbers(20);
+  for (size_t x = 0; x < numbers.size(); ++x)
+    numbers[x].num = x;
+
+  PriorityList<NumberedElement> list(maxSize);
+  IndexedPriorityList<NumberedElement> indexed(maxSize);
+  // Every other operation goes through the base class, which has to keep the
+  // index current as well.
+  PriorityList<NumberedElement> &indexedAsBase = indexed;
+  std::vector<KeyedEntry<NumberedElement> *> entries(numbers.size()),
+      indexedEntries(numbers.size());
+  std::mt19937 rng(std::get<1>(GetParam()));
+
+  for (int step = 0; step < 1000; ++step) {
+    int x = rng() % numbers.size();
+    unsigned long key = rng() % keyCnt;
+    if (entries[x] == NULL) {
+      entries[x] = list.InsrtElmnt(&numbers[x], key, true);
+      indexedEntries[x] =
+          step % 2 == 0 ? indexed.InsrtElmnt(&numbers[x], key, true)
+                        : indexedAsBase.InsrtElmnt(&numbers[x], key, true);
+    } else if (rng() % 2 == 0) {
+      list.BoostEntry(entries[x], key);
+      if (step % 2 == 0)
+        indexed.BoostEntry(indexedEntries[x], key);
+      else
+        indexedAsBase.BoostEntry(indexedEntries[x], key);
+    } else {
+      removeElement(list, &numbers[x]);
+      indexed.RmvElmnt(&numbers[x]);
+      entries[x] = indexedEntries[x] = NULL;
+    }
+    ASSERT_EQ(keyedContents(list), keyedContents(indexed)) << "step " << step;
+  }
+
+  IndexedPriorityList<NumberedElement> copy(maxSize);
+  copy.CopyList(&indexed, {});
+  EXPECT_EQ(keyedContents(indexed), keyedContents(copy));
+  for (int x = 0; x < 5; ++x) {
+    list.InsrtElmnt(&numbers[x], x, true);
+    copy.InsrtElmnt(&numbers[x], x, true);
+  }
+  EXPECT_EQ(keyedContents(list), keyedContents(copy));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    RandomOperations, IndexedPriorityListTest,
+    testing::Combine(testing::Values(INVALID_VALUE, 100),
+                     testing::Values(1, 4, 1000)), );
+
+// Fills a list with the elements ten times and drains it in priority order.
+// Returns the time taken in milliseconds.
+template <class ListT>
+double timeFillAndDrain(ListT &List, std::vector<int> &Elements,
+                        const std::vector<unsigned long> &Keys) {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point Start = Clock::now();
+  for (int Round = 0; Round < 10; ++Round) {
+    for (size_t I = 0; I < Elements.size(); ++I)
+      List.InsrtElmnt(&Elements[I], Keys[I], true);
+    List.ResetIterator();
+    while (List.GetNxtPriorityElmnt() != NULL) {
+      List.RmvCrntElmnt();
+      List.ResetIterator();
+    }
+  }
+  return std::chrono::duration<double, std::milli>(Clock::now() - Start)
+      .count();
+}
+
+// Run with --gtest_also_run_disabled_tests to time filling a ready list of
+// instructions with distinct packed keys, as ReadyList::CmputKey_() makes
+// them, and draining it in priority order.
+TEST(PriorityListBenchmark, DISABLED_InsertAndDrain) {
+  std::mt19937 Rng(1);
+  for (int Size : {16, 64, 256, 1024, 4096}) {
+    std::vector<int> Elements(Size);
+    std::vector<unsigned long> Keys(Size);
+    // A critical path and a node ID, the usual key.
+    for (int I = 0; I < Size; ++I)
+      Keys[I] = (unsigned long)(Rng() % (Size / 4 + 1)) << 16 | I;
+
+    PriorityList<int> List(Size);
+    IndexedPriorityList<int> Indexed(Size);
+    const double ListMillis = timeFillAndDrain(List, Elements, Keys);
+    const double IndexedMillis = timeFillAndDrain(Indexed, Elements, Keys);
+    std::printf("%5d elements: PriorityList %8.3f ms, IndexedPriorityList "
+                "%8.3f ms\n",
+                Size, ListMillis, IndexedMillis);
+  }
+}
+
 } // namespace
@@ -38,4 +38,16 @@ TEST_F(LoggerTest, EmptyEventIncludesOnlyTime) {
                   R"(EVENT: \{"event_id": "SomeEventID", "time": [0-9]+\})"
                   "\n"));
 }
+
+TEST_F(LoggerTest, SilenceDropsEventsAndInfoButNotErrors) {
+  {
+    Logger::Silence Quiet;
+    Logger::Event("SomeEventID");
+    Logger::Info("some info");
+    Logger::Error("some error");
+  }
+  Logger::Info("more info");
+  EXPECT_THAT(getLog(), ::testing::MatchesRegex("ERROR: some error.*\n"
+                                                "INFO: more info.*\n"));
+}
 } // namespace
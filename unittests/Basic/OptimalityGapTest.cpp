@@ -0,0 +1,150 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads.
+const char EnumConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS NO
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+const Milliseconds Timeout = 5000;
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> GraphParams;
+
+struct EnumResult {
+  FUNC_RESULT Rslt;
+  InstCount Cost;
+  InstCount HurstcCost;
+};
+
+// The graphs have no registers, so the cost of a schedule only depends on its
+// length. The list scheduler picks instructions in order, which leaves the
+// enumerator at least two cycles to improve on.
+class OptimalityGapTest : public testing::TestWithParam<GraphParams> {
+protected:
+  OptimalityGapTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    HurstcPrirts.cnt = 1;
+    HurstcPrirts.isDynmc = false;
+    HurstcPrirts.vctr[0] = LSH_NID;
+    EnumPrirts.cnt = 2;
+    EnumPrirts.isDynmc = false;
+    EnumPrirts.vctr[0] = LSH_CP;
+    EnumPrirts.vctr[1] = LSH_NID;
+
+    std::istringstream Config(EnumConfig);
+    SchedulerOptions::getInstance().Load(Config);
+    Logger::SetLogStream(Log);
+  }
+
+  ~OptimalityGapTest() override { Logger::SetLogStream(OldLog); }
+
+  // Schedules a fresh copy of the parameters' graph, stopping within Gap of
+  // the cost lower bound.
+  EnumResult schedule(InstCount Gap) {
+    RandomDDG DDG(&Model, std::get<0>(GetParam()), std::get<1>(GetParam()),
+                  std::get<2>(GetParam()));
+    Pruning PruningStrategy = {true, true, true, true, false};
+    BBWithSpill Region(&Target, &DDG, 0, 8, LBA_LC, HurstcPrirts, EnumPrirts,
+                       true, PruningStrategy, false, true, 0, SCF_PERP,
+                       SCHED_LIST, GT_POSITION::NONE);
+    Region.setOptimalityGap(Gap, 0);
+
+    Log.str("");
+    bool IsLstOptml = false;
+    InstCount Length, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    EnumResult Result;
+    Result.Rslt = Region.FindOptimalSchedule(
+        Timeout, Timeout, IsLstOptml, Result.Cost, Length, Result.HurstcCost,
+        HurstcLength, Sched, false, BLOCKS_TO_KEEP::ALL);
+    EXPECT_NE(Sched, nullptr);
+    if (Sched != nullptr) {
+      EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+    }
+    delete Sched;
+    return Result;
+  }
+
+  // The number of the given events in the log.
+  int countEvents(const std::string &EventID) const {
+    const std::string Text = Log.str();
+    const std::string Key = "\"event_id\": \"" + EventID + "\"";
+    int Count = 0;
+    for (size_t Pos = Text.find(Key); Pos != std::string::npos;
+         Pos = Text.find(Key, Pos + 1))
+      Count++;
+    return Count;
+  }
+
+  MachineModel Model;
+  FakeTarget Target;
+  SchedPriorities HurstcPrirts;
+  SchedPriorities EnumPrirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(OptimalityGapTest, HeuristicWithinGapIsNotOptimal) {
+  EnumResult Optimal = schedule(0);
+  ASSERT_EQ(RES_SUCCESS, Optimal.Rslt);
+  ASSERT_GT(Optimal.HurstcCost, Optimal.Cost);
+
+  EnumResult Gap = schedule(Optimal.HurstcCost);
+  EXPECT_EQ(RES_TIMEOUT, Gap.Rslt);
+  EXPECT_EQ(Optimal.HurstcCost, Gap.Cost);
+  EXPECT_EQ(0, countEvents("Enumerating"));
+  EXPECT_EQ(1, countEvents("DagOptimalityGapClosed"));
+}
+
+TEST_P(OptimalityGapTest, StopAtGapCanStillBeOptimal) {
+  EnumResult Optimal = schedule(0);
+  ASSERT_EQ(RES_SUCCESS, Optimal.Rslt);
+  ASSERT_GT(Optimal.Cost, 0);
+
+  // The enumerator stops at the first schedule within the gap. No schedule of
+  // its length costs less and shorter ones were all ruled out, so it is still
+  // optimal.
+  EnumResult Gap = schedule(Optimal.Cost);
+  EXPECT_EQ(RES_SUCCESS, Gap.Rslt);
+  EXPECT_EQ(Optimal.Cost, Gap.Cost);
+  EXPECT_GT(countEvents("Enumerating"), 0);
+  EXPECT_EQ(1, countEvents("DagSolvedOptimally"));
+  EXPECT_EQ(0, countEvents("DagOptimalityGapClosed"));
+}
+
+// Graphs on which the best schedule is one cycle longer than the lower bound,
+// and the list schedule longer still.
+INSTANTIATE_TEST_CASE_P(RandomGraphs, OptimalityGapTest,
+                        testing::Values(std::make_tuple(20, 0.2, 27u),
+                                        std::make_tuple(20, 0.3, 7u),
+                                        std::make_tuple(20, 0.3, 19u),
+                                        std::make_tuple(24, 0.5, 10u),
+                                        std::make_tuple(30, 0.3, 7u)), );
+} // namespace
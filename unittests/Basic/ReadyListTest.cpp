@@ -0,0 +1,125 @@
+#include "opt-sched/Scheduler/ready_list.h"
+
+#include "opt-sched/Scheduler/data_dep.h"
+#include "random_ddg.h"
+#include "simple_machine_model.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+SchedPriorities criticalPathThenNodeID(bool IsDynamic) {
+  SchedPriorities Priorities;
+  Priorities.cnt = 2;
+  Priorities.isDynmc = IsDynamic;
+  Priorities.vctr[0] = LSH_CP;
+  Priorities.vctr[1] = LSH_NID;
+  return Priorities;
+}
+
+// The instructions in the list with their keys, in iteration order.
+std::vector<std::pair<int, unsigned long>> contents(ReadyList &List) {
+  std::vector<std::pair<int, unsigned long>> Result;
+  unsigned long Key;
+  List.ResetIterator();
+  for (SchedInstruction *Inst = List.GetNextPriorityInst(Key); Inst != NULL;
+       Inst = List.GetNextPriorityInst(Key))
+    Result.push_back(std::make_pair(Inst->GetNum(), Key));
+  List.ResetIterator();
+  return Result;
+}
+
+// Moves the iterator to the instruction and removes it.
+void removeInst(ReadyList &List, SchedInstruction *Inst) {
+  SchedInstruction *Found;
+  List.ResetIterator();
+  do {
+    Found = List.GetNextPriorityInst();
+  } while (Found != NULL && Found != Inst);
+  EXPECT_EQ(Inst, Found);
+  List.RemoveNextPriorityInst();
+}
+
+class ReadyListTest : public testing::Test {
+protected:
+  ReadyListTest() : Model(simpleMachineModel()), DDG(&Model, 50, 0.1, 1) {
+    DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ false);
+  }
+
+  MachineModel Model;
+  RandomDDG DDG;
+};
+
+TEST_F(ReadyListTest, StaticPrioritiesMatchPriorityList) {
+  ReadyList Bits(&DDG, criticalPathThenNodeID(false), true);
+  ReadyList Linked(&DDG, criticalPathThenNodeID(false));
+  std::vector<bool> IsInList(DDG.GetInstCnt(), false);
+  std::mt19937 Rng(1);
+
+  for (int Step = 0; Step < 500; ++Step) {
+    int I = Rng() % DDG.GetInstCnt();
+    SchedInstruction *Inst = DDG.GetInstByIndx(I);
+    if (IsInList[I]) {
+      removeInst(Linked, Inst);
+      removeInst(Bits, Inst);
+    } else {
+      Linked.AddInst(Inst);
+      Bits.AddInst(Inst);
+    }
+    IsInList[I] = !IsInList[I];
+
+    ASSERT_EQ(Linked.GetInstCnt(), Bits.GetInstCnt());
+    ASSERT_EQ(contents(Linked), contents(Bits));
+  }
+}
+
+TEST_F(ReadyListTest, CopyKeepsIteratorPosition) {
+  ReadyList List(&DDG, criticalPathThenNodeID(false), true);
+  for (int I = 0; I < DDG.GetInstCnt(); I += 3)
+    List.AddInst(DDG.GetInstByIndx(I));
+  std::vector<std::pair<int, unsigned long>> Original = contents(List);
+
+  List.GetNextPriorityInst();
+  SchedInstruction *Third = nullptr;
+  for (int I = 0; I < 2; ++I)
+    Third = List.GetNextPriorityInst();
+
+  ReadyList Copy(&DDG, criticalPathThenNodeID(false), true);
+  Copy.CopyList(&List);
+  Copy.RemoveNextPriorityInst();
+  EXPECT_EQ(Original[3].first, Copy.GetNextPriorityInst()->GetNum());
+
+  std::vector<std::pair<int, unsigned long>> Expected = Original;
+  Expected.erase(Expected.begin() + 2);
+  EXPECT_EQ(Third->GetNum(), Original[2].first);
+  EXPECT_EQ(Expected, contents(Copy));
+  EXPECT_EQ(Original, contents(List));
+}
+
+TEST_F(ReadyListTest, TiesKeepInsertionOrder) {
+  // The list scheduler's choices among instructions with the same key depend
+  // on the order they became ready in.
+  SchedPriorities CriticalPath;
+  CriticalPath.cnt = 1;
+  CriticalPath.isDynmc = false;
+  CriticalPath.vctr[0] = LSH_CP;
+  ReadyList List(&DDG, CriticalPath);
+  for (int I = DDG.GetInstCnt() - 1; I >= 0; --I)
+    List.AddInst(DDG.GetInstByIndx(I));
+
+  std::vector<std::pair<int, unsigned long>> Contents = contents(List);
+  int TieCnt = 0;
+  for (size_t I = 1; I < Contents.size(); ++I) {
+    if (Contents[I - 1].second != Contents[I].second)
+      continue;
+    EXPECT_GT(Contents[I - 1].first, Contents[I].first);
+    TieCnt++;
+  }
+  EXPECT_GT(TieCnt, 0);
+}
+} // namespace
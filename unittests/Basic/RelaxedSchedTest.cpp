@@ -0,0 +1,266 @@
+#include "opt-sched/Scheduler/relaxed_sched.h"
+
+#include "random_ddg.h"
+#include "simple_machine_model.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The forward and backward lower bounds of every instruction.
+std::vector<std::pair<InstCount, InstCount>> lowerBounds(DataDepGraph &DDG) {
+  std::vector<std::pair<InstCount, InstCount>> Bounds;
+  for (InstCount I = 0; I < DDG.GetInstCnt(); ++I) {
+    SchedInstruction *Inst = DDG.GetInstByIndx(I);
+    Bounds.push_back(std::make_pair(Inst->GetLwrBound(DIR_FRWRD),
+                                    Inst->GetLwrBound(DIR_BKWRD)));
+  }
+  return Bounds;
+}
+
+// Computes the LC bounds in both directions, optionally on two threads the
+// way SchedRegion does with PARALLEL_LOWER_BOUNDS, and returns the longer of
+// the two schedule length bounds.
+InstCount lcLowerBound(DataDepGraph &DDG, MachineModel &Model,
+                       bool OnTwoThreads) {
+  InstCount UprBound = DDG.GetAbslutSchedUprBound();
+  LC_RelaxedScheduler Frwrd(&DDG, &Model, UprBound, DIR_FRWRD);
+  LC_RelaxedScheduler Bkwrd(&DDG, &Model, UprBound, DIR_BKWRD);
+  InstCount FrwrdBound, BkwrdBound;
+
+  if (OnTwoThreads) {
+    DDG.GetRltvCrtclPath(0, 0);
+    std::thread BkwrdThread([&] { BkwrdBound = Bkwrd.FindSchedule(); });
+    FrwrdBound = Frwrd.FindSchedule();
+    BkwrdThread.join();
+  } else {
+    FrwrdBound = Frwrd.FindSchedule();
+    BkwrdBound = Bkwrd.FindSchedule();
+  }
+  return std::max(FrwrdBound, BkwrdBound);
+}
+
+TEST(RelaxedScheduler, BoundsOnTwoThreadsMatchSequentialBounds) {
+  MachineModel Model = simpleMachineModel();
+  RandomDDG Sequential(&Model, 60, 0.1, 1);
+  RandomDDG Parallel(&Model, 60, 0.1, 1);
+  Sequential.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+  Parallel.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+
+  EXPECT_EQ(lcLowerBound(Sequential, Model, false),
+            lcLowerBound(Parallel, Model, true));
+  EXPECT_EQ(lowerBounds(Sequential), lowerBounds(Parallel));
+}
+
+TEST(RelaxedScheduler, RepeatedScheduleResetsUsedCycles) {
+  MachineModel Model = simpleMachineModel();
+  RandomDDG DDG(&Model, 60, 0.1, 2);
+  DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+  InstCount UprBound = DDG.GetAbslutSchedUprBound();
+
+  RJ_RelaxedScheduler Reused(&DDG, &Model, UprBound, DIR_FRWRD, RST_STTC);
+  InstCount First = Reused.FindSchedule();
+  EXPECT_EQ(First, Reused.FindSchedule());
+
+  RJ_RelaxedScheduler Fresh(&DDG, &Model, UprBound, DIR_FRWRD, RST_STTC);
+  EXPECT_EQ(First, Fresh.FindSchedule());
+}
+
+// Fixes up to the given number of random unfixed instructions other than the
+// root in their release cycles, and returns the ones that could be fixed.
+std::vector<SchedInstruction *> fixRandomInsts(RJ_RelaxedScheduler &Rlxd,
+                                               DataDepGraph &DDG,
+                                               std::vector<bool> &IsFxd,
+                                               std::mt19937 &Rng, int Cnt) {
+  InstCount *FrwrdBounds, *BkwrdBounds;
+  DDG.GetLwrBounds(FrwrdBounds, BkwrdBounds);
+  std::vector<SchedInstruction *> Fxd;
+  for (int I = 0; I < Cnt; ++I) {
+    InstCount Num = 1 + Rng() % (DDG.GetInstCnt() - 1);
+    SchedInstruction *Inst = DDG.GetInstByIndx(Num);
+    if (Inst == DDG.GetRootInst() || IsFxd[Num] ||
+        !Rlxd.FixInst(Inst, FrwrdBounds[Num]))
+      continue;
+    IsFxd[Num] = true;
+    Fxd.push_back(Inst);
+  }
+  return Fxd;
+}
+
+void unfixInsts(RJ_RelaxedScheduler &Rlxd, DataDepGraph &DDG,
+                std::vector<bool> &IsFxd,
+                const std::vector<SchedInstruction *> &Fxd) {
+  InstCount *FrwrdBounds, *BkwrdBounds;
+  DDG.GetLwrBounds(FrwrdBounds, BkwrdBounds);
+  for (SchedInstruction *Inst : Fxd) {
+    Rlxd.UnFixInst(Inst, FrwrdBounds[Inst->GetNum()]);
+    IsFxd[Inst->GetNum()] = false;
+  }
+}
+
+// The enumerator records a baseline before it tries the branches of a node
+// and checks each branch by replaying it. Each branch here fixes a few more
+// instructions and delays the release times of a few others, and the replay
+// has to agree with a check of the whole relaxed schedule.
+TEST(RelaxedScheduler, BaselineReplayMatchesFullCheck) {
+  MachineModel Model = simpleMachineModel(/* IssueRate = */ 2);
+  int FsblCnt = 0, InfsblCnt = 0;
+
+  for (unsigned Seed = 1; Seed <= 20; ++Seed) {
+    RandomDDG DDG(&Model, 40, 0.1, Seed);
+    DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+    const InstCount InstCnt = DDG.GetInstCnt();
+    InstCount *FrwrdBounds, *BkwrdBounds;
+    DDG.GetLwrBounds(FrwrdBounds, BkwrdBounds);
+
+    RJ_RelaxedScheduler Rlxd(&DDG, &Model, DDG.GetAbslutSchedUprBound(),
+                             DIR_FRWRD, RST_DYNMC);
+    Rlxd.Initialize(/* setPrirtyLst = */ true);
+    std::vector<bool> IsFxd(InstCnt, false);
+    std::mt19937 Rng(Seed);
+
+    // The first last cycle in which nothing needs to be delayed.
+    InstCount MinLastCycle = FrwrdBounds[DDG.GetLeafInst()->GetNum()];
+    while (!Rlxd.SchdulAndChkFsblty(0, MinLastCycle))
+      ++MinLastCycle;
+
+    for (int Node = 0; Node < 10; ++Node) {
+      const InstCount LastCycle = MinLastCycle - 1 + Rng() % 4;
+      std::vector<SchedInstruction *> NodeFxd =
+          fixRandomInsts(Rlxd, DDG, IsFxd, Rng, InstCnt / 4);
+      RlxdBaseline Bsln;
+      Rlxd.RecordBaseline(0, LastCycle, Bsln);
+
+      for (int Branch = 0; Branch < 20; ++Branch) {
+        const std::vector<InstCount> OldBounds(FrwrdBounds,
+                                               FrwrdBounds + InstCnt);
+        for (int I = Rng() % 3; I > 0; --I) {
+          InstCount Num = 1 + Rng() % (InstCnt - 1);
+          if (DDG.GetInstByIndx(Num) != DDG.GetRootInst() && !IsFxd[Num] &&
+              FrwrdBounds[Num] < LastCycle)
+            FrwrdBounds[Num] += 1 + Rng() % (LastCycle - FrwrdBounds[Num]);
+        }
+        std::vector<SchedInstruction *> BranchFxd =
+            fixRandomInsts(Rlxd, DDG, IsFxd, Rng, Rng() % 3);
+
+        bool Fsbl = Rlxd.SchdulAndChkFsblty(0, LastCycle);
+        EXPECT_EQ(Fsbl, Rlxd.SchdulAndChkFsblty(0, LastCycle, Bsln))
+            << "seed " << Seed << ", node " << Node << ", branch " << Branch;
+        ++(Fsbl ? FsblCnt : InfsblCnt);
+
+        unfixInsts(Rlxd, DDG, IsFxd, BranchFxd);
+        std::copy(OldBounds.begin(), OldBounds.end(), FrwrdBounds);
+      }
+      unfixInsts(Rlxd, DDG, IsFxd, NodeFxd);
+    }
+  }
+
+  // Otherwise one of the outcomes was never compared.
+  EXPECT_GT(FsblCnt, 0);
+  EXPECT_GT(InfsblCnt, 0);
+}
+
+// Checks the next available cycle from every cycle against a linear scan of
+// the available slots each time an instruction is about to be scheduled.
+class ScanCheckedRJScheduler : public RJ_RelaxedScheduler {
+public:
+  using RJ_RelaxedScheduler::RJ_RelaxedScheduler;
+
+  int LookupCnt = 0;
+  int MismatchCnt = 0;
+
+protected:
+  InstCount CmputReleaseTime_(SchedInstruction *Inst) override {
+    IssueType IssuType = Inst->GetIssueType();
+    for (InstCount Cycle = 0; Cycle < schedUprBound_; ++Cycle) {
+      InstCount Avlbl = Cycle;
+      while (Avlbl < schedUprBound_ && avlblSlots_[IssuType][Avlbl] == 0)
+        ++Avlbl;
+      ++LookupCnt;
+      if (FindNxtAvlblCycle_(IssuType, Cycle) != Avlbl)
+        ++MismatchCnt;
+    }
+    return RJ_RelaxedScheduler::CmputReleaseTime_(Inst);
+  }
+};
+
+TEST(RelaxedScheduler, NextAvailableCycleMatchesLinearScan) {
+  MachineModel Model = simpleMachineModel(/* IssueRate = */ 2);
+
+  for (unsigned Seed = 1; Seed <= 10; ++Seed) {
+    RandomDDG DDG(&Model, 30, 0.1, Seed);
+    DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+    InstCount *FrwrdBounds, *BkwrdBounds;
+    DDG.GetLwrBounds(FrwrdBounds, BkwrdBounds);
+    const InstCount UprBound = DDG.GetAbslutSchedUprBound();
+
+    ScanCheckedRJScheduler Rlxd(&DDG, &Model, UprBound, DIR_FRWRD,
+                                RST_DYNMC);
+    Rlxd.Initialize(/* setPrirtyLst = */ true);
+    std::vector<bool> IsFxd(DDG.GetInstCnt(), false);
+    std::vector<SchedInstruction *> Fxd;
+    std::mt19937 Rng(Seed);
+
+    // Each check starts from the slots left by the instructions fixed and
+    // unfixed since the previous one, which fill some cycles and leave others
+    // with one of the two slots taken.
+    for (int Check = 0; Check < 20; ++Check) {
+      std::vector<SchedInstruction *> NewlyFxd =
+          fixRandomInsts(Rlxd, DDG, IsFxd, Rng, Rng() % 5);
+      Fxd.insert(Fxd.end(), NewlyFxd.begin(), NewlyFxd.end());
+      std::shuffle(Fxd.begin(), Fxd.end(), Rng);
+      const size_t UnfxdCnt = std::min<size_t>(Rng() % 4, Fxd.size());
+      unfixInsts(Rlxd, DDG, IsFxd,
+                 std::vector<SchedInstruction *>(Fxd.end() - UnfxdCnt,
+                                                 Fxd.end()));
+      Fxd.resize(Fxd.size() - UnfxdCnt);
+
+      Rlxd.SchdulAndChkFsblty(0, UprBound - 1);
+    }
+    unfixInsts(Rlxd, DDG, IsFxd, Fxd);
+
+    EXPECT_GT(Rlxd.LookupCnt, 0);
+    EXPECT_EQ(0, Rlxd.MismatchCnt) << "seed " << Seed;
+  }
+}
+
+// Run with --gtest_also_run_disabled_tests to time the LC lower bounds of
+// larger graphs computed sequentially and on two threads.
+TEST(RelaxedSchedulerBenchmark, DISABLED_LCLowerBounds) {
+  using Clock = std::chrono::steady_clock;
+  auto MillisSince = [](Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start)
+        .count();
+  };
+
+  MachineModel Model = simpleMachineModel();
+  for (int NumInsts : {250, 500, 1000}) {
+    double Millis[2];
+    InstCount Bounds[2];
+    for (int OnTwoThreads = 0; OnTwoThreads < 2; ++OnTwoThreads) {
+      // About four successors per instruction.
+      RandomDDG DDG(&Model, NumInsts, 8.0 / NumInsts, 1);
+      DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+      DDG.GetRltvCrtclPath(0, 0);
+
+      Clock::time_point Start = Clock::now();
+      Bounds[OnTwoThreads] = lcLowerBound(DDG, Model, OnTwoThreads);
+      Millis[OnTwoThreads] = MillisSince(Start);
+    }
+
+    EXPECT_EQ(Bounds[0], Bounds[1]);
+    std::printf("%5d insts: LC lower bounds %8.2f ms sequential, %8.2f ms on "
+                "two threads\n",
+                NumInsts, Millis[0], Millis[1]);
+  }
+}
+} // namespace
@@ -0,0 +1,185 @@
+#include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/config.h"
+#include "opt-sched/Scheduler/logger.h"
+#include "fake_target.h"
+#include "random_ddg.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace llvm::opt_sched;
+
+namespace {
+// The options FindOptimalSchedule() reads, followed by the restart policy of
+// the enumerator.
+const char EnumConfig[] = R"(
+HEUR_ENABLED YES
+ACO_ENABLED NO
+ENUM_ENABLED YES
+ACO_BEFORE_ENUM NO
+ACO_AFTER_ENUM NO
+USE_TWO_PASS NO
+DECOMPOSE_REGIONS NO
+ENUM_SEARCH_STRATEGY DFS
+SIMULATE_REGISTER_ALLOCATION NO
+DUMP_DDGS NO
+PRINT_SPILL_COUNTS NO
+LATENCY_PRECISION LLVM
+)";
+
+// Few enough nodes that the search of each length restarts several times.
+const char RestartNodes[] = "ENUM_RESTART_NODES 10\n";
+
+const Milliseconds Timeout = 5000;
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> GraphParams;
+
+struct EnumResult {
+  FUNC_RESULT Rslt;
+  InstCount Cost;
+  InstCount Length;
+  // The number of tree nodes the enumerator examined.
+  long NodeCnt;
+  // The cycle of each instruction in the best schedule.
+  std::vector<InstCount> Cycles;
+};
+
+// Like BestFirstTest, the tests issue two instructions per cycle so that the
+// list scheduler leaves the enumerator something to do.
+class RestartTest : public testing::TestWithParam<GraphParams> {
+protected:
+  RestartTest()
+      : Model(simpleMachineModel(/* IssueRate = */ 2)),
+        OldLog(Logger::GetLogStream()) {
+    Target.MM = &Model;
+    Prirts.cnt = 2;
+    Prirts.isDynmc = false;
+    Prirts.vctr[0] = LSH_CP;
+    Prirts.vctr[1] = LSH_NID;
+    Logger::SetLogStream(Log);
+  }
+
+  ~RestartTest() override { Logger::SetLogStream(OldLog); }
+
+  // Schedules a fresh copy of the parameters' graph with the given restart
+  // options appended to the options.
+  EnumResult schedule(const std::string &Restarts) {
+    std::istringstream Config(EnumConfig + Restarts);
+    SchedulerOptions::getInstance().Load(Config);
+
+    RandomDDG DDG(&Model, std::get<0>(GetParam()), std::get<1>(GetParam()),
+                  std::get<2>(GetParam()));
+    Pruning PruningStrategy = {true, true, true, true, false};
+    BBWithSpill Region(&Target, &DDG, 0, 8, LBA_LC, Prirts, Prirts, true,
+                       PruningStrategy, false, true, 0, SCF_PERP, SCHED_LIST,
+                       GT_POSITION::NONE);
+
+    Log.str("");
+    bool IsLstOptml = false;
+    InstCount HurstcCost, HurstcLength;
+    InstSchedule *Sched = nullptr;
+    EnumResult Result;
+    Result.Rslt = Region.FindOptimalSchedule(
+        Timeout, Timeout, IsLstOptml, Result.Cost, Result.Length, HurstcCost,
+        HurstcLength, Sched, false, BLOCKS_TO_KEEP::ALL);
+    Result.NodeCnt = sumEventValues("NodeExamineCount", "num_nodes");
+    EXPECT_NE(Sched, nullptr);
+    if (Sched != nullptr) {
+      EXPECT_TRUE(Sched->Verify(&Model, &DDG));
+      for (InstCount I = 0; I < DDG.GetInstCnt(); I++)
+        Result.Cycles.push_back(Sched->GetSchedCycle(I));
+    }
+    delete Sched;
+    return Result;
+  }
+
+  // The sum of the given integer field over the given events in the log.
+  long sumEventValues(const std::string &EventID,
+                      const std::string &Field) const {
+    const std::string Text = Log.str();
+    const std::string Key = "\"event_id\": \"" + EventID + "\"";
+    const std::string FieldKey = "\"" + Field + "\": ";
+    long Sum = 0;
+    for (size_t Pos = Text.find(Key); Pos != std::string::npos;
+         Pos = Text.find(Key, Pos + 1)) {
+      size_t FieldPos = Text.find(FieldKey, Pos);
+      if (FieldPos != std::string::npos)
+        Sum += std::strtol(Text.c_str() + FieldPos + FieldKey.size(), nullptr,
+                           10);
+    }
+    return Sum;
+  }
+
+  MachineModel Model;
+  FakeTarget Target;
+  SchedPriorities Prirts;
+
+private:
+  std::ostream &OldLog;
+  std::ostringstream Log;
+};
+
+TEST_P(RestartTest, EnumeratorRestarts) {
+  // Otherwise the other tests never get to a second run of a length.
+  EnumResult DFS = schedule("ENUM_RESTART_POLICY NONE\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_GT(DFS.NodeCnt, 30);
+}
+
+TEST_P(RestartTest, LubyFindsTheSameCostAsDFS) {
+  EnumResult DFS = schedule("ENUM_RESTART_POLICY NONE\n");
+  EnumResult Luby = schedule(std::string("ENUM_RESTART_POLICY LUBY\n") +
+                             RestartNodes + "ENUM_RESTART_SEED 1\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Luby.Rslt);
+  EXPECT_EQ(DFS.Length, Luby.Length);
+  EXPECT_EQ(DFS.Cost, Luby.Cost);
+}
+
+TEST_P(RestartTest, GeometricFindsTheSameCostAsDFS) {
+  EnumResult DFS = schedule("ENUM_RESTART_POLICY NONE\n");
+  EnumResult Geometric =
+      schedule(std::string("ENUM_RESTART_POLICY GEOMETRIC\n") + RestartNodes +
+               "ENUM_RESTART_GROWTH 1.5\nENUM_RESTART_SEED 1\n");
+  ASSERT_EQ(RES_SUCCESS, DFS.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Geometric.Rslt);
+  EXPECT_EQ(DFS.Length, Geometric.Length);
+  EXPECT_EQ(DFS.Cost, Geometric.Cost);
+}
+
+TEST_P(RestartTest, SameSeedFindsTheSameSchedule) {
+  const std::string Restarts = std::string("ENUM_RESTART_POLICY LUBY\n") +
+                               RestartNodes + "ENUM_RESTART_SEED 7\n";
+  EnumResult First = schedule(Restarts);
+  EnumResult Second = schedule(Restarts);
+  ASSERT_EQ(RES_SUCCESS, First.Rslt);
+  EXPECT_EQ(RES_SUCCESS, Second.Rslt);
+  EXPECT_EQ(First.NodeCnt, Second.NodeCnt);
+  EXPECT_EQ(First.Cycles, Second.Cycles);
+}
+
+TEST_P(RestartTest, RejectsBestFirstSearch) {
+  // The best-first search would otherwise silently take precedence.
+  EXPECT_DEATH(schedule("ENUM_SEARCH_STRATEGY BEST_FIRST\n"
+                        "ENUM_RESTART_POLICY LUBY\n"),
+               "requires the DFS ENUM_SEARCH_STRATEGY");
+}
+
+// Graphs on which the enumerator examines several times ENUM_RESTART_NODES
+// nodes without restarts, and on which the depth-first search finds the same
+// cost without history domination.
+INSTANTIATE_TEST_CASE_P(RandomGraphs, RestartTest,
+                        testing::Values(std::make_tuple(12, 0.3, 3u),
+                                        std::make_tuple(16, 0.3, 12u),
+                                        std::make_tuple(20, 0.2, 27u),
+                                        std::make_tuple(20, 0.3, 3u),
+                                        std::make_tuple(20, 0.3, 19u),
+                                        std::make_tuple(24, 0.3, 3u),
+                                        std::make_tuple(24, 0.3, 32u)), );
+} // namespace
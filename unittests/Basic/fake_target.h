@@ -0,0 +1,41 @@
+#ifndef OPTSCHED_FAKE_TARGET_H
+#define OPTSCHED_FAKE_TARGET_H
+
+#include "Wrapper/OptSchedMachineWrapper.h"
+#include "opt-sched/Scheduler/OptSchedTarget.h"
+
+#include <memory>
+#include <string>
+
+// A target for regions built outside of LLVM. The regions scheduled in the
+// tests never ask it for a machine model or a DDG wrapper.
+class FakeTarget : public llvm::opt_sched::OptSchedTarget {
+public:
+  std::unique_ptr<llvm::opt_sched::OptSchedMachineModel>
+  createMachineModel(const char *configFile) override {
+    return nullptr;
+  }
+
+  std::unique_ptr<llvm::opt_sched::OptSchedDDGWrapperBase>
+  createDDGWrapper(llvm::MachineSchedContext *Context,
+                   llvm::opt_sched::ScheduleDAGOptSched *DAG,
+                   const llvm::opt_sched::OptSchedMachineModel *MM,
+                   llvm::opt_sched::LATENCY_PRECISION LatencyPrecision,
+                   const std::string &RegionID) override {
+    return nullptr;
+  }
+
+  void initRegion(llvm::ScheduleDAGInstrs *DAG,
+                  const llvm::opt_sched::MachineModel *MM) override {}
+  void finalizeRegion(const llvm::opt_sched::InstSchedule *Schedule) override {}
+
+  llvm::opt_sched::InstCount
+  getCost(const llvm::SmallVectorImpl<unsigned> &PRP) const override {
+    llvm::opt_sched::InstCount Cost = 0;
+    for (unsigned Pressure : PRP)
+      Cost += Pressure;
+    return Cost;
+  }
+};
+
+#endif
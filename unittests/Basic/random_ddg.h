@@ -0,0 +1,137 @@
+#ifndef OPTSCHED_RANDOM_DDG_H
+#define OPTSCHED_RANDOM_DDG_H
+
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/machine_model.h"
+#include "opt-sched/Scheduler/register.h"
+#include "simple_machine_model.h"
+
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// (number of instructions, edge probability, seed)
+typedef std::tuple<int, double, unsigned> RandomDDGParams;
+
+// A data dependence graph with random edges between NumInsts instructions of
+// the "Inst" type of simpleMachineModel(), plus the artificial root and leaf.
+// Instruction i may only depend on instructions numbered below i, so the
+// graph is acyclic by construction. With NumParts > 1, instruction i may only
+// depend on instructions in the same part, i % NumParts, so the graph falls
+// apart into at least NumParts independent components.
+class RandomDDG : public llvm::opt_sched::DataDepGraph {
+public:
+  RandomDDG(llvm::opt_sched::MachineModel *Model, int NumInsts,
+            double EdgeProbability, unsigned Seed, int NumParts = 1)
+      : DataDepGraph(Model, llvm::opt_sched::LTP_ROUGH) {
+    using namespace llvm::opt_sched;
+
+    std::mt19937 Rng(Seed);
+    std::bernoulli_distribution HasEdge(EdgeProbability);
+    std::uniform_int_distribution<int> Latency(0, 2);
+
+    const int RootNum = NumInsts, LeafNum = NumInsts + 1;
+    AllocArrays_(NumInsts + 2);
+    InstType Inst = machMdl_->GetInstTypeByName("Inst");
+    InstType Artificial = machMdl_->GetInstTypeByName("artificial");
+
+    for (int I = 0; I < NumInsts; I++)
+      CreateNode_(I, "Inst", Inst, "Inst", I, I, I, 0, 0, 0);
+    for (int J = 1; J < NumInsts; J++)
+      for (int I = 0; I < J; I++)
+        if (I % NumParts == J % NumParts && HasEdge(Rng))
+          CreateEdge_(I, J, Latency(Rng), DEP_DATA);
+
+    root_ = CreateNode_(RootNum, "artificial", Artificial, "__optsched_entry",
+                        RootNum, RootNum, RootNum, 0, 0, 0);
+    for (int I = 0; I < NumInsts; I++)
+      if (insts_[I]->GetPrdcsrCnt() == 0)
+        CreateEdge_(RootNum, I, 0, DEP_OTHER);
+    CreateNode_(LeafNum, "artificial", Artificial, "__optsched_exit", LeafNum,
+                LeafNum, LeafNum, 0, 0, 0);
+    for (int I = 0; I < NumInsts; I++)
+      if (insts_[I]->GetScsrCnt() == 0)
+        CreateEdge_(I, LeafNum, 0, DEP_OTHER);
+
+    Finish_();
+  }
+
+  RandomDDG(llvm::opt_sched::MachineModel *Model, const RandomDDGParams &Params)
+      : RandomDDG(Model, std::get<0>(Params), std::get<1>(Params),
+                  std::get<2>(Params)) {}
+
+  // Gives every instruction a def of a register of a random type of
+  // simpleMachineModel(). The register is used by the instruction's data
+  // successors, or by the leaf if it has none, so that the spill cost
+  // functions have register pressure to measure.
+  void addRegisters(unsigned Seed) {
+    using namespace llvm::opt_sched;
+
+    std::mt19937 Rng(Seed);
+    const int RegTypeCnt = machMdl_->GetRegTypeCnt();
+    std::uniform_int_distribution<int> RegType(0, RegTypeCnt - 1);
+
+    const int NumInsts = instCnt_ - 2;
+    std::vector<int> Types(NumInsts), Nums(NumInsts);
+    std::vector<int> RegCnts(RegTypeCnt, 0);
+    for (int I = 0; I < NumInsts; I++) {
+      Types[I] = RegType(Rng);
+      Nums[I] = RegCnts[Types[I]]++;
+    }
+    for (int T = 0; T < RegTypeCnt; T++) {
+      RegFiles[T].SetRegType(T);
+      RegFiles[T].SetRegCnt(RegCnts[T]);
+    }
+
+    for (int I = 0; I < NumInsts; I++) {
+      llvm::opt_sched::Register *Reg = RegFiles[Types[I]].GetReg(Nums[I]);
+      Reg->SetWght(1);
+      insts_[I]->AddDef(Reg);
+      Reg->AddDef(insts_[I]);
+      bool IsUsed = false;
+      for (GraphEdge &Edge : insts_[I]->GetSuccessors()) {
+        SchedInstruction *Succ = insts_[Edge.to->GetNum()];
+        if (Succ == GetLeafInst())
+          continue;
+        Succ->AddUse(Reg);
+        Reg->AddUse(Succ);
+        IsUsed = true;
+      }
+      if (!IsUsed) {
+        GetLeafInst()->AddUse(Reg);
+        Reg->AddUse(GetLeafInst());
+      }
+    }
+  }
+
+  void convertSUnits(bool, bool) override {}
+  void convertRegFiles() override {}
+};
+
+// The graphs the tests deriving from RandomDDGTest run on: a trivial graph,
+// dense and sparse graphs of several sizes, and graphs sparse enough to fall
+// apart into independent parts.
+inline std::vector<RandomDDGParams> randomDDGParams() {
+  return {std::make_tuple(1, 0.0, 1u),    std::make_tuple(8, 0.3, 2u),
+          std::make_tuple(20, 0.1, 3u),   std::make_tuple(40, 0.2, 4u),
+          std::make_tuple(60, 0.05, 5u),  std::make_tuple(100, 0.03, 6u),
+          std::make_tuple(8, 0.1, 7u),    std::make_tuple(20, 0.05, 8u),
+          std::make_tuple(40, 0.02, 9u),  std::make_tuple(60, 0.01, 10u)};
+}
+
+// A fixture with a random graph built from the test's parameters and set up
+// for scheduling with the transitive closure. Instantiate the tests of a
+// fixture deriving from it with testing::ValuesIn(randomDDGParams()).
+class RandomDDGTest : public testing::TestWithParam<RandomDDGParams> {
+protected:
+  RandomDDGTest() : Model(simpleMachineModel()), DDG(&Model, GetParam()) {
+    DDG.SetupForSchdulng(/* cmputTrnstvClsr = */ true);
+  }
+
+  llvm::opt_sched::MachineModel Model;
+  RandomDDG DDG;
+};
+
+#endif
@@ -1,23 +1,25 @@
 #ifndef OPTSCHED_SIMPLE_MACHINE_MODEL_H
 #define OPTSCHED_SIMPLE_MACHINE_MODEL_H
 
+#include <stdio.h>
 #include <string.h> // strdup is in the C header, but not the C++ header
 
 #include "opt-sched/Scheduler/buffers.h"
 #include "opt-sched/Scheduler/machine_model.h"
 
-inline llvm::opt_sched::MachineModel simpleMachineModel() {
+// A machine with one issue type, issuing IssueRate instructions per cycle.
+inline llvm::opt_sched::MachineModel simpleMachineModel(int IssueRate = 1) {
   static constexpr const char SimpleModel[] = R"(
 MODEL_NAME: Simple
 
 # The limit on the total number of instructions that can be issued in one cycle
-ISSUE_RATE: 1
+ISSUE_RATE: %d
 
 # Each instruction must have an issue type, i.e. a function unit that the instruction uses.
 ISSUE_TYPE_COUNT: 1
 
 # Default issue type for LLVM instructions.
-Default 1
+Default %d
 
 DEP_LATENCY_ANTI: 0
 DEP_LATENCY_OUTPUT: 1
@@ -46,7 +48,9 @@ BLOCKS_CYCLE: NO
 SUPPORTED: YES
   )";
 
-  llvm::opt_sched::SpecsBuffer Buf(strdup(SimpleModel), sizeof(SimpleModel));
+  char Spec[sizeof(SimpleModel) + 32];
+  int Size = snprintf(Spec, sizeof(Spec), SimpleModel, IssueRate, IssueRate);
+  llvm::opt_sched::SpecsBuffer Buf(strdup(Spec), Size + 1);
   llvm::opt_sched::MachineModel Model(Buf);
   return Model;
 }